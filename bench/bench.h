@@ -0,0 +1,57 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+typedef void (*bench_fn)(void *ctx);
+
+// Runs fn until at least min_time_ms have passed and returns ns per call
+double bench_time_ns(bench_fn fn, void *ctx);
+
+void bench_report(const char *kernel, const char *input, uint32_t units,
+                  const char *unit_name, double ns_per_call);
+
+void bench_set_min_time_ms(uint32_t min_time_ms);
+
+// Keeps results observable so the compiler cannot drop the measured work
+extern volatile uint32_t bench_sink;
+
+void bench_dsp(void);
+// Returns 0 if a retained screen differs from one drawn from scratch
+int bench_display(void);
+
+// Returns 0 if a reader ever saw a torn or out of order record
+int bench_state(void);
+
+// Returns 0 if a rolled up period disagrees with the blocks that went in
+int bench_history(void);
+
+// Returns 0 if a record is lost or altered, power cuts included
+int bench_event_log(void);
+
+// Returns 0 if a stage's statistics disagree with the runs recorded
+int bench_profile(void);
+
+// Returns 0 if a trace entry is torn, out of order or skipped uncounted
+int bench_trace(void);
+
+// Returns 0 if a scripted bounce sequence gives other events or timings
+// than expected
+int bench_input(void);
+
+// Returns 0 if the decoder lets a damaged packet through or misses a good one
+int bench_telemetry(void);
+
+// Returns 0 if a codec loses too much or a clip comes out incomplete, out
+// of order or around the wrong blocks
+int bench_clip(void);
+
+// Returns 0 if the capture queue hands out a block other than the newest
+// intact one or miscounts the blocks dropped and lapped
+int bench_capture(void);
+
+// Returns 0 if a capture file replays to other levels or alarm states than
+// the pipeline gave for the same blocks, or differently a second time
+int bench_replay(void);
+
+#endif // BENCH_H
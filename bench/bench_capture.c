@@ -0,0 +1,96 @@
+#include "bench.h"
+#include "capture_queue.h"
+#include "fake_adc_dma.h"
+
+#include <stdio.h>
+
+#define CAPTURE_CHECK_LEN 256
+#define CAPTURE_CHECK_STEPS 20000
+
+static uint16_t buffer[2 * CAPTURE_CHECK_LEN];
+static capture_queue_t queue;
+static fake_adc_dma_t fake;
+static uint32_t seed = 11;
+
+// Sample n of the stream is n, so a half shows which block last filled it
+static uint16_t capture_check_sample(void *ctx)
+{
+    uint32_t *next = ctx;
+    return (uint16_t)((*next)++ & 0x0FFF);
+}
+
+static uint32_t capture_random(uint32_t range)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) % range;
+}
+
+// Halves the DMA has finished since the start
+static uint32_t capture_completed(void)
+{
+    return (uint32_t)(fake.samples_converted / CAPTURE_CHECK_LEN);
+}
+
+static bool capture_intact(const capture_block_t *block)
+{
+    uint32_t first = block->seq * CAPTURE_CHECK_LEN;
+    return block->samples[0] == (first & 0x0FFF) &&
+           block->samples[CAPTURE_CHECK_LEN - 1] == ((first + CAPTURE_CHECK_LEN - 1) & 0x0FFF);
+}
+
+// A consumer that is away for up to a few halves, sometimes with the IRQ
+// masked for nearly three halves (at most three completions folded into one
+// interrupt, which the queue still counts exactly), then takes the newest
+// block and sometimes works on it past the point where the DMA is back in
+// its half. Every block handed out must be the newest one and intact, with
+// the samples skipped before it, and the skipped and lapped blocks must be
+// counted as the fake saw them.
+int bench_capture(void)
+{
+    uint32_t next_sample = 0;
+    uint32_t dropped = 0;
+    uint32_t overruns = 0;
+    uint32_t consumed = 0;
+    uint32_t taken = 0;
+    unsigned wrong = 0;
+
+    printf("== capture ==\n");
+
+    fake_adc_dma_init(&fake, &queue, buffer, CAPTURE_CHECK_LEN, capture_check_sample, &next_sample);
+
+    for (uint32_t step = 0; step < CAPTURE_CHECK_STEPS; step++)
+    {
+        fake_adc_dma_run(&fake, 1 + capture_random(3 * CAPTURE_CHECK_LEN));
+        if (capture_random(3) == 0)
+        {
+            fake_adc_dma_mask_irq(&fake);
+            fake_adc_dma_run(&fake, capture_random(3 * CAPTURE_CHECK_LEN));
+            fake_adc_dma_unmask_irq(&fake);
+        }
+
+        capture_block_t block;
+        uint32_t completed = capture_completed();
+        if (!capture_queue_acquire(&queue, &block))
+        {
+            wrong += completed != consumed;
+            continue;
+        }
+        dropped += completed - 1 - consumed;
+        taken++;
+        wrong += block.seq != completed - 1 || block.len != CAPTURE_CHECK_LEN || !capture_intact(&block) ||
+                 block.lost != (completed - 1 - consumed) * CAPTURE_CHECK_LEN;
+
+        // Working on the block; lapped once the DMA finishes the other half
+        fake_adc_dma_run(&fake, capture_random(CAPTURE_CHECK_LEN + CAPTURE_CHECK_LEN / 2));
+        bool lapped = capture_completed() > block.seq + 1;
+        overruns += lapped;
+        wrong += capture_queue_release(&queue, &block) == lapped;
+        consumed = block.seq + 1;
+    }
+
+    wrong += queue.dropped != dropped || queue.overruns != overruns || dropped == 0 || overruns == 0;
+    printf("%-24s %u halves, %u taken, %u dropped, %u overruns, %u mismatches\n", "capture_queue_check",
+           (unsigned)capture_completed(), (unsigned)taken, (unsigned)dropped,
+           (unsigned)overruns, wrong);
+    return wrong == 0;
+}
@@ -0,0 +1,215 @@
+#include "bench.h"
+#include "clip_ring.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CLIP_BENCH_SAMPLES 1024
+#define CLIP_BENCH_RATE 48000
+
+// Small ring for the checks, so it fills and wraps often
+#define CLIP_CHECK_SAMPLES 64
+#define CLIP_CHECK_BLOCKS 20
+#define CLIP_CHECK_PRE 6
+#define CLIP_CHECK_POST 5
+#define CLIP_CHECK_STEPS 20000
+
+static uint16_t samples[CLIP_BENCH_SAMPLES];
+static uint8_t encoded[CLIP_BLOCK_BYTES(CLIP_CODEC_ULAW, CLIP_BENCH_SAMPLES)];
+static int16_t decoded[CLIP_BENCH_SAMPLES];
+
+static uint8_t check_storage[CLIP_CHECK_BLOCKS * CLIP_CHECK_SAMPLES];
+static uint8_t check_expected[CLIP_CHECK_STEPS][CLIP_CHECK_SAMPLES];
+
+typedef struct
+{
+    clip_encoder_t encoder;
+    clip_codec_t codec;
+} clip_bench_t;
+
+static void run_encode(void *ctx)
+{
+    clip_bench_t *bench = ctx;
+    bench_sink += clip_encode(&bench->encoder, samples, CLIP_BENCH_SAMPLES, encoded) + encoded[7];
+}
+
+static void run_decode(void *ctx)
+{
+    clip_bench_t *bench = ctx;
+    clip_decode(bench->codec, encoded, CLIP_BENCH_SAMPLES, decoded);
+    bench_sink += (uint16_t)decoded[5];
+}
+
+// ADC counts of a tone over some noise, about 24 dB below full scale
+static void clip_signal(uint16_t *out, uint32_t count, uint32_t block, double hz)
+{
+    uint32_t seed = block * 2654435761u + 1;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        double t = (double)(block * count + i) / CLIP_BENCH_RATE;
+        out[i] = (uint16_t)(2048 + 120.0 * sin(2.0 * M_PI * hz * t) + (int)(seed >> 27) - 16);
+    }
+}
+
+// Signal to error ratio of a second of audio through the codec, each block
+// decoded on its own as the host does
+static double clip_snr_db(clip_codec_t codec, double hz)
+{
+    clip_encoder_t encoder;
+    double signal = 0.0;
+    double error = 0.0;
+
+    clip_encoder_init(&encoder, codec);
+    for (uint32_t block = 0; block < CLIP_BENCH_RATE / CLIP_BENCH_SAMPLES; block++)
+    {
+        clip_signal(samples, CLIP_BENCH_SAMPLES, block, hz);
+        clip_encode(&encoder, samples, CLIP_BENCH_SAMPLES, encoded);
+        clip_decode(codec, encoded, CLIP_BENCH_SAMPLES, decoded);
+        for (uint32_t i = 0; i < CLIP_BENCH_SAMPLES; i++)
+        {
+            double pcm = ((int32_t)samples[i] - 2048) * 16.0;
+            signal += pcm * pcm;
+            error += (pcm - decoded[i]) * (pcm - decoded[i]);
+        }
+    }
+    return 10.0 * log10(signal / (error > 0.0 ? error : 1.0));
+}
+
+// A reader that is sometimes away for a long while, a trigger now and then
+// and sometimes while a clip is still held. Every clip must arrive whole
+// and in order, hold the blocks around its trigger, and match a second
+// encoder fed the blocks the ring took; what it did not take is counted.
+static unsigned clip_ring_check(clip_codec_t codec)
+{
+    clip_ring_t ring;
+    clip_encoder_t encoder;
+    uint16_t block[CLIP_CHECK_SAMPLES];
+    uint32_t seed = 7;
+    uint32_t recorded = 0;
+    uint32_t first = 0;
+    uint32_t dropped = 0;
+    uint32_t missed = 0;
+    uint32_t clips = 0;
+    uint32_t gaps = 0;
+    uint32_t start = 0;
+    uint32_t count = 0;
+    uint32_t trigger = 0;
+    uint32_t next_index = 0;
+    bool held = false;
+    unsigned wrong = 0;
+
+    clip_ring_init(&ring, check_storage, CLIP_CHECK_BLOCKS, codec, CLIP_CHECK_SAMPLES, CLIP_CHECK_PRE,
+                   CLIP_CHECK_POST);
+    clip_encoder_init(&encoder, codec);
+
+    for (uint32_t step = 0; step < CLIP_CHECK_STEPS; step++)
+    {
+        // Now and then capture loses samples ahead of the block, and no clip
+        // may reach back across that
+        seed = seed * 1664525u + 1013904223u;
+        if (seed >> 27 == 0)
+        {
+            clip_ring_gap(&ring);
+            first = recorded;
+            gaps++;
+        }
+
+        clip_signal(block, CLIP_CHECK_SAMPLES, step, 440.0);
+        bool full = held && recorded - (start + next_index) >= CLIP_CHECK_BLOCKS;
+        if (clip_ring_record(&ring, block) == full)
+        {
+            wrong++;
+        }
+        if (full)
+        {
+            dropped++;
+            first = recorded;
+        }
+        else
+        {
+            clip_encode(&encoder, block, CLIP_CHECK_SAMPLES, check_expected[recorded++]);
+        }
+
+        seed = seed * 1664525u + 1013904223u;
+        if (seed >> 28 == 0)
+        {
+            bool expected = !held && recorded != first;
+            if (clip_ring_trigger(&ring) != expected)
+            {
+                wrong++;
+            }
+            if (held)
+            {
+                missed++;
+            }
+            if (expected)
+            {
+                start = recorded - first > CLIP_CHECK_PRE ? recorded - CLIP_CHECK_PRE : first;
+                count = recorded + CLIP_CHECK_POST - start;
+                trigger = recorded - 1 - start;
+                next_index = 0;
+                held = true;
+                clips++;
+            }
+        }
+
+        // Away for 256 steps in every 1024, otherwise a block or two a step
+        unsigned reads = (step / 256) % 4 == 3 ? 0 : 1 + (seed >> 31);
+        clip_block_t held_block;
+        for (unsigned r = 0; r < reads && clip_ring_peek(&ring, &held_block); r++)
+        {
+            wrong += !held || held_block.clip != clips - 1 || held_block.index != next_index ||
+                     held_block.count != count || held_block.trigger != trigger ||
+                     held_block.bytes != CLIP_BLOCK_BYTES(codec, CLIP_CHECK_SAMPLES) ||
+                     memcmp(held_block.data, check_expected[start + next_index], held_block.bytes) != 0;
+            clip_ring_release(&ring);
+            if (++next_index == count)
+            {
+                held = false;
+            }
+        }
+    }
+
+    wrong += ring.dropped != dropped || ring.missed != missed || ring.clips != clips;
+    printf("%-24s %-8s %u clips, %u gaps, %u blocks dropped, %u triggers missed, %u mismatches\n",
+           "clip_ring_check", codec == CLIP_CODEC_ULAW ? "mu-law" : "adpcm", (unsigned)clips, (unsigned)gaps,
+           (unsigned)dropped, (unsigned)missed, wrong);
+    return wrong;
+}
+
+int bench_clip(void)
+{
+    unsigned wrong = 0;
+
+    printf("== clip ==\n");
+
+    static const clip_codec_t codecs[] = {CLIP_CODEC_ULAW, CLIP_CODEC_ADPCM};
+    static const char *const names[] = {"mu-law", "adpcm"};
+    for (unsigned c = 0; c < 2; c++)
+    {
+        clip_bench_t bench = {.codec = codecs[c]};
+        clip_encoder_init(&bench.encoder, codecs[c]);
+        clip_signal(samples, CLIP_BENCH_SAMPLES, 0, 1000.0);
+        bench_report("clip_encode", names[c], CLIP_BENCH_SAMPLES, "sample", bench_time_ns(run_encode, &bench));
+        bench_report("clip_decode", names[c], CLIP_BENCH_SAMPLES, "sample", bench_time_ns(run_decode, &bench));
+    }
+
+    // mu-law keeps about 37 dB at any level, ADPCM less on high tones
+    static const double tones[] = {250.0, 1000.0, 4000.0};
+    static const double least_db[2] = {30.0, 20.0};
+    for (unsigned c = 0; c < 2; c++)
+    {
+        for (unsigned t = 0; t < sizeof(tones) / sizeof(tones[0]); t++)
+        {
+            double snr = clip_snr_db(codecs[c], tones[t]);
+            printf("%-24s %-8s %5.0f Hz %5.1f dB\n", "clip_snr", names[c], tones[t], snr);
+            wrong += snr < least_db[c];
+        }
+        wrong += clip_ring_check(codecs[c]);
+    }
+
+    return wrong == 0;
+}
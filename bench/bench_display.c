@@ -0,0 +1,298 @@
+#include "bench.h"
+#include "calibration.h"
+#include "level_graph.h"
+#include "ssd1306_bus_mock.h"
+#include "ssd1306_gfx.h"
+#include "ssd1306_stream.h"
+#include "widget.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t framebuffer[ssd1306_buffer_length];
+static uint8_t shadow[ssd1306_buffer_length];
+static ssd1306_stream_t stream;
+static widget_screen_t screen;
+static widget_t *level_value;
+
+// The level page drawn from scratch, as every frame was before the pages
+// were retained, minus the transport
+static void run_status_frame(void *ctx)
+{
+    char text[16];
+    int *level = ctx;
+    int value = 700 + (*level)++ % 100;
+
+    memset(framebuffer, 0, sizeof(framebuffer));
+    ssd1306_draw_string(framebuffer, 0, 0, "Noise Guard");
+    snprintf(text, sizeof(text), "%s: %d.%d", "Level", value / 10, value % 10);
+    ssd1306_draw_string(framebuffer, 0, 16, text);
+    snprintf(text, sizeof(text), "%s: %d.%d", "Warn", 85, 0);
+    ssd1306_draw_string(framebuffer, 0, 32, text);
+    snprintf(text, sizeof(text), "%s: %d.%d", "Dang", 90, 0);
+    ssd1306_draw_string(framebuffer, 0, 48, text);
+    bench_sink += framebuffer[16 * ssd1306_width / 8];
+}
+
+// The same page retained: only the level digits are drawn again
+static void run_status_widgets(void *ctx)
+{
+    struct render_area areas[WIDGET_MAX];
+    int *level = ctx;
+
+    widget_set_value(level_value, 700 + (*level)++ % 100);
+    int count = widget_screen_draw(&screen, framebuffer, areas);
+    bench_sink += count ? areas[0].buffer_length : 0;
+}
+
+static void run_format(void *ctx)
+{
+    char text[12];
+    int *level = ctx;
+    bench_sink += widget_format(text, (*level)++ % 1200, 1) + text[0];
+}
+
+static void run_snprintf(void *ctx)
+{
+    char text[12];
+    int *level = ctx;
+    int value = (*level)++ % 1200;
+    bench_sink += snprintf(text, sizeof(text), "%d.%d", value / 10, value % 10) + text[0];
+}
+
+static void status_screen_init(void)
+{
+    screen.count = 0;
+    widget_add(&screen, WIDGET_LABEL, 0, 0, 11, "Noise Guard");
+    widget_add(&screen, WIDGET_LABEL, 0, 16, 8, "Level:");
+    level_value = widget_add(&screen, WIDGET_DECIDB, 64, 16, 5, NULL);
+    widget_add(&screen, WIDGET_LABEL, 0, 32, 8, "Warn:");
+    widget_set_value(widget_add(&screen, WIDGET_DECIDB, 64, 32, 5, NULL), 850);
+    widget_add(&screen, WIDGET_LABEL, 0, 48, 8, "Dang:");
+    widget_set_value(widget_add(&screen, WIDGET_DECIDB, 64, 48, 5, NULL), 900);
+    widget_screen_show(&screen, framebuffer);
+}
+
+// Digits match printf, and a screen updated one value at a time matches
+// the same screen drawn from scratch, with every changed byte inside the
+// areas it reported
+static int widget_check(void)
+{
+    static uint8_t fresh[ssd1306_buffer_length];
+    char text[16];
+    char expected[16];
+    int wrong = 0;
+
+    for (int32_t value = -20000; value <= 20000; value++)
+    {
+        int length = widget_format(text, value, 1);
+        int printed = snprintf(expected, sizeof(expected), "%s%d.%d", value < 0 ? "-" : "", abs(value) / 10,
+                               abs(value) % 10);
+        wrong += length != printed || strcmp(text, expected) != 0;
+        widget_format(text, value, 0);
+        snprintf(expected, sizeof(expected), "%d", value);
+        wrong += strcmp(text, expected) != 0;
+    }
+
+    // The longest texts fit WIDGET_FORMAT_BYTES exactly
+    const struct
+    {
+        int32_t value;
+        int decimals;
+        const char *text;
+    } extremes[] = {{INT32_MIN, 1, "-214748364.8"},
+                    {INT32_MIN, WIDGET_FORMAT_MAX_DECIMALS, "-2.147483648"},
+                    {-1, WIDGET_FORMAT_MAX_DECIMALS + 5, "-0.000000001"},
+                    {INT32_MAX, 0, "2147483647"}};
+    for (unsigned i = 0; i < sizeof(extremes) / sizeof(extremes[0]); i++)
+    {
+        memset(text, '#', sizeof(text));
+        int length = widget_format(text, extremes[i].value, extremes[i].decimals);
+        wrong += strcmp(text, extremes[i].text) != 0 || length >= WIDGET_FORMAT_BYTES ||
+                 text[WIDGET_FORMAT_BYTES] != '#';
+    }
+
+    status_screen_init();
+    for (int32_t level = 0; level < 1300; level += 7)
+    {
+        struct render_area areas[WIDGET_MAX];
+        memcpy(shadow, framebuffer, sizeof(shadow));
+        widget_set_value(level_value, level);
+        int count = widget_screen_draw(&screen, framebuffer, areas);
+
+        for (int i = 0; i < ssd1306_buffer_length; i++)
+        {
+            int page = i / ssd1306_width;
+            int column = i % ssd1306_width;
+            bool covered = false;
+            for (int a = 0; a < count; a++)
+            {
+                covered |= page >= areas[a].start_page && page <= areas[a].end_page &&
+                           column >= areas[a].start_column && column <= areas[a].end_column;
+            }
+            wrong += framebuffer[i] != shadow[i] && !covered;
+        }
+
+        memcpy(fresh, framebuffer, sizeof(fresh));
+        widget_screen_show(&screen, framebuffer);
+        wrong += memcmp(fresh, framebuffer, sizeof(fresh)) != 0;
+    }
+
+    printf("%-24s %-8s %u mismatches\n", "widget_check", "-", (unsigned)wrong);
+    return wrong == 0;
+}
+
+#define GRAPH_BENCH_RATE 48000
+#define GRAPH_BENCH_BLOCK 1024
+#define GRAPH_BENCH_SECONDS 300
+
+static history_t graph_history;
+static calibration_t graph_calibration;
+static ssd1306_bus_mock_t graph_panel;
+
+// Feeds blocks of a level that wanders up and down until one more second
+// has closed
+static void graph_next_second(uint32_t *seed)
+{
+    uint32_t closed = history_closed(&graph_history, HISTORY_SECOND);
+    while (history_closed(&graph_history, HISTORY_SECOND) == closed)
+    {
+        *seed = *seed * 1664525u + 1013904223u;
+        uint32_t q8 = 256u << (*seed >> 28);
+        history_add(&graph_history, q8, q8);
+    }
+}
+
+static void graph_send(const struct render_area *area, bool scroll)
+{
+    ssd1306_stream_reset(&stream);
+    if (scroll)
+    {
+        ssd1306_stream_scroll_left(&stream, &level_graph_area);
+    }
+    ssd1306_stream_area(&stream, framebuffer, area);
+    ssd1306_bus_submit(&graph_panel.bus, &stream);
+}
+
+// The graph moved one column a second, on the panel by its scroll command
+// and in the frame by level_graph_scroll, matches the graph drawn from
+// scratch, and the panel shows the frame
+static int graph_check(void)
+{
+    static uint8_t fresh[ssd1306_buffer_length];
+    struct render_area column = level_graph_area;
+    column.start_column = ssd1306_width - 1;
+    calculate_render_area_buffer_length(&column);
+    uint32_t seed = 1;
+    uint32_t scroll_bytes = 0;
+    uint32_t redraw_bytes = 0;
+    int wrong = 0;
+
+    calibration_init(&graph_calibration, &calibration_default_profile, 3300);
+    history_init(&graph_history, &graph_calibration, GRAPH_BENCH_BLOCK, GRAPH_BENCH_RATE);
+    ssd1306_bus_mock_init(&graph_panel);
+
+    memset(framebuffer, 0, sizeof(framebuffer));
+    level_graph_draw(framebuffer, &graph_history, 0, 850, 900);
+    graph_send(&level_graph_area, false);
+
+    for (int second = 0; second < GRAPH_BENCH_SECONDS; second++)
+    {
+        graph_next_second(&seed);
+        uint32_t closed = history_closed(&graph_history, HISTORY_SECOND);
+
+        uint32_t before = ssd1306_bytes_sent;
+        level_graph_scroll(framebuffer, &graph_history, closed, 850, 900);
+        graph_send(&column, true);
+        scroll_bytes += ssd1306_bytes_sent - before;
+
+        wrong += memcmp(graph_panel.gddram, framebuffer, sizeof(framebuffer)) != 0;
+        memset(fresh, 0, sizeof(fresh));
+        level_graph_draw(fresh, &graph_history, closed, 850, 900);
+        wrong += memcmp(fresh, framebuffer, sizeof(fresh)) != 0;
+
+        before = ssd1306_bytes_sent;
+        graph_send(&level_graph_area, false);
+        redraw_bytes += ssd1306_bytes_sent - before;
+    }
+
+    printf("%-24s %-8s %u mismatches, %u bytes a second scrolled, %u redrawn\n", "level_graph_check", "-",
+           (unsigned)wrong, (unsigned)(scroll_bytes / GRAPH_BENCH_SECONDS),
+           (unsigned)(redraw_bytes / GRAPH_BENCH_SECONDS));
+    return wrong == 0;
+}
+
+static void run_string(void *ctx)
+{
+    ssd1306_draw_string(framebuffer, 0, 24, ctx);
+    bench_sink += framebuffer[3 * ssd1306_width];
+}
+
+static void run_lines(void *ctx)
+{
+    (void)ctx;
+
+    for (int x = 0; x < ssd1306_width; x += 8)
+    {
+        ssd1306_draw_line(framebuffer, x, 0, ssd1306_width - 1 - x, ssd1306_height - 1, true);
+    }
+    bench_sink += framebuffer[0];
+}
+
+// Text off the page grid straddles two pages
+static void run_string_shifted(void *ctx)
+{
+    ssd1306_draw_string(framebuffer, 0, 27, ctx);
+    bench_sink += framebuffer[3 * ssd1306_width];
+}
+
+static void run_diff(void *ctx)
+{
+    struct render_area areas[16];
+    int *level = ctx;
+    char text[16];
+
+    // Only the level digits change between frames, as on the device
+    snprintf(text, sizeof(text), "Level: %d", (*level)++ % 1000);
+    ssd1306_draw_string(framebuffer, 0, 16, text);
+    int count = ssd1306_diff_areas(framebuffer, shadow, areas, 16);
+    bench_sink += count ? areas[0].buffer_length : 0;
+}
+
+static void run_stream_full(void *ctx)
+{
+    const struct render_area *area = ctx;
+
+    ssd1306_stream_reset(&stream);
+    ssd1306_stream_area(&stream, framebuffer, area);
+    bench_sink += stream.count;
+}
+
+int bench_display(void)
+{
+    static char text[] = "LEVEL 0123456789";
+
+    printf("== framebuffer ==\n");
+
+    int level = 0;
+    bench_report("status_frame", "redraw", 1, "frame", bench_time_ns(run_status_frame, &level));
+    status_screen_init();
+    bench_report("status_widgets", "level", 1, "frame", bench_time_ns(run_status_widgets, &level));
+    bench_report("widget_format", "decidB", 1, "value", bench_time_ns(run_format, &level));
+    bench_report("snprintf", "decidB", 1, "value", bench_time_ns(run_snprintf, &level));
+    bench_report("draw_string", "16ch", sizeof(text) - 1, "char", bench_time_ns(run_string, text));
+    bench_report("draw_string", "16ch y+3", sizeof(text) - 1, "char", bench_time_ns(run_string_shifted, text));
+    level = 0;
+    run_status_frame(&level);
+    memcpy(shadow, framebuffer, sizeof(shadow));
+    bench_report("diff_areas", "digits", 1, "frame", bench_time_ns(run_diff, &level));
+
+    struct render_area full = {0, ssd1306_width - 1, 0, ssd1306_n_pages - 1, ssd1306_buffer_length};
+    bench_report("stream_area", "full", ssd1306_buffer_length, "byte", bench_time_ns(run_stream_full, &full));
+
+    bench_report("draw_line", "16x", ssd1306_width / 8, "line", bench_time_ns(run_lines, NULL));
+
+    int ok = widget_check();
+    return graph_check() && ok;
+}
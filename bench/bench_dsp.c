@@ -0,0 +1,389 @@
+#include "bench.h"
+#include "adc_rr.h"
+#include "block_stats.h"
+#include "calibration.h"
+#include "decimator.h"
+#include "level_meter.h"
+#include "signal_gen.h"
+#include "spectrum.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define BENCH_SAMPLE_RATE 500000
+#define BENCH_MAX_BLOCK 4096
+// Low enough for the lowest octaves to get FFT bins
+#define BENCH_SPECTRUM_RATE 48000
+
+static const uint32_t block_sizes[] = {64, 256, 1024, 4096};
+
+static uint16_t samples[BENCH_MAX_BLOCK];
+
+typedef struct
+{
+    const uint16_t *samples;
+    uint32_t count;
+} block_ctx_t;
+
+static void run_block_stats(void *ctx)
+{
+    block_ctx_t *block = ctx;
+    block_stats_t stats;
+    block_stats_compute(block->samples, block->count, &stats);
+    bench_sink += stats.rms_q8;
+}
+
+static void run_block_stats_ref(void *ctx)
+{
+    block_ctx_t *block = ctx;
+    block_stats_ref_t stats;
+    block_stats_compute_ref(block->samples, block->count, &stats);
+    bench_sink += (uint32_t)stats.rms;
+}
+
+static void run_adc_rr_split(void *ctx)
+{
+    static uint16_t audio[BENCH_MAX_BLOCK / ADC_RR_CHANNELS];
+    block_ctx_t *block = ctx;
+    bench_sink += adc_rr_split(block->samples, block->count / ADC_RR_CHANNELS, audio);
+}
+
+static void run_spectrum(void *ctx)
+{
+    static uint32_t bands[SPECTRUM_MAX_BANDS];
+    spectrum_t *spectrum = ctx;
+    block_stats_t stats;
+
+    // The monitor already has the block statistics, only the FFT is timed
+    block_stats_compute(samples, 1u << spectrum->log2n, &stats);
+    spectrum_compute(spectrum, samples, &stats, bands);
+    bench_sink += bands[0];
+}
+
+static void run_spectrum_ref(void *ctx)
+{
+    static double bands[SPECTRUM_MAX_BANDS];
+    spectrum_t *spectrum = ctx;
+
+    spectrum_compute_ref(spectrum, samples, bands);
+    bench_sink += (uint32_t)bands[0];
+}
+
+// Worst band difference against the float FFT, in dB, over bands holding
+// within 40 dB of the loudest one
+static double spectrum_error_db(spectrum_t *spectrum)
+{
+    uint32_t bands[SPECTRUM_MAX_BANDS];
+    double ref[SPECTRUM_MAX_BANDS];
+    block_stats_t stats;
+
+    block_stats_compute(samples, 1u << spectrum->log2n, &stats);
+    spectrum_compute(spectrum, samples, &stats, bands);
+    spectrum_compute_ref(spectrum, samples, ref);
+
+    double loudest = 0.0;
+    for (unsigned band = 0; band < spectrum->band_count; band++)
+    {
+        loudest = fmax(loudest, ref[band]);
+    }
+
+    double worst = 0.0;
+    for (unsigned band = 0; band < spectrum->band_count; band++)
+    {
+        if (ref[band] > loudest / 100.0 && bands[band] > 0)
+        {
+            worst = fmax(worst, fabs(20.0 * log10(bands[band] / 256.0 / ref[band])));
+        }
+    }
+    return worst;
+}
+
+static void bench_spectrum(void)
+{
+    static const struct
+    {
+        spectrum_resolution_t resolution;
+        const char *name;
+    } resolutions[] = {
+        {SPECTRUM_OCTAVE, "oct"},
+        {SPECTRUM_THIRD_OCTAVE, "3rd"},
+    };
+    static spectrum_t spectrum;
+
+    printf("== spectrum ==\n");
+
+    for (signal_kind_t kind = 0; kind < SIGNAL_KIND_COUNT; kind++)
+    {
+        for (unsigned log2n = 8; log2n <= DSP_FFT_MAX_LOG2; log2n++)
+        {
+            for (size_t r = 0; r < sizeof(resolutions) / sizeof(resolutions[0]); r++)
+            {
+                signal_gen_t gen;
+                char input[32];
+
+                signal_gen_init(&gen, kind, BENCH_SPECTRUM_RATE, 1000, 600);
+                signal_gen_fill(&gen, samples, 1u << log2n);
+                spectrum_init(&spectrum, resolutions[r].resolution, log2n, BENCH_SPECTRUM_RATE);
+
+                snprintf(input, sizeof(input), "%s/%s", signal_gen_name(kind), resolutions[r].name);
+                bench_report("spectrum", input, 1u << log2n, "sample", bench_time_ns(run_spectrum, &spectrum));
+                bench_report("spectrum_ref", input, 1u << log2n, "sample",
+                             bench_time_ns(run_spectrum_ref, &spectrum));
+                printf("%-24s %-8s %6u %10.3f dB max band error\n", "spectrum", input, 1u << log2n,
+                       spectrum_error_db(&spectrum));
+            }
+        }
+    }
+}
+
+static void run_decimator(void *ctx)
+{
+    static uint16_t audio[BENCH_MAX_BLOCK];
+    decimator_t *decimator = ctx;
+    bench_sink += decimator_process(decimator, samples, BENCH_MAX_BLOCK, audio);
+}
+
+// Output RMS of a raw-rate sine through the decimator, relative to the
+// input, after the filters have settled
+static double decimator_gain_db(decimator_t *decimator, uint32_t raw_rate, double frequency)
+{
+    static uint16_t audio[BENCH_MAX_BLOCK];
+    const double amplitude = 1000.0;
+    double sum_sq = 0.0;
+    uint32_t outputs = 0;
+
+    for (uint32_t pass = 0, n = 0; pass < 8; pass++)
+    {
+        for (uint32_t j = 0; j < BENCH_MAX_BLOCK; j++, n++)
+        {
+            samples[j] = (uint16_t)lround(DECIMATOR_MIDSCALE + amplitude * sin(2.0 * M_PI * frequency * n / raw_rate));
+        }
+        uint32_t count = decimator_process(decimator, samples, BENCH_MAX_BLOCK, audio);
+        for (uint32_t j = 0; pass >= 2 && j < count; j++, outputs++)
+        {
+            double ac = audio[j] - (double)DECIMATOR_MIDSCALE;
+            sum_sq += ac * ac;
+        }
+    }
+
+    // Floor at the output quantisation so rejected tones stay finite
+    double rms = fmax(sqrt(sum_sq / outputs), 1.0 / sqrt(12.0));
+    return 20.0 * log10(rms / (amplitude / M_SQRT2));
+}
+
+static void bench_decimator(void)
+{
+    static decimator_t decimator;
+
+    printf("== decimator ==\n");
+
+    for (unsigned i = 0; i < DSP_DECIMATOR_CONFIGS; i++)
+    {
+        uint32_t rate = dsp_decimator_configs[i].audio_rate;
+        unsigned ratio = dsp_decimator_configs[i].cic_ratio * 2u;
+        uint32_t raw_rate = rate * ratio;
+        char input[16];
+
+        snprintf(input, sizeof(input), "%uk/%u", rate / 1000, ratio);
+        decimator_init(&decimator, rate, ratio);
+        signal_gen_t gen;
+        signal_gen_init(&gen, SIGNAL_WHITE_NOISE, raw_rate, 1000, 600);
+        signal_gen_fill(&gen, samples, BENCH_MAX_BLOCK);
+        bench_report("decimator", input, BENCH_MAX_BLOCK, "sample", bench_time_ns(run_decimator, &decimator));
+
+        // Flatness up to 3/8 of the audio rate, and rejection of the raw
+        // frequencies that would fold back onto that passband
+        double ripple_min = 0.0, ripple_max = -100.0, alias = -200.0;
+        for (double f = 100.0; f <= 0.375 * rate; f += rate / 64.0)
+        {
+            decimator_init(&decimator, rate, ratio);
+            double gain = decimator_gain_db(&decimator, raw_rate, f);
+            ripple_min = fmin(ripple_min, gain);
+            ripple_max = fmax(ripple_max, gain);
+        }
+        for (double f = 0.625 * rate; f < 0.5 * raw_rate; f += rate / 64.0)
+        {
+            decimator_init(&decimator, rate, ratio);
+            alias = fmax(alias, decimator_gain_db(&decimator, raw_rate, f));
+        }
+        printf("%-24s %-8s %6u %10.3f dB passband ripple (%+.2f..%+.2f), worst alias %.1f dB\n", "decimator",
+               input, raw_rate, ripple_max - ripple_min, ripple_min, ripple_max, alias);
+    }
+}
+
+static void run_level_meter(void *ctx)
+{
+    level_meter_t *meter = ctx;
+    level_meter_process(meter, samples, BENCH_MAX_BLOCK);
+    bench_sink += (uint32_t)meter->block_sum_q6;
+}
+
+// Weighted level of a full-scale-ish sine after the Slow integrator has
+// settled, relative to its unweighted RMS, against the analog curve
+static void bench_weighting_response(weighting_curve_t curve, uint32_t rate)
+{
+    static const double frequencies[] = {31.5, 63, 125, 250, 500, 1000, 2000, 4000, 8000, 12500};
+    static level_meter_t meter;
+    const double amplitude = 1000.0;
+
+    for (size_t i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++)
+    {
+        double frequency = frequencies[i];
+        if (frequency >= rate / 2.0)
+        {
+            continue;
+        }
+
+        level_meter_init(&meter, curve, rate);
+        for (uint32_t done = 0, n = 0; done < 4 * rate; done += BENCH_MAX_BLOCK)
+        {
+            for (uint32_t j = 0; j < BENCH_MAX_BLOCK; j++, n++)
+            {
+                samples[j] = (uint16_t)lround(LEVEL_METER_MIDSCALE + amplitude * sin(2.0 * M_PI * frequency * n / rate));
+            }
+            // Leq only over the settled part
+            if (done < 2 * rate)
+            {
+                level_meter_reset_leq(&meter);
+            }
+            level_meter_process(&meter, samples, BENCH_MAX_BLOCK);
+        }
+
+        double measured = 20.0 * log10(level_meter_leq_q8(&meter) / 256.0 / (amplitude / M_SQRT2));
+        double expected = level_meter_response_ref(curve, frequency);
+        char input[32];
+        snprintf(input, sizeof(input), "%c/%uk/%.0f", curve == WEIGHTING_C ? 'C' : 'A', rate / 1000, frequency);
+        printf("%-24s %-8s %6u %10.3f dB (analog %.2f, error %+.2f dB)\n", "level_meter", input, rate,
+               measured, expected, measured - expected);
+    }
+}
+
+// A loud period then a quiet one: once the quiet one has filled the
+// window, the Leq has forgotten the loud one
+static void bench_leq_window(void)
+{
+    static level_meter_t meter;
+    const uint32_t rate = dsp_weighting_rate_hz[0];
+    const double amplitudes[2] = {1000.0, 10.0};
+    double leq_db[2];
+
+    level_meter_init(&meter, WEIGHTING_A, rate);
+    for (unsigned part = 0, n = 0; part < 2; part++)
+    {
+        for (uint32_t done = 0; done < LEVEL_METER_LEQ_S * rate; done += BENCH_MAX_BLOCK)
+        {
+            for (uint32_t j = 0; j < BENCH_MAX_BLOCK; j++, n++)
+            {
+                samples[j] =
+                    (uint16_t)lround(LEVEL_METER_MIDSCALE + amplitudes[part] * sin(2.0 * M_PI * 1000.0 * n / rate));
+            }
+            level_meter_process(&meter, samples, BENCH_MAX_BLOCK);
+        }
+        leq_db[part] = 20.0 * log10(level_meter_leq_q8(&meter) / 256.0 / (amplitudes[part] / M_SQRT2));
+    }
+    printf("%-24s %-8s %6u s window, tone at %+.2f dB, then %+.2f dB after %.0f dB quieter\n", "level_meter_leq",
+           "A/1k", LEVEL_METER_LEQ_S, leq_db[0], leq_db[1], 20.0 * log10(amplitudes[0] / amplitudes[1]));
+}
+
+static void bench_level_meter(void)
+{
+    static level_meter_t meter;
+
+    printf("== level meter ==\n");
+
+    for (unsigned i = 0; i < DSP_WEIGHTING_RATES; i++)
+    {
+        uint32_t rate = dsp_weighting_rate_hz[i];
+        signal_gen_t gen;
+        char input[16];
+
+        signal_gen_init(&gen, SIGNAL_WHITE_NOISE, rate, 1000, 600);
+        signal_gen_fill(&gen, samples, BENCH_MAX_BLOCK);
+
+        for (weighting_curve_t curve = WEIGHTING_A; curve <= WEIGHTING_C; curve++)
+        {
+            level_meter_init(&meter, curve, rate);
+            snprintf(input, sizeof(input), "%c/%uk", curve == WEIGHTING_C ? 'C' : 'A', rate / 1000);
+            bench_report("level_meter", input, BENCH_MAX_BLOCK, "sample", bench_time_ns(run_level_meter, &meter));
+        }
+    }
+
+    for (weighting_curve_t curve = WEIGHTING_A; curve <= WEIGHTING_C; curve++)
+    {
+        for (unsigned i = 0; i < DSP_WEIGHTING_RATES; i++)
+        {
+            bench_weighting_response(curve, dsp_weighting_rate_hz[i]);
+        }
+    }
+    bench_leq_window();
+}
+
+static void run_calibration(void *ctx)
+{
+    const calibration_t *calibration = ctx;
+
+    // A spread of levels so the table lookup is not always the same entry
+    for (uint32_t rms_q8 = 256; rms_q8 < (2048u << 8); rms_q8 += rms_q8 / 4 + 1)
+    {
+        bench_sink += (uint32_t)calibration_spl_decidb(calibration, rms_q8);
+    }
+}
+
+static void bench_calibration(void)
+{
+    calibration_t calibration;
+    unsigned calls = 0;
+    double worst = 0.0;
+    double worst_spl = 0.0;
+
+    printf("== calibration ==\n");
+
+    calibration_init(&calibration, &calibration_default_profile, 3300);
+    for (uint32_t rms_q8 = 256; rms_q8 < (2048u << 8); rms_q8 += rms_q8 / 4 + 1)
+    {
+        calls++;
+    }
+    bench_report("calibration_spl", "-", calls, "call", bench_time_ns(run_calibration, &calibration));
+
+    // Every Q8 step from 1 to 2048 counts, against the double formulas
+    for (uint32_t rms_q8 = 256; rms_q8 <= (2048u << 8); rms_q8++)
+    {
+        double counts_error = fabs(calibration_counts_decidb(rms_q8) / 10.0 - calibration_counts_db_ref(rms_q8 / 256.0));
+        double spl_error = fabs(calibration_spl_decidb(&calibration, rms_q8) / 10.0 -
+                                calibration_spl_db_ref(&calibration_default_profile, 3300, rms_q8 / 256.0));
+        worst = counts_error > worst ? counts_error : worst;
+        worst_spl = spl_error > worst_spl ? spl_error : worst_spl;
+    }
+    printf("%-24s %-8s %6s %10.3f dB max error\n", "calibration_counts", "1-2048", "-", worst);
+    printf("%-24s %-8s %6s %10.3f dB max error\n", "calibration_spl", "1-2048", "-", worst_spl);
+}
+
+void bench_dsp(void)
+{
+    printf("== dsp kernels ==\n");
+
+    for (signal_kind_t kind = 0; kind < SIGNAL_KIND_COUNT; kind++)
+    {
+        signal_gen_t gen;
+        signal_gen_init(&gen, kind, BENCH_SAMPLE_RATE, 1000, 600);
+        signal_gen_fill(&gen, samples, BENCH_MAX_BLOCK);
+
+        for (size_t i = 0; i < sizeof(block_sizes) / sizeof(block_sizes[0]); i++)
+        {
+            block_ctx_t block = {samples, block_sizes[i]};
+            const char *name = signal_gen_name(kind);
+
+            bench_report("block_stats", name, block.count, "sample",
+                         bench_time_ns(run_block_stats, &block));
+            bench_report("block_stats_ref", name, block.count, "sample",
+                         bench_time_ns(run_block_stats_ref, &block));
+            bench_report("adc_rr_split", name, block.count, "sample",
+                         bench_time_ns(run_adc_rr_split, &block));
+        }
+    }
+
+    bench_spectrum();
+    bench_decimator();
+    bench_level_meter();
+    bench_calibration();
+}
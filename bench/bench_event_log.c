@@ -0,0 +1,257 @@
+#include "bench.h"
+#include "event_log.h"
+#include "flash_ram.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define EVENT_BENCH_SECTORS 8
+// Power cut runs use a short region so each one crosses into a sector
+// that still holds records
+#define EVENT_BENCH_CUT_SECTORS 3
+#define EVENT_BENCH_CUT_BATCHES 8
+#define EVENT_BENCH_CUT_BATCH 5
+#define EVENT_BENCH_CUT_STEP 7
+
+static uint8_t storage[EVENT_BENCH_SECTORS * EVENT_LOG_SECTOR_SIZE];
+static flash_ram_t ram;
+static event_log_flash_t flash;
+static event_log_t log_a;
+static event_log_t log_b;
+
+// Contents follow from index, the order the records were appended in
+static event_record_t event_bench_record(uint32_t index)
+{
+    return (event_record_t){
+        .start_s = index,
+        .duration_s = (uint16_t)(index % 600),
+        .peak_decidb = (int16_t)(850 + index % 200),
+        .threshold_decidb = index & 1 ? 900 : 850,
+        .state = index & 1 ? 2 : 1,
+        .metric = (uint8_t)(index % 4)};
+}
+
+static bool event_bench_matches(const event_record_t *record, uint32_t index, uint16_t boot)
+{
+    event_record_t expected = event_bench_record(index);
+    return record->start_s == expected.start_s && record->duration_s == expected.duration_s &&
+           record->peak_decidb == expected.peak_decidb && record->threshold_decidb == expected.threshold_decidb &&
+           record->state == expected.state && record->metric == expected.metric && record->boot == boot;
+}
+
+static void event_bench_write(event_log_t *log, uint32_t first, uint32_t count, uint32_t batch)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        event_record_t record = event_bench_record(first + i);
+        event_log_append(log, &record);
+        if ((i + 1) % batch == 0 || i + 1 == count)
+        {
+            event_log_flush(log);
+        }
+    }
+}
+
+static void run_mount(void *ctx)
+{
+    event_log_mount(&log_b, ctx);
+    bench_sink += event_log_next_seq(&log_b);
+}
+
+static void run_append_flush(void *ctx)
+{
+    uint32_t *index = ctx;
+    event_record_t record = event_bench_record((*index)++);
+    event_log_append(&log_a, &record);
+    event_log_flush(&log_a);
+}
+
+// Fills the region many times over in uneven batches, then reads it all
+// back through a fresh mount
+static int event_bench_wrap(void)
+{
+    const uint32_t total = 20 * EVENT_BENCH_SECTORS * EVENT_LOG_RECORDS_PER_SECTOR + 37;
+    uint32_t bad = 0;
+
+    flash_ram_init(&ram, storage, EVENT_BENCH_SECTORS);
+    flash_ram_attach(&ram, &flash);
+    event_log_mount(&log_a, &flash);
+    for (uint32_t done = 0, batch = 1; done < total; done += batch, batch = batch % EVENT_LOG_QUEUE + 1)
+    {
+        event_bench_write(&log_a, done, total - done < batch ? total - done : batch, batch);
+    }
+
+    event_log_mount(&log_b, &flash);
+    uint32_t oldest = event_log_oldest_seq(&log_b);
+    for (uint32_t seq = oldest; seq < event_log_next_seq(&log_b); seq++)
+    {
+        event_record_t record;
+        bad += !event_log_read(&log_b, seq, &record) || !event_bench_matches(&record, seq, 0);
+    }
+
+    uint32_t least = UINT32_MAX;
+    uint32_t most = 0;
+    for (uint32_t s = 0; s < EVENT_BENCH_SECTORS; s++)
+    {
+        least = ram.erase_counts[s] < least ? ram.erase_counts[s] : least;
+        most = ram.erase_counts[s] > most ? ram.erase_counts[s] : most;
+    }
+
+    uint32_t kept = event_log_next_seq(&log_b) - oldest;
+    printf("%-24s %-8s %6u records, %u kept, %u unreadable, erases %u..%u per sector, boot %u\n", "event_log_wrap",
+           "-", total, kept, bad, least, most, log_b.boot);
+    return event_log_next_seq(&log_b) == total && bad == 0 && most - least <= 1 &&
+           kept >= (EVENT_BENCH_SECTORS - 1) * EVENT_LOG_RECORDS_PER_SECTOR && log_b.boot == 1;
+}
+
+static uint32_t event_bench_erases(void)
+{
+    uint32_t erases = 0;
+    for (uint32_t s = 0; s < ram.sectors; s++)
+    {
+        erases += ram.erase_counts[s];
+    }
+    return erases;
+}
+
+// The store task's order: erase ahead, then flush a batch. No flush may
+// erase, each header must carry its sector's erase count, and a mount with
+// a sector erased ahead must find everything still owed.
+static int event_bench_prepare(void)
+{
+    const uint32_t total = 3 * EVENT_BENCH_SECTORS * EVENT_LOG_RECORDS_PER_SECTOR + 11;
+    uint32_t prepared = 0;
+    uint32_t in_flush = 0;
+    uint32_t bad = 0;
+    bool mounted_spare = false;
+
+    flash_ram_init(&ram, storage, EVENT_BENCH_SECTORS);
+    flash_ram_attach(&ram, &flash);
+    event_log_mount(&log_a, &flash);
+    for (uint32_t done = 0, batch = 1; done < total; done += batch, batch = batch % EVENT_LOG_QUEUE + 1)
+    {
+        prepared += event_log_prepare(&log_a);
+        batch = total - done < batch ? total - done : batch;
+        uint32_t erases = event_bench_erases();
+        event_bench_write(&log_a, done, batch, batch);
+        in_flush += event_bench_erases() - erases;
+
+        // A reboot right after an erase ahead that dropped records
+        if (log_a.spare && !mounted_spare && done > EVENT_BENCH_SECTORS * EVENT_LOG_RECORDS_PER_SECTOR)
+        {
+            mounted_spare = true;
+            event_log_mount(&log_b, &flash);
+            for (uint32_t seq = event_log_oldest_seq(&log_a); seq < event_log_next_seq(&log_a); seq++)
+            {
+                event_record_t record;
+                bad += !event_log_read(&log_b, seq, &record) || !event_bench_matches(&record, seq, 0);
+            }
+            bad += event_log_next_seq(&log_b) != event_log_next_seq(&log_a);
+        }
+    }
+
+    for (uint32_t seq = event_log_oldest_seq(&log_a); seq < event_log_next_seq(&log_a); seq++)
+    {
+        event_record_t record;
+        bad += !event_log_read(&log_a, seq, &record) || !event_bench_matches(&record, seq, 0);
+    }
+    for (uint32_t s = 0; s < EVENT_BENCH_SECTORS; s++)
+    {
+        event_sector_header_t header;
+        memcpy(&header, storage + s * EVENT_LOG_SECTOR_SIZE, sizeof(header));
+        bad += header.magic == EVENT_LOG_MAGIC && header.erase_count != ram.erase_counts[s];
+    }
+
+    printf("%-24s %-8s %6u records, %u erased ahead, %u in a flush, %u wrong\n", "event_log_prepare", "-", total,
+           prepared, in_flush, bad);
+    return prepared > 0 && in_flush == 0 && bad == 0 && mounted_spare;
+}
+
+// One power cut after `writes` byte writes into a run of batches, then a
+// reboot: what was flushed before the cut must all be there, nothing read
+// back may differ from what went in, and the log must carry on
+static bool event_bench_cut(int64_t writes, uint32_t *torn)
+{
+    const uint32_t prefill = EVENT_BENCH_CUT_SECTORS * EVENT_LOG_RECORDS_PER_SECTOR - 12;
+    const uint32_t kept = (EVENT_BENCH_CUT_SECTORS - 1) * EVENT_LOG_RECORDS_PER_SECTOR;
+
+    flash_ram_init(&ram, storage, EVENT_BENCH_CUT_SECTORS);
+    flash_ram_attach(&ram, &flash);
+    event_log_mount(&log_a, &flash);
+    event_bench_write(&log_a, 0, prefill, EVENT_LOG_QUEUE);
+
+    flash_ram_cut_after(&ram, writes);
+    uint32_t durable = prefill;
+    for (uint32_t b = 0; b < EVENT_BENCH_CUT_BATCHES; b++)
+    {
+        event_bench_write(&log_a, prefill + b * EVENT_BENCH_CUT_BATCH, EVENT_BENCH_CUT_BATCH, EVENT_BENCH_CUT_BATCH);
+        if (!ram.cut)
+        {
+            durable = event_log_next_seq(&log_a);
+        }
+    }
+
+    flash_ram_power_on(&ram);
+    event_log_mount(&log_b, &flash);
+    uint32_t recovered = event_log_next_seq(&log_b);
+
+    // Before the cut seq and append order are the same. Opening a sector
+    // drops the oldest one on purpose, so only the last `kept` records
+    // behind what reached flash are owed.
+    bool ok = recovered >= durable && log_b.boot == 1;
+    for (uint32_t seq = event_log_oldest_seq(&log_b); seq < recovered; seq++)
+    {
+        event_record_t record;
+        if (event_log_read(&log_b, seq, &record))
+        {
+            ok &= event_bench_matches(&record, seq, 0);
+        }
+        else if (seq + kept >= recovered)
+        {
+            // Only the slot being programmed at the cut may be torn
+            ok &= seq >= durable;
+            (*torn)++;
+        }
+    }
+
+    // The first records after the reboot land behind whatever survived
+    const uint32_t resumed = 1000;
+    event_bench_write(&log_b, resumed, 3, 3);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        event_record_t record;
+        ok &= event_log_read(&log_b, recovered + i, &record) && event_bench_matches(&record, resumed + i, 1);
+    }
+    return ok;
+}
+
+int bench_event_log(void)
+{
+    printf("== event log ==\n");
+    printf("%-24s %-8s %6u bytes, %u per sector, %u in %u sectors\n", "event_record_t", "-",
+           (unsigned)sizeof(event_record_t), EVENT_LOG_RECORDS_PER_SECTOR,
+           EVENT_BENCH_SECTORS * EVENT_LOG_RECORDS_PER_SECTOR, EVENT_BENCH_SECTORS);
+
+    int ok = event_bench_wrap();
+    ok &= event_bench_prepare();
+
+    // Timings on the region the wrap run left full
+    bench_report("event_log_mount", "full", 1, "mount", bench_time_ns(run_mount, &flash));
+    uint32_t index = event_log_next_seq(&log_b);
+    event_log_mount(&log_a, &flash);
+    bench_report("event_log_append_flush", "1", 1, "record", bench_time_ns(run_append_flush, &index));
+
+    uint32_t cuts = 0;
+    uint32_t failed = 0;
+    uint32_t torn = 0;
+    int64_t span = 2 * EVENT_LOG_SECTOR_SIZE + EVENT_BENCH_CUT_BATCHES * EVENT_LOG_PAGE_SIZE;
+    for (int64_t writes = 0; writes < span; writes += EVENT_BENCH_CUT_STEP)
+    {
+        cuts++;
+        failed += !event_bench_cut(writes, &torn);
+    }
+    printf("%-24s %-8s %6u cuts, %u failed, %u torn slots skipped\n", "event_log_power_cut", "-", cuts, failed,
+           torn);
+
+    return ok && failed == 0;
+}
@@ -0,0 +1,201 @@
+#include "bench.h"
+#include "calibration.h"
+#include "history.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HISTORY_BENCH_RATE 48000
+#define HISTORY_BENCH_BLOCK 1024
+#define HISTORY_BENCH_VREF_MV 3300
+// Two hours and a bit, so every ring wraps at least once except the hours
+#define HISTORY_BENCH_SECONDS (2 * 3600 + 90)
+// Blocks in the longest period checked, an hour plus the one that straddles
+#define HISTORY_BENCH_MAX_BLOCKS (3600 * HISTORY_BENCH_RATE / HISTORY_BENCH_BLOCK + 2)
+#define HISTORY_BENCH_INPUTS 4096
+
+typedef struct
+{
+    int16_t levels[HISTORY_BENCH_MAX_BLOCKS];
+    double energy;
+    uint32_t count;
+} history_period_t;
+
+static history_t history;
+static calibration_t calibration;
+static history_period_t periods[HISTORY_RESOLUTION_COUNT];
+static int16_t sorted[HISTORY_BENCH_MAX_BLOCKS];
+static uint32_t inputs[HISTORY_BENCH_INPUTS][2];
+static uint32_t seed = 1;
+
+// Levels spread over about 66 dB, log-uniform in counts
+static uint32_t history_random_q8(void)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (uint32_t)(256.0 * exp2((seed >> 8) / 16777216.0 * 11.0));
+}
+
+static int compare_descending(const void *a, const void *b)
+{
+    return *(const int16_t *)b - *(const int16_t *)a;
+}
+
+// Level exceeded by `percent` of the blocks, straight from the sorted levels
+static double history_percentile_ref(const history_period_t *period, unsigned percent)
+{
+    for (uint32_t i = 0; i < period->count; i++)
+    {
+        sorted[i] = period->levels[i];
+    }
+    qsort(sorted, period->count, sizeof(sorted[0]), compare_descending);
+    uint32_t index = (period->count * percent + 99) / 100;
+    return sorted[index > 0 ? index - 1 : 0] / 10.0;
+}
+
+// Worst difference against the blocks of the period that just closed
+static double history_check(history_resolution_t resolution, double *worst_percentile)
+{
+    const history_period_t *period = &periods[resolution];
+    history_record_t record;
+    int16_t min = INT16_MAX;
+    int16_t max = INT16_MIN;
+
+    history_get(&history, resolution, 0, &record);
+    for (uint32_t i = 0; i < period->count; i++)
+    {
+        min = period->levels[i] < min ? period->levels[i] : min;
+        max = period->levels[i] > max ? period->levels[i] : max;
+    }
+
+    double leq = calibration_spl_db_ref(calibration.profile, HISTORY_BENCH_VREF_MV,
+                                        sqrt(period->energy / period->count) / 256.0);
+    double l10 = fabs(record.l10 / 10.0 - history_percentile_ref(period, 10));
+    double l90 = fabs(record.l90 / 10.0 - history_percentile_ref(period, 90));
+    *worst_percentile = fmax(*worst_percentile, fmax(l10, l90));
+
+    if (record.min != min || record.max != max)
+    {
+        return INFINITY;
+    }
+    return fabs(record.leq / 10.0 - leq);
+}
+
+static void run_add(void *ctx)
+{
+    uint32_t *n = ctx;
+    uint32_t i = (*n)++ % HISTORY_BENCH_INPUTS;
+    history_add(&history, inputs[i][0], inputs[i][1]);
+}
+
+int bench_history(void)
+{
+    double worst_leq[HISTORY_RESOLUTION_COUNT] = {0};
+    double worst_percentile[HISTORY_RESOLUTION_COUNT] = {0};
+    uint32_t closed[HISTORY_RESOLUTION_COUNT] = {0};
+
+    printf("== history ==\n");
+    printf("%-24s %-8s %6u bytes (budget %u)\n", "history_t", "-", (unsigned)sizeof(history_t),
+           HISTORY_RAM_BUDGET);
+
+    calibration_init(&calibration, &calibration_default_profile, HISTORY_BENCH_VREF_MV);
+    history_init(&history, &calibration, HISTORY_BENCH_BLOCK, HISTORY_BENCH_RATE);
+    // Inputs drawn beforehand so the timing is the store alone
+    for (uint32_t i = 0; i < HISTORY_BENCH_INPUTS; i++)
+    {
+        inputs[i][0] = history_random_q8();
+        inputs[i][1] = history_random_q8();
+    }
+    uint32_t n = 0;
+    bench_report("history_add", "-", 1, "block", bench_time_ns(run_add, &n));
+
+    // Every closed second, minute and hour against the blocks that went in
+    history_init(&history, &calibration, HISTORY_BENCH_BLOCK, HISTORY_BENCH_RATE);
+    uint32_t blocks = (uint32_t)((uint64_t)HISTORY_BENCH_SECONDS * HISTORY_BENCH_RATE / HISTORY_BENCH_BLOCK);
+    for (uint32_t n = 0; n < blocks; n++)
+    {
+        uint32_t fast_q8 = history_random_q8();
+        uint32_t block_q8 = history_random_q8();
+
+        for (unsigned r = 0; r < HISTORY_RESOLUTION_COUNT; r++)
+        {
+            periods[r].levels[periods[r].count++] = (int16_t)calibration_spl_decidb(&calibration, fast_q8);
+            periods[r].energy += (double)block_q8 * block_q8;
+        }
+
+        history_add(&history, fast_q8, block_q8);
+
+        for (unsigned r = 0; r < HISTORY_RESOLUTION_COUNT; r++)
+        {
+            if (history_closed(&history, r) != closed[r])
+            {
+                closed[r] = history_closed(&history, r);
+                worst_leq[r] = fmax(worst_leq[r], history_check(r, &worst_percentile[r]));
+                periods[r].count = 0;
+                periods[r].energy = 0.0;
+            }
+        }
+    }
+
+    static const char *const names[HISTORY_RESOLUTION_COUNT] = {"second", "minute", "hour"};
+    int ok = 1;
+    for (unsigned r = 0; r < HISTORY_RESOLUTION_COUNT; r++)
+    {
+        printf("%-24s %-8s %6u closed, %3u kept, Leq %.3f dB, L10/L90 %.2f dB max error\n", "history_rollup",
+               names[r], closed[r], history_available(&history, r), worst_leq[r], worst_percentile[r]);
+        // Min and max are exact, percentiles within a bucket
+        ok &= worst_leq[r] < 0.1 && worst_percentile[r] <= HISTORY_BUCKET_DECIDB / 10.0;
+    }
+
+    history_record_t record;
+    ok &= history_get(&history, HISTORY_SECOND, HISTORY_SECONDS - 1, &record) &&
+          !history_get(&history, HISTORY_SECOND, HISTORY_SECONDS, &record);
+
+    // By period number, the same records as by age and nothing outside them
+    for (unsigned r = 0; r < HISTORY_RESOLUTION_COUNT; r++)
+    {
+        history_record_t by_period;
+        uint32_t oldest = closed[r] - history_available(&history, r);
+        for (uint32_t age = 0; age < history_available(&history, r); age++)
+        {
+            ok &= history_get(&history, r, age, &record) &&
+                  history_get_period(&history, r, closed[r] - 1 - age, &by_period) &&
+                  memcmp(&record, &by_period, sizeof(record)) == 0;
+        }
+        ok &= !history_get_period(&history, r, closed[r], &by_period) &&
+              (oldest == 0 || !history_get_period(&history, r, oldest - 1, &by_period));
+    }
+    ok &= closed[HISTORY_SECOND] == (uint64_t)blocks * HISTORY_BENCH_BLOCK / HISTORY_BENCH_RATE &&
+          closed[HISTORY_HOUR] == 2;
+
+    // Samples lost half a second in move that second's clock on; two seconds
+    // lost only take it to the next block. Both gaps reach the minute.
+    history_init(&history, &calibration, HISTORY_BENCH_BLOCK, HISTORY_BENCH_RATE);
+    uint32_t added = 0;
+    for (; added < 10; added++)
+    {
+        history_add(&history, inputs[added][0], inputs[added][1]);
+    }
+    history_gap(&history, HISTORY_BENCH_RATE / 2);
+    for (; history_closed(&history, HISTORY_SECOND) == 0; added++)
+    {
+        history_add(&history, inputs[added][0], inputs[added][1]);
+    }
+    ok &= added == 10 + (HISTORY_BENCH_RATE / 2 - 10 * HISTORY_BENCH_BLOCK + HISTORY_BENCH_BLOCK - 1) /
+                            HISTORY_BENCH_BLOCK;
+    ok &= history_get(&history, HISTORY_SECOND, 0, &record) && record.gaps == 1;
+    history_add(&history, inputs[0][0], inputs[0][1]);
+    history_gap(&history, 2 * HISTORY_BENCH_RATE);
+    history_add(&history, inputs[1][0], inputs[1][1]);
+    ok &= history_closed(&history, HISTORY_SECOND) == 2 && history_get(&history, HISTORY_SECOND, 0, &record) &&
+          record.gaps == 1;
+    for (n = 0; history_closed(&history, HISTORY_MINUTE) == 0; n++)
+    {
+        history_add(&history, inputs[n % HISTORY_BENCH_INPUTS][0], inputs[n % HISTORY_BENCH_INPUTS][1]);
+    }
+    ok &= history_get(&history, HISTORY_MINUTE, 0, &record) && record.gaps == 2 &&
+          history_get(&history, HISTORY_SECOND, 0, &record) && record.gaps == 0;
+    printf("%-24s %-8s %s\n", "history_gap", "-", ok ? "ok" : "mismatch");
+    return ok;
+}
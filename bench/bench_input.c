@@ -0,0 +1,283 @@
+#include "bench.h"
+#include "debounce.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SCRIPT_MAX_EVENTS 64
+#define FUZZ_PRESSES 20000u
+
+// Same timings as the firmware's threshold buttons and joystick button
+static const debounce_config_t repeat_config = {
+    .settle_ms = 20,
+    .hold_ms = 400,
+    .repeat_ms = 200,
+    .repeat_min_ms = 40,
+};
+
+static const debounce_config_t long_press_config = {
+    .settle_ms = 20,
+    .hold_ms = 1000,
+};
+
+static const debounce_config_t plain_config = {
+    .settle_ms = 20,
+};
+
+// The line goes to level at time_ms; a lost edge changes the line but its
+// interrupt never reaches the task
+typedef struct
+{
+    uint32_t time_ms;
+    bool level;
+    bool lost;
+} script_edge_t;
+
+typedef struct
+{
+    uint32_t time_ms;
+    debounce_event_t event;
+    uint32_t repeats;
+} script_event_t;
+
+typedef struct
+{
+    const char *name;
+    const debounce_config_t *config;
+    script_edge_t edges[16];
+    unsigned edge_count;
+    uint32_t end_ms;
+
+    // Expected events, then how many times the task may wake on a timer
+    // without anything to do
+    script_event_t events[SCRIPT_MAX_EVENTS];
+    unsigned event_count;
+    unsigned idle_wakes;
+} script_t;
+
+typedef struct
+{
+    script_event_t events[SCRIPT_MAX_EVENTS];
+    unsigned event_count;
+    unsigned timer_wakes;
+    unsigned idle_wakes;
+} script_run_t;
+
+// Plays the input task: sleeps until the next edge or the deadline the
+// button asks for, feeds the edge, then takes what is due
+static void script_play(const script_t *script, script_run_t *run)
+{
+    debounce_t button;
+    bool level = false;
+    uint32_t now_ms = 0;
+    unsigned next = 0;
+
+    debounce_init(&button, script->config, false);
+    run->event_count = 0;
+    run->timer_wakes = 0;
+    run->idle_wakes = 0;
+
+    while (1)
+    {
+        uint32_t wait_ms = debounce_wait_ms(&button, now_ms);
+        uint32_t due_ms = wait_ms == DEBOUNCE_IDLE ? UINT32_MAX : now_ms + wait_ms;
+        uint32_t edge_ms = next < script->edge_count ? script->edges[next].time_ms : UINT32_MAX;
+        bool timer = false;
+
+        if (edge_ms <= due_ms && edge_ms <= script->end_ms)
+        {
+            now_ms = edge_ms;
+            level = script->edges[next].level;
+            if (!script->edges[next].lost)
+            {
+                debounce_edge(&button, now_ms);
+            }
+            next++;
+        }
+        else if (due_ms <= script->end_ms)
+        {
+            now_ms = due_ms;
+            timer = true;
+            run->timer_wakes++;
+        }
+        else
+        {
+            return;
+        }
+
+        debounce_event_t event = debounce_update(&button, level, now_ms);
+        if (event != DEBOUNCE_NONE && run->event_count < SCRIPT_MAX_EVENTS)
+        {
+            run->events[run->event_count++] = (script_event_t){now_ms, event, button.repeats};
+        }
+        else if (event == DEBOUNCE_NONE && timer)
+        {
+            run->idle_wakes++;
+        }
+    }
+}
+
+static const char *event_name(debounce_event_t event)
+{
+    return event == DEBOUNCE_PRESS ? "press" : event == DEBOUNCE_RELEASE ? "release" : "repeat";
+}
+
+static int script_check(const script_t *script)
+{
+    script_run_t run;
+    script_play(script, &run);
+
+    int ok = run.event_count == script->event_count && run.idle_wakes == script->idle_wakes;
+    for (unsigned i = 0; ok && i < run.event_count; i++)
+    {
+        ok = run.events[i].time_ms == script->events[i].time_ms && run.events[i].event == script->events[i].event &&
+             run.events[i].repeats == script->events[i].repeats;
+    }
+
+    printf("%-24s %-8s %2u events, %2u timer wakes, %u idle %s\n", "debounce_script", script->name, run.event_count,
+           run.timer_wakes, run.idle_wakes, ok ? "ok" : "MISMATCH");
+    if (!ok)
+    {
+        for (unsigned i = 0; i < run.event_count; i++)
+        {
+            printf("    %6u ms %s %u\n", run.events[i].time_ms, event_name(run.events[i].event), run.events[i].repeats);
+        }
+    }
+    return ok;
+}
+
+#define PRESS(t) {t, DEBOUNCE_PRESS, 0}
+#define RELEASE(t, r) {t, DEBOUNCE_RELEASE, r}
+#define REPEAT(t, r) {t, DEBOUNCE_REPEAT, r}
+
+static const script_t scripts[] = {
+    {"clean", &plain_config, {{100, 1}, {250, 0}}, 2, 1000, {PRESS(120), RELEASE(270, 0)}, 2, 0},
+    // Contacts chatter for a few ms both ways; the settle runs from the last flip
+    {"bounce",
+     &plain_config,
+     {{100, 1}, {101, 0}, {103, 1}, {104, 0}, {107, 1}, {300, 0}, {302, 1}, {305, 0}},
+     8,
+     1000,
+     {PRESS(127), RELEASE(325, 0)},
+     2,
+     0},
+    // Shorter than the settle time, so never a press
+    {"glitch", &plain_config, {{100, 1}, {105, 0}, {500, 1}, {519, 0}}, 4, 1000, {{0}}, 0, 2},
+    // The edge that ends each burst never arrives; the level read at the
+    // end of the settle still finds it
+    {"lost edge",
+     &plain_config,
+     {{100, 1}, {101, 0}, {102, 1, true}, {300, 0}, {301, 1}, {302, 0, true}},
+     6,
+     1000,
+     {PRESS(121), RELEASE(321, 0)},
+     2,
+     0},
+    // Gaps shrink by a quarter from 200 ms down to 40 ms
+    {"hold",
+     &repeat_config,
+     {{100, 1}, {1350, 0}},
+     2,
+     2000,
+     {PRESS(120), REPEAT(520, 1), REPEAT(720, 2), REPEAT(870, 3), REPEAT(983, 4), REPEAT(1068, 5),
+      REPEAT(1132, 6), REPEAT(1180, 7), REPEAT(1220, 8), REPEAT(1260, 9), REPEAT(1300, 10), REPEAT(1340, 11),
+      RELEASE(1370, 11)},
+     13,
+     0},
+    // Chatter while held pauses the repeats without a release
+    {"held chatter",
+     &repeat_config,
+     {{100, 1}, {600, 0}, {602, 1}, {603, 0}, {604, 1}, {900, 0}},
+     6,
+     2000,
+     {PRESS(120), REPEAT(520, 1), REPEAT(720, 2), REPEAT(870, 3), RELEASE(920, 3)},
+     5,
+     1},
+    {"short press", &long_press_config, {{100, 1}, {103, 0}, {104, 1}, {700, 0}}, 4, 3000,
+     {PRESS(124), RELEASE(720, 0)}, 2, 0},
+    // One repeat and no more is the long press
+    {"long press", &long_press_config, {{100, 1}, {2500, 0}}, 2, 3000,
+     {PRESS(120), REPEAT(1120, 1), RELEASE(2520, 1)}, 3, 0},
+};
+
+// Random bursts of bounce, each ending on the opposite level and holding it
+// at least the settle time: exactly one event per burst, one settle after
+// its last flip
+static int fuzz_check(void)
+{
+    static script_edge_t edges[FUZZ_PRESSES * 8];
+    debounce_t button;
+    unsigned count = 0;
+    uint32_t now_ms = 0;
+    bool level = false;
+    uint32_t late = 0;
+    uint32_t wrong = 0;
+
+    srand(21);
+    debounce_init(&button, &plain_config, false);
+    for (unsigned n = 0; n < FUZZ_PRESSES; n++)
+    {
+        level = !level;
+        unsigned flips = 2 * (unsigned)(rand() % 4) + 1;
+        for (unsigned f = 0; f < flips; f++)
+        {
+            now_ms += f ? 1 + (uint32_t)(rand() % (plain_config.settle_ms - 1)) : 1 + (uint32_t)(rand() % 5);
+            edges[count++] = (script_edge_t){now_ms, f % 2 == 0 ? level : !level, false};
+        }
+        uint32_t last_ms = now_ms;
+        now_ms += plain_config.settle_ms + (uint32_t)(rand() % 300);
+
+        // Wake only when asked to, as the task does
+        debounce_edge(&button, edges[count - flips].time_ms);
+        for (unsigned f = 1; f < flips; f++)
+        {
+            uint32_t wait_ms = debounce_wait_ms(&button, edges[count - flips + f - 1].time_ms);
+            if (edges[count - flips + f - 1].time_ms + wait_ms < edges[count - flips + f].time_ms)
+            {
+                wrong++;
+            }
+            debounce_edge(&button, edges[count - flips + f].time_ms);
+        }
+        uint32_t due_ms = last_ms + debounce_wait_ms(&button, last_ms);
+        debounce_event_t event = debounce_update(&button, level, due_ms);
+        if (due_ms != last_ms + plain_config.settle_ms)
+        {
+            late++;
+        }
+        if (event != (level ? DEBOUNCE_PRESS : DEBOUNCE_RELEASE) ||
+            debounce_wait_ms(&button, due_ms) != DEBOUNCE_IDLE)
+        {
+            wrong++;
+        }
+    }
+
+    printf("%-24s %-8s %6u presses, %u edges, %u late, %u wrong\n", "debounce_fuzz", "-", FUZZ_PRESSES, count, late,
+           wrong);
+    return late == 0 && wrong == 0;
+}
+
+// A held button, one millisecond per call
+static void run_update(void *ctx)
+{
+    static uint32_t now_ms;
+    debounce_t *button = ctx;
+    now_ms++;
+    bench_sink += debounce_update(button, true, now_ms) + debounce_wait_ms(button, now_ms);
+}
+
+int bench_input(void)
+{
+    printf("== input ==\n");
+
+    debounce_t button;
+    debounce_init(&button, &repeat_config, true);
+    bench_report("debounce_update", "held", 1, "call", bench_time_ns(run_update, &button));
+
+    int ok = 1;
+    for (unsigned i = 0; i < sizeof(scripts) / sizeof(scripts[0]); i++)
+    {
+        ok &= script_check(&scripts[i]);
+    }
+    return ok & fuzz_check();
+}
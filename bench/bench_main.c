@@ -0,0 +1,155 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+volatile uint32_t bench_sink;
+
+static uint32_t bench_min_time_ms = 200;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void bench_set_min_time_ms(uint32_t min_time_ms)
+{
+    bench_min_time_ms = min_time_ms;
+}
+
+double bench_time_ns(bench_fn fn, void *ctx)
+{
+    // Warm caches and branch predictors before timing
+    fn(ctx);
+
+    uint64_t budget = (uint64_t)bench_min_time_ms * 1000000ull;
+    uint64_t calls = 0;
+    uint64_t start = bench_now_ns();
+    uint64_t elapsed;
+    do
+    {
+        fn(ctx);
+        calls++;
+        elapsed = bench_now_ns() - start;
+    } while (elapsed < budget);
+
+    return (double)elapsed / calls;
+}
+
+void bench_report(const char *kernel, const char *input, uint32_t units,
+                  const char *unit_name, double ns_per_call)
+{
+    double ns_per_unit = ns_per_call / units;
+    printf("%-24s %-8s %6u %10.3f ns/%-7s %10.2f M%s/s\n",
+           kernel, input, units, ns_per_unit, unit_name, 1000.0 / ns_per_unit, unit_name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *only = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            bench_set_min_time_ms(20);
+        }
+        else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc)
+        {
+            only = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--quick] [--only dsp|display|state|history|events|telemetry|profile|trace|input|clip|replay|capture]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!only || strcmp(only, "dsp") == 0)
+    {
+        bench_dsp();
+    }
+    if (!only || strcmp(only, "display") == 0)
+    {
+        if (!bench_display())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "state") == 0)
+    {
+        if (!bench_state())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "history") == 0)
+    {
+        if (!bench_history())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "events") == 0)
+    {
+        if (!bench_event_log())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "profile") == 0)
+    {
+        if (!bench_profile())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "trace") == 0)
+    {
+        if (!bench_trace())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "input") == 0)
+    {
+        if (!bench_input())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "telemetry") == 0)
+    {
+        if (!bench_telemetry())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "clip") == 0)
+    {
+        if (!bench_clip())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "capture") == 0)
+    {
+        if (!bench_capture())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!only || strcmp(only, "replay") == 0)
+    {
+        if (!bench_replay())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
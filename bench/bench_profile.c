@@ -0,0 +1,71 @@
+#include "bench.h"
+#include "profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PROFILE_BENCH_RUNS 100000
+
+static profile_stage_t stage;
+static uint32_t durations[PROFILE_BENCH_RUNS];
+static uint32_t seed = 3;
+
+// Mostly short runs with a long tail, like a stage that is sometimes preempted
+static uint32_t profile_random_us(void)
+{
+    seed = seed * 1664525u + 1013904223u;
+    uint32_t shift = (seed >> 28) % 15;
+    return (seed >> 8) % (4u << shift);
+}
+
+static int compare_ascending(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_record(void *ctx)
+{
+    uint32_t *n = ctx;
+    profile_stage_record(&stage, durations[(*n)++ % PROFILE_BENCH_RUNS]);
+}
+
+int bench_profile(void)
+{
+    printf("== profile ==\n");
+
+    uint64_t total = 0;
+    profile_stage_init(&stage);
+    for (uint32_t i = 0; i < PROFILE_BENCH_RUNS; i++)
+    {
+        durations[i] = profile_random_us();
+        total += durations[i];
+        profile_stage_record(&stage, durations[i]);
+    }
+
+    profile_stats_t stats;
+    profile_stage_read(&stage, &stats);
+    qsort(durations, PROFILE_BENCH_RUNS, sizeof(durations[0]), compare_ascending);
+
+    // A percentile is the top of the bin holding the sorted value, so it is
+    // at least that value and less than twice it
+    int ok = stats.count == PROFILE_BENCH_RUNS && stats.min_us == durations[0] &&
+             stats.max_us == durations[PROFILE_BENCH_RUNS - 1] &&
+             profile_mean_us(&stats) == (uint32_t)((total + PROFILE_BENCH_RUNS / 2) / PROFILE_BENCH_RUNS);
+    static const unsigned percents[] = {10, 50, 90, 99, 100};
+    for (unsigned p = 0; p < sizeof(percents) / sizeof(percents[0]); p++)
+    {
+        uint32_t exact = durations[(PROFILE_BENCH_RUNS * percents[p] + 99) / 100 - 1];
+        uint32_t binned = profile_percentile_us(&stats, percents[p]);
+        ok &= binned >= exact && binned <= 2 * exact + 1;
+        printf("%-24s p%-7u %6u us exact, %u us binned\n", "profile_percentile", percents[p], exact, binned);
+    }
+    printf("%-24s %-8s %6u runs, min %u, mean %u, max %u us\n", "profile_stats", "-", stats.count, stats.min_us,
+           profile_mean_us(&stats), stats.max_us);
+
+    // What the instrumentation adds to each timed stage
+    uint32_t n = 0;
+    bench_report("profile_stage_record", "-", 1, "run", bench_time_ns(run_record, &n));
+    return ok;
+}
@@ -0,0 +1,221 @@
+#include "bench.h"
+#include "capture_file.h"
+#include "capture_replay.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define REPLAY_BENCH_RATE 48000
+#define REPLAY_BENCH_SAMPLES 1024
+#define REPLAY_BENCH_SPECTRUM_LOG2 9
+#define REPLAY_BENCH_BLOCKS 470
+#define REPLAY_BENCH_VREF_MV 3300
+// Microphone bias off midscale, as on a real board, which the weighting
+// filters ring on when they start from rest
+#define REPLAY_BENCH_BIAS 2400
+// Block the device lost samples ahead of, one erase stall's worth, in a
+// quiet stretch
+#define REPLAY_BENCH_GAP_BLOCK 240
+#define REPLAY_BENCH_GAP_LOST 2160
+
+// Room for the header, every block, a threshold change every 64 blocks
+// and the gap
+#define REPLAY_BENCH_FILE                                                                                      \
+    (sizeof(capture_file_header_t) +                                                                           \
+     REPLAY_BENCH_BLOCKS * (CAPTURE_CHUNK_BYTES(CAPTURE_PACKED_BYTES(REPLAY_BENCH_SAMPLES)) +                   \
+                            CAPTURE_CHUNK_BYTES(sizeof(capture_file_thresholds_t))) +                          \
+     CAPTURE_CHUNK_BYTES(sizeof(uint32_t)))
+
+static uint16_t blocks[REPLAY_BENCH_BLOCKS][REPLAY_BENCH_SAMPLES];
+static monitor_thresholds_t block_thresholds[REPLAY_BENCH_BLOCKS];
+static uint32_t block_lost[REPLAY_BENCH_BLOCKS];
+static uint8_t file[REPLAY_BENCH_FILE];
+static size_t file_len;
+static noise_pipeline_t pipeline;
+
+typedef struct
+{
+    const monitor_thresholds_t *thresholds;
+    capture_replay_trace_t expected[REPLAY_BENCH_BLOCKS];
+    uint32_t seen;
+    unsigned wrong;
+} replay_check_t;
+
+static replay_check_t check;
+
+// Ten seconds of a tone stepping between quiet and loud over noise, so the
+// alarm goes through every state, thresholds moved now and then as the
+// buttons would, and samples lost once in the middle of a loud stretch
+static void replay_bench_capture(void)
+{
+    uint32_t seed = 3;
+    monitor_thresholds_t thresholds = {
+        NOISE_THRESHOLD_WARNING, NOISE_THRESHOLD_DANGER, DEFAULT_GAP, MONITOR_METRIC_LEVEL};
+    capture_file_header_t header;
+
+    capture_file_header_init(&header, REPLAY_BENCH_RATE, REPLAY_BENCH_SAMPLES, REPLAY_BENCH_VREF_MV,
+                             &calibration_default_profile, WEIGHTING_A, REPLAY_BENCH_SPECTRUM_LOG2, "bench");
+    memcpy(file, &header, sizeof(header));
+    file_len = sizeof(header);
+
+    for (uint32_t block = 0; block < REPLAY_BENCH_BLOCKS; block++)
+    {
+        uint32_t skipped = block >= REPLAY_BENCH_GAP_BLOCK ? REPLAY_BENCH_GAP_LOST : 0;
+        double amplitude = 20.0 * pow(2.0, (block / 47) % 5);
+        for (uint32_t i = 0; i < REPLAY_BENCH_SAMPLES; i++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            double t = (double)(block * REPLAY_BENCH_SAMPLES + i + skipped) / REPLAY_BENCH_RATE;
+            int sample =
+                REPLAY_BENCH_BIAS + (int)lround(amplitude * sin(2.0 * M_PI * 1000.0 * t)) + (int)(seed >> 28) - 8;
+            blocks[block][i] = (uint16_t)(sample < 0 ? 0 : sample > 4095 ? 4095 : sample);
+        }
+
+        if (block % 64 == 32)
+        {
+            thresholds.warning -= 2 * THRESHOLD_STEP;
+            thresholds.danger -= 2 * THRESHOLD_STEP;
+            thresholds.metric = (thresholds.metric + 1) % MONITOR_METRIC_COUNT;
+            file_len += capture_file_write_thresholds(file + file_len, block, &thresholds);
+        }
+        block_thresholds[block] = thresholds;
+        if (block == REPLAY_BENCH_GAP_BLOCK)
+        {
+            block_lost[block] = REPLAY_BENCH_GAP_LOST;
+            file_len += capture_file_write_gap(file + file_len, block, REPLAY_BENCH_GAP_LOST);
+        }
+        file_len += capture_file_write_block(file + file_len, block, blocks[block], REPLAY_BENCH_SAMPLES);
+    }
+}
+
+static void replay_bench_expect(const capture_replay_trace_t *trace, void *ctx)
+{
+    replay_check_t *c = ctx;
+
+    if (c->seen >= REPLAY_BENCH_BLOCKS ||
+        memcmp(trace, &c->expected[c->seen], sizeof(*trace)) != 0)
+    {
+        c->wrong++;
+    }
+    c->seen++;
+}
+
+static void run_replay(void *ctx)
+{
+    capture_replay_result_t result;
+
+    (void)ctx;
+    capture_replay(&pipeline, file, file_len, NULL, NULL, &result);
+    bench_sink += (uint32_t)result.hash;
+}
+
+static void run_pipeline(void *ctx)
+{
+    static uint32_t block;
+    int metric_level;
+
+    (void)ctx;
+    bench_sink += noise_pipeline_process(&pipeline, blocks[block], REPLAY_BENCH_SAMPLES, &block_thresholds[block],
+                                         &metric_level);
+    block = (block + 1) % REPLAY_BENCH_BLOCKS;
+}
+
+// Every 12-bit value in both halves of a pair, and a block of odd length
+static unsigned replay_pack_check(void)
+{
+    static uint16_t in[4097];
+    static uint16_t out[4097];
+    static uint8_t chunk[CAPTURE_CHUNK_BYTES(CAPTURE_PACKED_BYTES(4097))];
+    unsigned wrong = 0;
+
+    for (uint32_t i = 0; i < 4097; i++)
+    {
+        in[i] = (uint16_t)((i * 2731u) % 4096);
+    }
+    for (uint32_t count = 4096; count <= 4097; count++)
+    {
+        capture_chunk_t read;
+        size_t written = capture_file_write_block(chunk, 77, in, count);
+        wrong += capture_file_read_chunk(chunk, written, &read) != written || read.block != 77 ||
+                 capture_file_unpack(&read, out, 4097) != count || memcmp(in, out, count * sizeof(in[0])) != 0;
+    }
+    return wrong;
+}
+
+int bench_replay(void)
+{
+    unsigned wrong = 0;
+    capture_replay_result_t first;
+    capture_replay_result_t second;
+
+    printf("== replay ==\n");
+
+    replay_bench_capture();
+    wrong += replay_pack_check();
+
+    // What the pipeline makes of the blocks handed to it directly, making
+    // the calls the monitor task makes
+    noise_pipeline_init(&pipeline, &calibration_default_profile, REPLAY_BENCH_VREF_MV, WEIGHTING_A,
+                        REPLAY_BENCH_SPECTRUM_LOG2, REPLAY_BENCH_RATE);
+    for (uint32_t block = 0; block < REPLAY_BENCH_BLOCKS; block++)
+    {
+        capture_replay_trace_t *expected = &check.expected[block];
+        if (block_lost[block])
+        {
+            noise_pipeline_restart(&pipeline);
+        }
+        memset(expected, 0, sizeof(*expected));
+        expected->block = block;
+        expected->state = noise_pipeline_process(&pipeline, blocks[block], REPLAY_BENCH_SAMPLES,
+                                                 &block_thresholds[block], &expected->metric_level);
+        expected->level = pipeline.level.level;
+        expected->fast = pipeline.level.fast;
+        expected->slow = pipeline.level.slow;
+        expected->leq = pipeline.level.leq;
+    }
+
+    // The file must give the same trace, twice over
+    wrong += !capture_replay(&pipeline, file, file_len, replay_bench_expect, &check, &first);
+    wrong += check.seen != REPLAY_BENCH_BLOCKS || check.wrong != 0;
+    wrong += !capture_replay(&pipeline, file, file_len, NULL, NULL, &second);
+    wrong += first.hash != second.hash || first.blocks != REPLAY_BENCH_BLOCKS || first.missing != 0 ||
+             first.gaps != 1 || first.damaged || first.thresholds != (REPLAY_BENCH_BLOCKS + 31) / 64;
+
+    unsigned states[3] = {0};
+    for (uint32_t block = 0; block < REPLAY_BENCH_BLOCKS; block++)
+    {
+        states[check.expected[block].state]++;
+    }
+    wrong += states[ALARM_OK] == 0 || states[ALARM_WARNING] == 0 || states[ALARM_DANGER] == 0;
+
+    // A flipped bit ends the replay at that chunk, and a block left out is
+    // counted as missing and restarts the pipeline as a gap would
+    size_t block_bytes = CAPTURE_CHUNK_BYTES(CAPTURE_PACKED_BYTES(REPLAY_BENCH_SAMPLES));
+    size_t middle = sizeof(capture_file_header_t) + 100 * block_bytes + 40;
+    file[middle] ^= 0x10;
+    capture_replay(&pipeline, file, file_len, NULL, NULL, &second);
+    file[middle] ^= 0x10;
+    wrong += !second.damaged || second.blocks >= REPLAY_BENCH_BLOCKS;
+    size_t after = file_len;
+    file_len = sizeof(capture_file_header_t) + 10 * block_bytes;
+    memmove(file + file_len, file + file_len + block_bytes, after - file_len - block_bytes);
+    file_len = after - block_bytes;
+    capture_replay(&pipeline, file, file_len, NULL, NULL, &second);
+    wrong += second.missing != 1 || second.gaps != 2 || second.blocks != REPLAY_BENCH_BLOCKS - 1 || second.damaged;
+
+    printf("%-24s %u blocks, %u threshold changes, %u gaps, trace %016llx, %u ok %u warning %u danger, "
+           "%u mismatches\n",
+           "replay_check", first.blocks, first.thresholds, first.gaps, (unsigned long long)first.hash, states[ALARM_OK],
+           states[ALARM_WARNING], states[ALARM_DANGER], wrong);
+
+    // A whole replay against the pipeline alone: what reading the file adds
+    double block_ns = bench_time_ns(run_pipeline, NULL);
+    bench_report("noise_pipeline", "block", REPLAY_BENCH_SAMPLES, "sample", block_ns);
+    double replay_ns = bench_time_ns(run_replay, NULL);
+    bench_report("capture_replay", "file", (REPLAY_BENCH_BLOCKS - 1) * REPLAY_BENCH_SAMPLES, "sample", replay_ns);
+    printf("%-24s %.0fx real time\n", "capture_replay",
+           (REPLAY_BENCH_BLOCKS - 1) * (double)REPLAY_BENCH_SAMPLES / REPLAY_BENCH_RATE / (replay_ns / 1e9));
+
+    return wrong == 0;
+}
@@ -0,0 +1,173 @@
+#include "bench.h"
+#include "monitor_state.h"
+#include "seqlatch.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define STRESS_READERS 3
+#define STRESS_PUBLISHES 2000000u
+
+// Every field derives from the version, so a torn copy breaks the invariant
+typedef struct
+{
+    uint32_t version;
+    int32_t fields[7];
+} stress_record_t;
+
+static seqlatch_t latch;
+static stress_record_t copies[2];
+static atomic_bool writer_done;
+
+typedef struct
+{
+    uint32_t reads;
+    uint32_t torn;
+    uint32_t went_back;
+} stress_reader_t;
+
+static void stress_fill(stress_record_t *record, uint32_t version)
+{
+    record->version = version;
+    for (int i = 0; i < 7; i++)
+    {
+        record->fields[i] = (int32_t)(version * (i + 1)) ^ (i & 1 ? -1 : 0);
+    }
+}
+
+static int stress_valid(const stress_record_t *record)
+{
+    stress_record_t expected;
+    stress_fill(&expected, record->version);
+    for (int i = 0; i < 7; i++)
+    {
+        if (record->fields[i] != expected.fields[i])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void *stress_writer(void *arg)
+{
+    stress_record_t record;
+    for (uint32_t v = 1; v <= STRESS_PUBLISHES; v++)
+    {
+        stress_fill(&record, v);
+        seqlatch_publish(&latch, copies, &record, sizeof(record));
+    }
+    atomic_store(&writer_done, 1);
+    return NULL;
+}
+
+static void *stress_reader(void *arg)
+{
+    stress_reader_t *reader = arg;
+    stress_record_t record;
+    uint32_t last = 0;
+
+    while (!atomic_load(&writer_done))
+    {
+        uint32_t version = seqlatch_read(&latch, copies, &record, sizeof(record));
+        reader->reads++;
+        if (!stress_valid(&record) || record.version != version)
+        {
+            reader->torn++;
+        }
+        if (record.version < last)
+        {
+            reader->went_back++;
+        }
+        last = record.version;
+    }
+    return NULL;
+}
+
+static void run_read(void *ctx)
+{
+    stress_record_t record;
+    bench_sink += seqlatch_read(&latch, copies, &record, sizeof(record)) + record.fields[0];
+}
+
+static void run_publish(void *ctx)
+{
+    stress_record_t *record = ctx;
+    record->version++;
+    seqlatch_publish(&latch, copies, record, sizeof(*record));
+}
+
+// Buttons held far past either end: the thresholds stop at the range and
+// keep their gap
+static int bench_threshold_limits(void)
+{
+    monitor_thresholds_t thresholds = {NOISE_THRESHOLD_WARNING, NOISE_THRESHOLD_DANGER, DEFAULT_GAP};
+    int low = MAX_THRESHOLD;
+    int high = MIN_THRESHOLD;
+    int broken = 0;
+    const int steps[][2] = {{-THRESHOLD_STEP, 0}, {0, GAP_STEP}, {THRESHOLD_STEP, 0}, {0, GAP_STEP}, {0, -GAP_STEP}};
+
+    for (unsigned s = 0; s < sizeof(steps) / sizeof(steps[0]); s++)
+    {
+        for (int i = 0; i < 200; i++)
+        {
+            if (steps[s][0])
+            {
+                monitor_thresholds_shift(&thresholds, steps[s][0]);
+            }
+            else
+            {
+                monitor_thresholds_widen(&thresholds, steps[s][1]);
+            }
+            low = thresholds.warning < low ? thresholds.warning : low;
+            high = thresholds.danger > high ? thresholds.danger : high;
+            broken += thresholds.danger != thresholds.warning + thresholds.gap || thresholds.gap < MIN_GAP ||
+                      thresholds.gap > MAX_GAP;
+        }
+    }
+
+    printf("%-24s %-8s %6d..%d deci-dB, %d steps broke the gap\n", "thresholds held", "-", low, high, broken);
+    return low == MIN_THRESHOLD && high == MAX_THRESHOLD && broken == 0 && thresholds.gap == MIN_GAP;
+}
+
+int bench_state(void)
+{
+    stress_record_t record;
+    stress_fill(&record, 0);
+    seqlatch_init(&latch, copies, &record, sizeof(record));
+
+    printf("== shared state ==\n");
+
+    bench_report("seqlatch_read", "32B", 1, "read", bench_time_ns(run_read, NULL));
+    bench_report("seqlatch_publish", "32B", 1, "publish", bench_time_ns(run_publish, &record));
+
+    // One writer against several readers on other cores
+    stress_fill(&record, 0);
+    seqlatch_init(&latch, copies, &record, sizeof(record));
+    atomic_store(&writer_done, 0);
+
+    pthread_t writer;
+    pthread_t readers[STRESS_READERS];
+    stress_reader_t results[STRESS_READERS] = {0};
+
+    for (int i = 0; i < STRESS_READERS; i++)
+    {
+        pthread_create(&readers[i], NULL, stress_reader, &results[i]);
+    }
+    pthread_create(&writer, NULL, stress_writer, NULL);
+
+    pthread_join(writer, NULL);
+    uint32_t reads = 0;
+    uint32_t torn = 0;
+    for (int i = 0; i < STRESS_READERS; i++)
+    {
+        pthread_join(readers[i], NULL);
+        reads += results[i].reads;
+        torn += results[i].torn + results[i].went_back;
+    }
+
+    printf("seqlatch stress: %u publishes, %u reads by %d readers, %u torn or stale\n",
+           STRESS_PUBLISHES, reads, STRESS_READERS, torn);
+    return torn == 0 && bench_threshold_limits();
+}
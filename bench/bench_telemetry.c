@@ -0,0 +1,159 @@
+#include "bench.h"
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TELEMETRY_BENCH_PACKETS 4096
+// Room for the stream plus the garbage put between packets
+#define TELEMETRY_BENCH_STREAM (TELEMETRY_BENCH_PACKETS * (TELEMETRY_PACKET_SIZE + 8))
+
+typedef struct
+{
+    const telemetry_packet_t *sent;
+    uint32_t received;
+    uint32_t wrong;
+} telemetry_check_t;
+
+static telemetry_packet_t sent[TELEMETRY_BENCH_PACKETS];
+static uint8_t stream[TELEMETRY_BENCH_STREAM];
+static bool damaged[TELEMETRY_BENCH_PACKETS];
+static telemetry_decoder_t decoder;
+static uint32_t seed = 7;
+
+static uint32_t telemetry_random(void)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// Payloads of random bytes, seeded with sync pairs now and then so the
+// decoder meets false starts inside packets
+static void telemetry_bench_packets(void)
+{
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_PACKETS; i++)
+    {
+        uint8_t payload[TELEMETRY_PAYLOAD_SIZE];
+        size_t length = 1 + telemetry_random() % TELEMETRY_PAYLOAD_SIZE;
+        for (size_t b = 0; b < length; b++)
+        {
+            payload[b] = (uint8_t)telemetry_random();
+        }
+        if (i % 3 == 0 && length > 2)
+        {
+            size_t at = telemetry_random() % (length - 1);
+            payload[at] = TELEMETRY_SYNC0;
+            payload[at + 1] = TELEMETRY_SYNC1;
+        }
+        telemetry_pack(&sent[i], 1 + telemetry_random() % (TELEMETRY_TYPE_COUNT - 1), payload, length);
+        telemetry_seal(&sent[i], (uint16_t)i);
+    }
+}
+
+static void telemetry_bench_check(const telemetry_packet_t *packet, void *ctx)
+{
+    telemetry_check_t *check = ctx;
+    check->received++;
+    check->wrong += memcmp(packet, &check->sent[packet->seq % TELEMETRY_BENCH_PACKETS], sizeof(*packet)) != 0;
+}
+
+static void telemetry_bench_count(const telemetry_packet_t *packet, void *ctx)
+{
+    (void)packet;
+    (*(uint32_t *)ctx)++;
+}
+
+static void run_pack_seal(void *ctx)
+{
+    static telemetry_packet_t packet;
+    uint32_t *n = ctx;
+    telemetry_pack(&packet, TELEMETRY_LEVELS, sent[*n % TELEMETRY_BENCH_PACKETS].payload, TELEMETRY_PAYLOAD_SIZE);
+    telemetry_seal(&packet, (uint16_t)(*n)++);
+    bench_sink += packet.crc;
+}
+
+static void run_decode(void *ctx)
+{
+    uint32_t packets = 0;
+    telemetry_decoder_init(&decoder);
+    telemetry_decode(&decoder, (const uint8_t *)sent, sizeof(sent), telemetry_bench_count, &packets);
+    bench_sink += packets;
+    (void)ctx;
+}
+
+// Every packet damaged on the way must be missed and counted as lost,
+// every other one must come through exactly as sent
+static int telemetry_bench_damage(void)
+{
+    size_t len = 0;
+    uint32_t expected_lost = 0;
+    uint32_t garbage = 0;
+
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_PACKETS; i++)
+    {
+        uint8_t bytes[TELEMETRY_PACKET_SIZE];
+        size_t count = sizeof(bytes);
+        memcpy(bytes, &sent[i], sizeof(bytes));
+
+        damaged[i] = false;
+        switch (telemetry_random() % 8)
+        {
+        case 0:
+            // A bit flipped anywhere, sync bytes included
+            bytes[telemetry_random() % count] ^= (uint8_t)(1u << telemetry_random() % 8);
+            damaged[i] = true;
+            break;
+        case 1:
+            // A byte lost
+            {
+                size_t at = telemetry_random() % count;
+                memmove(bytes + at, bytes + at + 1, count - at - 1);
+                count--;
+                damaged[i] = true;
+            }
+            break;
+        case 2:
+            // Noise on the line between two packets, sync bytes included
+            for (uint32_t g = telemetry_random() % 8; g > 0; g--)
+            {
+                stream[len++] = g % 3 ? (uint8_t)telemetry_random() : TELEMETRY_SYNC0;
+                garbage++;
+            }
+            break;
+        }
+        memcpy(stream + len, bytes, count);
+        len += count;
+    }
+
+    // The last packet is only known to be lost once another one follows
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_PACKETS - 1; i++)
+    {
+        expected_lost += damaged[i];
+    }
+
+    // Fed in uneven pieces, as reads from a serial port come
+    telemetry_check_t check = {.sent = sent};
+    telemetry_decoder_init(&decoder);
+    for (size_t at = 0, piece = 1; at < len; at += piece, piece = piece % 97 + 1)
+    {
+        telemetry_decode(&decoder, stream + at, piece < len - at ? piece : len - at, telemetry_bench_check, &check);
+    }
+
+    uint32_t intact = TELEMETRY_BENCH_PACKETS - expected_lost - damaged[TELEMETRY_BENCH_PACKETS - 1];
+    printf("%-24s %-8s %6u packets, %u damaged, %u garbage bytes: %u received, %u wrong, %u lost, %u CRC errors\n",
+           "telemetry_resync", "-", TELEMETRY_BENCH_PACKETS, expected_lost, garbage, check.received, check.wrong,
+           decoder.lost, decoder.crc_errors);
+    return check.received == intact && check.wrong == 0 && decoder.lost == expected_lost;
+}
+
+int bench_telemetry(void)
+{
+    printf("== telemetry ==\n");
+    telemetry_bench_packets();
+
+    uint32_t n = 0;
+    bench_report("telemetry_pack_seal", "-", TELEMETRY_PACKET_SIZE, "byte", bench_time_ns(run_pack_seal, &n));
+    bench_report("telemetry_decode", "-", sizeof(sent), "byte", bench_time_ns(run_decode, NULL));
+
+    return telemetry_bench_damage();
+}
@@ -0,0 +1,150 @@
+#include "bench.h"
+#include "trace.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define STRESS_PUTS 4000000u
+#define STRESS_BATCH 6
+
+static trace_ring_t ring;
+static atomic_bool reader_started;
+static atomic_bool writer_done;
+
+typedef struct
+{
+    uint64_t entries;
+    uint32_t lost;
+    uint32_t torn;
+    uint32_t out_of_order;
+} stress_reader_t;
+
+// Entry n carries n as its block, and its time and point derive from it
+static uint32_t stress_time(uint32_t block)
+{
+    return block * 2654435761u;
+}
+
+// Paced so the reader keeps up most of the time and is lapped now and then
+static void *stress_writer(void *arg)
+{
+    while (!atomic_load(&reader_started))
+    {
+    }
+    for (uint32_t n = 0; n < STRESS_PUTS; n++)
+    {
+        for (uint32_t spin = n % 64; spin > 0; spin--)
+        {
+            bench_sink++;
+        }
+        trace_ring_put(&ring, (trace_point_t)(n % TRACE_POINT_COUNT), n, stress_time(n));
+    }
+    atomic_store(&writer_done, 1);
+    return NULL;
+}
+
+// Every entry handed out is whole, and the ones skipped are all counted
+static void stress_check(stress_reader_t *reader, uint32_t cursor, uint32_t lost, const trace_entry_t *entries,
+                         unsigned count)
+{
+    uint32_t expected = cursor + lost;
+    for (unsigned i = 0; i < count; i++, expected++)
+    {
+        const trace_entry_t *entry = &entries[i];
+        if (entry->time_us != stress_time(entry->block) || entry->point != entry->block % TRACE_POINT_COUNT)
+        {
+            reader->torn++;
+        }
+        if (entry->block != expected)
+        {
+            reader->out_of_order++;
+        }
+    }
+    reader->entries += count;
+    reader->lost += lost;
+}
+
+static void *stress_reader(void *arg)
+{
+    stress_reader_t *reader = arg;
+    trace_entry_t entries[STRESS_BATCH];
+    uint32_t cursor = 0;
+    bool last_pass = false;
+
+    atomic_store(&reader_started, 1);
+    while (!last_pass)
+    {
+        last_pass = atomic_load(&writer_done);
+        unsigned count;
+        do
+        {
+            uint32_t before = cursor;
+            uint32_t lost = 0;
+            count = trace_ring_read(&ring, &cursor, entries, STRESS_BATCH, &lost);
+            stress_check(reader, before, lost, entries, count);
+        } while (count > 0);
+    }
+    return NULL;
+}
+
+static void run_put(void *ctx)
+{
+    uint32_t *n = ctx;
+    trace_ring_put(&ring, TRACE_DSP, *n, *n);
+    (*n)++;
+}
+
+static void run_read(void *ctx)
+{
+    uint32_t *cursor = ctx;
+    trace_entry_t entries[STRESS_BATCH];
+    uint32_t lost = 0;
+
+    // Always STRESS_BATCH entries behind the head
+    *cursor = trace_ring_head(&ring) - STRESS_BATCH;
+    bench_sink += trace_ring_read(&ring, cursor, entries, STRESS_BATCH, &lost) + entries[0].time_us;
+}
+
+int bench_trace(void)
+{
+    printf("== trace ==\n");
+
+    uint32_t n = 0;
+    trace_ring_init(&ring);
+    bench_report("trace_ring_put", "-", 1, "entry", bench_time_ns(run_put, &n));
+    uint32_t cursor = 0;
+    bench_report("trace_ring_read", "6 entries", STRESS_BATCH, "entry", bench_time_ns(run_read, &cursor));
+
+    // A reader that falls behind skips to the oldest entry still whole
+    trace_entry_t entries[TRACE_RING_LENGTH];
+    uint32_t lost = 0;
+    trace_ring_init(&ring);
+    for (n = 0; n < 3 * TRACE_RING_LENGTH; n++)
+    {
+        trace_ring_put(&ring, TRACE_LED, n, stress_time(n));
+    }
+    cursor = 0;
+    unsigned count = trace_ring_read(&ring, &cursor, entries, TRACE_RING_LENGTH, &lost);
+    int ok = count == TRACE_RING_LENGTH - 1 && lost == 2 * TRACE_RING_LENGTH + 1 && cursor == n &&
+             entries[0].block == lost && entries[count - 1].block == n - 1;
+
+    // One writer against a reader on another core, the reader sometimes
+    // lapped
+    trace_ring_init(&ring);
+    atomic_store(&reader_started, 0);
+    atomic_store(&writer_done, 0);
+
+    pthread_t writer;
+    pthread_t reader;
+    stress_reader_t result = {0};
+    pthread_create(&reader, NULL, stress_reader, &result);
+    pthread_create(&writer, NULL, stress_writer, NULL);
+    pthread_join(writer, NULL);
+    pthread_join(reader, NULL);
+
+    printf("%-24s %-8s %6llu read, %u overwritten, %u torn, %u out of order\n", "trace_stress", "-",
+           (unsigned long long)result.entries, result.lost, result.torn, result.out_of_order);
+    return ok && result.torn == 0 && result.out_of_order == 0 && result.entries + result.lost == STRESS_PUTS;
+}
@@ -25,23 +25,35 @@
 #define configSTACK_DEPTH_TYPE                  uint16_t
 #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
 
-/* Memory allocation related definitions. */
-#define configSUPPORT_STATIC_ALLOCATION         0
-#define configSUPPORT_DYNAMIC_ALLOCATION        1
-#define configTOTAL_HEAP_SIZE                   50000
+/* Memory allocation related definitions. Everything is allocated
+   statically from include/memory_plan.h; the kernel has no heap. */
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
 #define configUSE_IDLE_HOOK                     0
 #define configUSE_TICK_HOOK                     0
-#define configCHECK_FOR_STACK_OVERFLOW          0
+#define configCHECK_FOR_STACK_OVERFLOW          2
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
-/* Run time and task stats gathering related definitions. */
+/* Run time and task stats gathering related definitions. The profiling
+   build counts task run time in microseconds on the system timer. */
+#ifdef NOISEGUARD_PROFILE
+#define configGENERATE_RUN_TIME_STATS          1
+#define configUSE_TRACE_FACILITY               1
+#define configUSE_STATS_FORMATTING_FUNCTIONS   1
+#ifndef __ASSEMBLER__
+#include "hardware/timer.h"
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()       time_us_32()
+#else
 #define configGENERATE_RUN_TIME_STATS          0
 #define configUSE_TRACE_FACILITY               0
 #define configUSE_STATS_FORMATTING_FUNCTIONS   0
+#endif
 
 /* Software timer related definitions. */
 #define configUSE_TIMERS                        1
@@ -0,0 +1,18 @@
+#ifndef ADC_RR_H
+#define ADC_RR_H
+
+#include <stdint.h>
+
+// The ADC runs in round-robin mode over the joystick X and microphone inputs,
+// starting from the joystick, so the DMA stream is a sequence of frames
+// {joystick, mic}. Each capture half holds whole frames.
+#define ADC_RR_CHANNELS 2
+#define ADC_RR_CONTROL_SLOT 0
+#define ADC_RR_AUDIO_SLOT 1
+
+// Copies the microphone samples of `frames` raw frames into audio and
+// returns the sum of the joystick samples, which the caller decimates to one
+// control reading per block
+uint32_t adc_rr_split(const uint16_t *raw, uint32_t frames, uint16_t *audio);
+
+#endif // ADC_RR_H
@@ -0,0 +1,34 @@
+#ifndef ALARM_H
+#define ALARM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum
+{
+    ALARM_OK,
+    ALARM_WARNING,
+    ALARM_DANGER
+} alarm_state_t;
+
+// One stretch of time above the warning threshold. worst is the highest
+// state reached, threshold the one that state crossed.
+typedef struct
+{
+    bool active;
+    alarm_state_t worst;
+    uint32_t start_ms;
+    uint32_t duration_ms;
+    int peak;
+    int threshold;
+} alarm_episode_t;
+
+alarm_state_t alarm_classify(int level, int warning_threshold, int danger_threshold);
+
+// Feeds the state of one level reading. Returns true when the level has
+// just dropped back below the warning threshold; episode then holds the
+// stretch that ended until the next one starts.
+bool alarm_episode_update(alarm_episode_t *episode, alarm_state_t state, int level, int threshold,
+                          uint32_t now_ms);
+
+#endif // ALARM_H
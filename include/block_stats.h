@@ -0,0 +1,31 @@
+#ifndef BLOCK_STATS_H
+#define BLOCK_STATS_H
+
+#include <stdint.h>
+
+// Statistics of one block of raw ADC samples, all in ADC counts.
+// rms is the AC (DC removed) RMS, rms and crest are Q8 fixed point.
+typedef struct
+{
+    uint16_t mean;
+    uint16_t min;
+    uint16_t max;
+    uint16_t peak;
+    uint32_t rms_q8;
+    uint32_t crest_q8;
+} block_stats_t;
+
+typedef struct
+{
+    float mean;
+    float min;
+    float max;
+    float peak;
+    float rms;
+    float crest;
+} block_stats_ref_t;
+
+void block_stats_compute(const uint16_t *samples, uint32_t count, block_stats_t *stats);
+void block_stats_compute_ref(const uint16_t *samples, uint32_t count, block_stats_ref_t *stats);
+
+#endif // BLOCK_STATS_H
@@ -0,0 +1,54 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdint.h>
+
+// Levels are handled in deci-dB (0.1 dB steps) as plain integers
+#define CALIBRATION_PROFILE_MAGIC 0x4E47434Cu // "NGCL"
+#define CALIBRATION_PROFILE_VERSION 1
+
+// Nominal microphone chain (electret capsule plus the board's amplifier):
+// output in dBV for 1 Pa (94 dB SPL). Replace with a measured profile.
+#define CALIBRATION_DEFAULT_SENSITIVITY_DECIDBV (-200)
+
+// Lowest level reported, silence included
+#define CALIBRATION_FLOOR_DECIDB 0
+
+// Per-device calibration as stored in flash. sensitivity is what the
+// microphone chain puts out for 94 dB SPL, offset a final trim against a
+// reference meter. checksum is a Fletcher-16 of the bytes before it.
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    int16_t sensitivity_decidbv;
+    int16_t offset_decidb;
+    uint16_t checksum;
+} calibration_profile_t;
+
+// Precomputed from a profile: SPL = 20 log10(counts) + spl_offset
+typedef struct
+{
+    const calibration_profile_t *profile;
+    int32_t spl_offset_decidb;
+} calibration_t;
+
+extern const calibration_profile_t calibration_default_profile;
+
+uint16_t calibration_profile_checksum(const calibration_profile_t *profile);
+
+// The stored profile if it is intact, otherwise the default one
+const calibration_profile_t *calibration_profile_select(const calibration_profile_t *stored);
+
+// adc_vref_mv is the ADC full scale, 4096 counts
+void calibration_init(calibration_t *calibration, const calibration_profile_t *profile, uint32_t adc_vref_mv);
+
+// 20 log10 of a Q8 RMS in ADC counts, in deci-dB, and the calibrated SPL
+int32_t calibration_counts_decidb(uint32_t rms_q8);
+int32_t calibration_spl_decidb(const calibration_t *calibration, uint32_t rms_q8);
+
+// Floating point versions, kept to check the integer ones against
+double calibration_counts_db_ref(double rms);
+double calibration_spl_db_ref(const calibration_profile_t *profile, uint32_t adc_vref_mv, double rms);
+
+#endif // CALIBRATION_H
@@ -0,0 +1,30 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "capture_queue.h"
+
+void capture_init(void);
+void capture_start(TaskHandle_t consumer);
+
+// Waits for the next block of SAMPLES decimated microphone samples, valid
+// until the next call. Raw halves skipped by the queue or lapped by the DMA
+// are lost along with the part of a block decimated before them, and the
+// next block returned carries the count in lost; a block itself is always
+// continuous. The joystick reading is refreshed with each raw half and
+// handed to input_joystick_moved.
+bool capture_wait_block(capture_block_t *block, TickType_t timeout);
+
+// Interrupts were off for us microseconds. Called by the one task that
+// turns them off for long, before it turns them back on, so the first
+// half taken after is already counted. The DMA keeps going round the
+// buffer meanwhile, so every whole half that fits in us is counted lost.
+void capture_stalled(uint32_t us);
+
+uint16_t capture_joystick_x(void);
+
+extern capture_queue_t capture_queue;
+
+#endif // CAPTURE_H
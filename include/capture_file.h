@@ -0,0 +1,96 @@
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "calibration.h"
+#include "level_meter.h"
+#include "monitor_state.h"
+
+// Recording of what the noise monitor was given, to run it again on the
+// host: a header saying how the device was set up, then chunks. Block
+// chunks hold the decimated samples of one block as the monitor saw them,
+// 12-bit ADC counts packed two to three bytes (the earlier one in the low
+// bits). Threshold chunks say what the LED thresholds became from a block
+// on, which is all the input events change as far as the levels and the
+// alarm go. Gap chunks say the device lost samples right before a block
+// and started its processing again there. Everything is little endian.
+#define CAPTURE_FILE_MAGIC 0x5043474Eu // "NGCP"
+#define CAPTURE_FILE_VERSION 1
+#define CAPTURE_FILE_FIRMWARE 16
+
+// crc is a CRC-16/CCITT-FALSE of the bytes before it
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t sample_rate;
+    uint16_t block_samples;
+    uint16_t adc_vref_mv;
+    calibration_profile_t calibration;
+    uint8_t weighting;
+    uint8_t spectrum_log2;
+    char firmware[CAPTURE_FILE_FIRMWARE];
+    uint16_t crc;
+} capture_file_header_t;
+
+typedef enum
+{
+    CAPTURE_CHUNK_BLOCK = 1,  // packed samples of block number block
+    CAPTURE_CHUNK_THRESHOLDS, // capture_file_thresholds_t, from block on
+    CAPTURE_CHUNK_GAP         // uint32_t samples lost right before block
+} capture_chunk_type_t;
+
+// Chunks are this header, length bytes of payload and a CRC-16 of both
+#define CAPTURE_CHUNK_HEADER 8
+#define CAPTURE_CHUNK_CRC 2
+#define CAPTURE_CHUNK_BYTES(length) (CAPTURE_CHUNK_HEADER + (length) + CAPTURE_CHUNK_CRC)
+#define CAPTURE_PACKED_BYTES(samples) (((uint32_t)(samples) * 3 + 1) / 2)
+
+typedef struct
+{
+    int16_t warning;
+    int16_t danger;
+    int16_t gap;
+    uint8_t metric;
+    uint8_t reserved;
+} capture_file_thresholds_t;
+
+// A chunk as read back; payload points into the bytes it was read from
+typedef struct
+{
+    capture_chunk_type_t type;
+    uint32_t block;
+    uint32_t length;
+    const uint8_t *payload;
+} capture_chunk_t;
+
+// firmware is cut to fit, the rest of the field is zero
+void capture_file_header_init(capture_file_header_t *header, uint32_t sample_rate, uint32_t block_samples,
+                              uint32_t adc_vref_mv, const calibration_profile_t *calibration,
+                              weighting_curve_t weighting, unsigned spectrum_log2, const char *firmware);
+
+// False for another format or version, or a damaged header
+bool capture_file_header_check(const capture_file_header_t *header);
+
+// Chunk writers; out has room for CAPTURE_CHUNK_BYTES of the payload.
+// Return the bytes written.
+size_t capture_file_write_block(uint8_t *out, uint32_t block, const uint16_t *samples, uint32_t count);
+size_t capture_file_write_thresholds(uint8_t *out, uint32_t block, const monitor_thresholds_t *thresholds);
+size_t capture_file_write_gap(uint8_t *out, uint32_t block, uint32_t lost);
+
+// The chunk at the start of bytes and the bytes it takes, or 0 when they
+// end before it does or it is damaged
+size_t capture_file_read_chunk(const uint8_t *bytes, size_t len, capture_chunk_t *chunk);
+
+// Samples of a block chunk, at most max of them; returns how many
+uint32_t capture_file_unpack(const capture_chunk_t *chunk, uint16_t *samples, uint32_t max);
+
+// False for a chunk of the wrong type or size
+bool capture_file_thresholds(const capture_chunk_t *chunk, monitor_thresholds_t *thresholds);
+bool capture_file_gap(const capture_chunk_t *chunk, uint32_t *lost);
+
+#endif // CAPTURE_FILE_H
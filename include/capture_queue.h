@@ -0,0 +1,42 @@
+#ifndef CAPTURE_QUEUE_H
+#define CAPTURE_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Block handoff between the ping-pong DMA (producer, interrupt context) and
+// the DSP task (consumer). Block n always lives in half n % 2 of the buffer.
+// The producer only writes `produced` and the consumer only writes the
+// remaining counters, so no lock is needed on a single core.
+typedef struct
+{
+    uint16_t *halves[2];
+    uint32_t block_len;
+    volatile uint32_t produced;
+    uint32_t consumed;
+    uint32_t dropped;
+    uint32_t overruns;
+} capture_queue_t;
+
+// time_us is when the block's last sample reached RAM, on the 1 MHz timer.
+// The queue does not keep time; capture_wait_block fills it in. lost is how
+// many samples went missing right before the block, in the units of len,
+// so the stream does not follow on from the previous block when it is not 0.
+typedef struct
+{
+    const uint16_t *samples;
+    uint32_t len;
+    uint32_t seq;
+    uint32_t time_us;
+    uint32_t lost;
+} capture_block_t;
+
+void capture_queue_init(capture_queue_t *queue, uint16_t *buffer, uint32_t block_len);
+
+void capture_queue_complete(capture_queue_t *queue, unsigned half);
+void capture_queue_on_irq(capture_queue_t *queue, unsigned pending_mask, unsigned filling_half);
+
+bool capture_queue_acquire(capture_queue_t *queue, capture_block_t *block);
+bool capture_queue_release(capture_queue_t *queue, const capture_block_t *block);
+
+#endif // CAPTURE_QUEUE_H
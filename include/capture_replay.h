@@ -0,0 +1,50 @@
+#ifndef CAPTURE_REPLAY_H
+#define CAPTURE_REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alarm.h"
+#include "noise_pipeline.h"
+
+// Runs a capture file through the noise pipeline as fast as it goes, the
+// thresholds changing at the blocks the file says. Until the first
+// threshold chunk the monitor's defaults apply. At a gap chunk or a hole
+// in the block numbers the pipeline starts again, as the monitor's does
+// after lost samples. Every block adds its
+// levels, metric level and alarm state to a 64-bit FNV-1a hash, so two
+// replays of one file compare with a single number.
+#define CAPTURE_REPLAY_MAX_SAMPLES 4096
+
+typedef struct
+{
+    uint32_t block;
+    int level;
+    int fast;
+    int slow;
+    int leq;
+    int metric_level;
+    alarm_state_t state;
+} capture_replay_trace_t;
+
+typedef void (*capture_replay_fn)(const capture_replay_trace_t *trace, void *ctx);
+
+typedef struct
+{
+    uint32_t blocks;
+    uint32_t missing;    // block numbers the file skips
+    uint32_t gaps;       // places the pipeline started again
+    uint32_t thresholds; // threshold chunks applied
+    uint32_t unknown;    // chunks of types this version does not know
+    bool damaged;        // stopped at a chunk that does not check out
+    uint64_t hash;
+} capture_replay_result_t;
+
+// bytes is the whole file. trace may be NULL. False when the header is not
+// one this version reads or there are no filters for its sample rate; a
+// damaged chunk ends the replay but still returns true.
+bool capture_replay(noise_pipeline_t *pipeline, const uint8_t *bytes, size_t len, capture_replay_fn trace,
+                    void *ctx, capture_replay_result_t *result);
+
+#endif // CAPTURE_REPLAY_H
@@ -0,0 +1,105 @@
+#ifndef CLIP_RING_H
+#define CLIP_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// The last few seconds of decimated audio, compressed in RAM so the sound
+// around a danger crossing can be sent off afterwards. Blocks are encoded
+// straight from the capture block into their slot. A trigger holds the
+// blocks from pre_blocks before it to post_blocks after it, and the reader
+// releases them one at a time as they are sent; meanwhile recording goes
+// on in the free slots and only stops when it catches up with the reader.
+// One task records and triggers, another reads.
+
+typedef enum
+{
+    CLIP_CODEC_ULAW = 1, // G.711 mu-law, 8 bits a sample
+    CLIP_CODEC_ADPCM     // IMA ADPCM, 4 bits a sample
+} clip_codec_t;
+
+// An ADPCM block starts with the predictor (int16, little endian) and the
+// step index, so each block decodes on its own; samples follow two to a
+// byte, the earlier one in the low nibble
+#define CLIP_ADPCM_HEADER 4
+#define CLIP_BLOCK_BYTES(codec, samples) \
+    ((codec) == CLIP_CODEC_ULAW ? (uint32_t)(samples) : CLIP_ADPCM_HEADER + (uint32_t)(samples) / 2)
+
+typedef struct
+{
+    clip_codec_t codec;
+    int32_t predictor;
+    int32_t index;
+} clip_encoder_t;
+
+void clip_encoder_init(clip_encoder_t *encoder, clip_codec_t codec);
+
+// Encodes count ADC counts (count even) as one block. The ADPCM state runs
+// on from block to block. Returns the bytes written, CLIP_BLOCK_BYTES.
+uint32_t clip_encode(clip_encoder_t *encoder, const uint16_t *samples, uint32_t count, uint8_t *out);
+
+// One block back to signed 16-bit PCM, 16 per ADC count around mid-scale
+void clip_decode(clip_codec_t codec, const uint8_t *in, uint32_t count, int16_t *pcm);
+
+// A held block as the reader sees it. index counts from the start of the
+// clip, trigger is the index of the block the crossing happened in.
+typedef struct
+{
+    const uint8_t *data;
+    uint32_t bytes;
+    uint32_t clip;
+    uint32_t index;
+    uint32_t count;
+    uint32_t trigger;
+} clip_block_t;
+
+typedef struct
+{
+    uint8_t *storage;
+    uint32_t blocks;
+    uint32_t block_samples;
+    uint32_t block_bytes;
+    uint32_t pre_blocks;
+    uint32_t post_blocks;
+    clip_encoder_t encoder;
+
+    // Blocks are numbered as they are recorded; block n is in slot
+    // n % blocks. first is the oldest that follows on without a gap.
+    atomic_uint recorded;
+    atomic_uint read;
+    atomic_bool held;
+    uint32_t first;
+
+    // The held clip, set before held
+    uint32_t start;
+    uint32_t trigger;
+    uint32_t end;
+    uint32_t clips;
+
+    uint32_t dropped; // blocks not recorded because the reader was behind
+    uint32_t missed;  // triggers while a clip was held
+} clip_ring_t;
+
+// storage is blocks * CLIP_BLOCK_BYTES(codec, block_samples) bytes, and
+// pre_blocks + post_blocks at most blocks
+void clip_ring_init(clip_ring_t *ring, uint8_t *storage, uint32_t blocks, clip_codec_t codec,
+                    uint32_t block_samples, uint32_t pre_blocks, uint32_t post_blocks);
+
+// Encodes the next block; false (and counted in dropped) when its slot is
+// still waiting to be read
+bool clip_ring_record(clip_ring_t *ring, const uint16_t *samples);
+
+// The next block does not follow on from the last one recorded, so no clip
+// reaches back across it
+void clip_ring_gap(clip_ring_t *ring);
+
+// Holds a clip around the block recorded last, which counts in pre_blocks.
+// False when one is already held.
+bool clip_ring_trigger(clip_ring_t *ring);
+
+// The next held block that has been recorded, valid until released
+bool clip_ring_peek(const clip_ring_t *ring, clip_block_t *block);
+void clip_ring_release(clip_ring_t *ring);
+
+#endif // CLIP_RING_H
@@ -0,0 +1,12 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC16_INIT 0xFFFF
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021, no reflection), continued from crc
+uint16_t crc16_update(uint16_t crc, const void *data, size_t len);
+
+#endif // CRC16_H
@@ -0,0 +1,55 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Debounce and auto-repeat for one button, driven by the times of its
+// edges. An edge only restarts the settle timer; the line is sampled once
+// it has been quiet for settle_ms, so any amount of contact bounce, and
+// edges lost on the way, end in one clean press or release.
+
+// debounce_wait_ms when only an edge can make something happen
+#define DEBOUNCE_IDLE UINT32_MAX
+
+typedef enum
+{
+    DEBOUNCE_NONE,
+    DEBOUNCE_PRESS,
+    DEBOUNCE_RELEASE,
+    DEBOUNCE_REPEAT // still held; repeats counts them from the press to the next press
+} debounce_event_t;
+
+typedef struct
+{
+    uint32_t settle_ms;
+    uint32_t hold_ms;       // first repeat this long after the press, 0 for none
+    uint32_t repeat_ms;     // then this far apart, 0 for only the one
+    uint32_t repeat_min_ms; // each gap a quarter shorter, down to this
+} debounce_config_t;
+
+typedef struct
+{
+    const debounce_config_t *config;
+    bool pressed;
+    bool settling;
+    bool repeating;
+    uint32_t edge_ms;
+    uint32_t repeat_at_ms;
+    uint32_t interval_ms;
+    uint32_t repeats;
+} debounce_t;
+
+void debounce_init(debounce_t *button, const debounce_config_t *config, bool pressed);
+
+// The line changed, either way
+void debounce_edge(debounce_t *button, uint32_t now_ms);
+
+// Event due by now_ms, given the level the line reads now (true when
+// pressed). At most one per call.
+debounce_event_t debounce_update(debounce_t *button, bool level, uint32_t now_ms);
+
+// How long from now_ms until debounce_update has something due
+uint32_t debounce_wait_ms(const debounce_t *button, uint32_t now_ms);
+
+#endif // DEBOUNCE_H
@@ -0,0 +1,43 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_tables.h"
+
+// Raw and decimated samples are both 12-bit ADC counts around mid-scale
+#define DECIMATOR_MIDSCALE 2048
+
+// Streaming decimator from the raw ADC rate to an audio rate: a CIC of
+// order DSP_CIC_ORDER followed by a compensating FIR that decimates by 2.
+// The CIC runs on wrapping 32-bit integers, its output is Q4 counts.
+typedef struct
+{
+    const dsp_decimator_config_t *config;
+    uint32_t integrators[DSP_CIC_ORDER];
+    uint32_t combs[DSP_CIC_ORDER];
+    unsigned cic_phase;
+    unsigned cic_shift;
+
+    // CIC outputs, written twice so the FIR window is always contiguous
+    int16_t history[2 * DSP_DECIMATOR_TAPS];
+    unsigned head;
+    unsigned fir_phase;
+} decimator_t;
+
+// Fails when no filters were generated for audio_rate or when they do not
+// decimate by `decimation`
+bool decimator_init(decimator_t *decimator, uint32_t audio_rate, unsigned decimation);
+unsigned decimator_ratio(const decimator_t *decimator);
+
+// Starts over from rest, as after init, for raw samples that do not follow
+// on from the ones already fed
+void decimator_reset(decimator_t *decimator);
+
+// Feeds `count` raw samples and writes the audio samples they complete,
+// count / decimator_ratio() of them when count is a multiple of it.
+// Returns how many were written.
+uint32_t decimator_process(decimator_t *decimator, const uint16_t *raw, uint32_t count, uint16_t *audio);
+
+#endif // DECIMATOR_H
@@ -0,0 +1,68 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "profile.h"
+
+// Timed stages of the pipeline. The first five run in the monitor task
+// once per block, draw in the display task once per frame, and bus is how
+// long each frame holds the I2C bus, from the DMA start to its interrupt.
+typedef enum
+{
+    PROFILE_CAPTURE,  // deinterleave and decimate one raw half
+    PROFILE_METER,    // level_meter_process
+    PROFILE_RMS,      // block_stats_compute
+    PROFILE_SPECTRUM, // spectrum_compute and the octave sums
+    PROFILE_LEVELS,   // calibration, history, alarm, clip ring and telemetry
+    PROFILE_DRAW,     // render and pack a frame
+    PROFILE_BUS,      // I2C transfer of a frame
+    PROFILE_STAGE_COUNT
+} profile_stage_id_t;
+
+// Built with -DNOISEGUARD_PROFILE=ON, the stages are timed and the kernel
+// keeps per-task run time on the 1 MHz timer. Otherwise the macros compile
+// to nothing.
+#ifdef NOISEGUARD_PROFILE
+
+#ifndef PROFILE_CLOCK_US
+#include "hardware/timer.h"
+#define PROFILE_CLOCK_US() time_us_32()
+#endif
+
+#define PROFILE_START(start) uint32_t start = PROFILE_CLOCK_US()
+#define PROFILE_STOP(stage, start) profile_stage_record(&profile_stages[stage], PROFILE_CLOCK_US() - (start))
+
+#define DIAGNOSTICS_MAX_TASKS 10
+
+extern profile_stage_t profile_stages[PROFILE_STAGE_COUNT];
+extern const char *const profile_stage_names[PROFILE_STAGE_COUNT];
+
+// Share of the CPU each task had since the previous update of the same
+// record, so every reader keeps its own
+typedef struct
+{
+    TaskStatus_t status[DIAGNOSTICS_MAX_TASKS];
+    TaskHandle_t handles[DIAGNOSTICS_MAX_TASKS];
+    uint32_t run_time[DIAGNOSTICS_MAX_TASKS];
+    uint32_t total;
+    unsigned count;
+
+    // Results, in the order the kernel listed the tasks
+    const char *names[DIAGNOSTICS_MAX_TASKS];
+    uint16_t permille[DIAGNOSTICS_MAX_TASKS];
+} diagnostics_load_t;
+
+unsigned diagnostics_update_load(diagnostics_load_t *load);
+
+#else
+
+#define PROFILE_START(start)
+#define PROFILE_STOP(stage, start)
+
+#endif
+
+void diagnostics_init(void);
+
+#endif // DIAGNOSTICS_H
@@ -5,11 +5,50 @@
 #include "task.h"
 #include "semphr.h"
 
-#define DISPLAY_UPDATE_MS 500
+#define DISPLAY_MAX_FPS 20
+#define DISPLAY_MIN_FRAME_MS (1000 / DISPLAY_MAX_FPS)
+#define DISPLAY_MAX_AREAS 16
+
+// The history graph moves by the panel's own scroll, so a new second
+// costs one column on the bus. 0 redraws it in the frame and diffs.
+#ifndef DISPLAY_HW_SCROLL
+#define DISPLAY_HW_SCROLL 1
+#endif
+
+// What changed on screen, sent to the display task as notification bits
+#define DISPLAY_EVENT_LEVEL (1u << 0)
+#define DISPLAY_EVENT_THRESHOLDS (1u << 1)
+#define DISPLAY_EVENT_ALL (DISPLAY_EVENT_LEVEL | DISPLAY_EVENT_THRESHOLDS)
+// Switch to the next page (sent by the joystick button)
+#define DISPLAY_EVENT_NEXT_PAGE (1u << 2)
+
+typedef enum
+{
+    DISPLAY_PAGE_LEVEL,
+    DISPLAY_PAGE_HISTORY,
+    DISPLAY_PAGE_METERS,
+    DISPLAY_PAGE_OCTAVES,
+    DISPLAY_PAGE_THIRD_OCTAVES,
+#ifdef NOISEGUARD_PROFILE
+    DISPLAY_PAGE_PROFILE,
+    DISPLAY_PAGE_LOAD,
+#endif
+    DISPLAY_PAGE_COUNT
+} display_page_t;
+
+// Band bars start at 20 dB SPL and grow one pixel per 1.5 dB, up to the
+// area below the title (92 dB)
+#define DISPLAY_BAR_FLOOR_DECIDB 200
+#define DISPLAY_BAR_DECIDB_PER_PIXEL 15
+#define DISPLAY_BAR_HEIGHT 48
 
 void vTaskUpdateDisplay(void *pvParameters);
+void display_notify(uint32_t events);
 
 extern SemaphoreHandle_t displayMutex;
 extern uint8_t display_buffer[];
+extern uint32_t display_frame_bytes;
+extern uint32_t display_frames;
+extern TaskHandle_t display_task;
 
 #endif // DISPLAY_H
\ No newline at end of file
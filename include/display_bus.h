@@ -0,0 +1,11 @@
+#ifndef DISPLAY_BUS_H
+#define DISPLAY_BUS_H
+
+#include "ssd1306_stream.h"
+
+// Task notification slot the display task blocks on while a frame is in flight
+#define DISPLAY_BUS_NOTIFY_INDEX 1
+
+ssd1306_bus_t *display_bus_init(void);
+
+#endif // DISPLAY_BUS_H
@@ -0,0 +1,128 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EVENT_LOG_MAGIC 0x4E474556u // "NGEV"
+#define EVENT_LOG_VERSION 1
+
+// NOR flash geometry: erase a sector at a time, program whole pages, and
+// programming can only clear bits
+#define EVENT_LOG_SECTOR_SIZE 4096
+#define EVENT_LOG_PAGE_SIZE 256
+#define EVENT_LOG_RECORD_SIZE 16
+
+// Slot 0 of every sector is its header, the rest are records
+#define EVENT_LOG_SLOTS (EVENT_LOG_SECTOR_SIZE / EVENT_LOG_RECORD_SIZE)
+#define EVENT_LOG_RECORDS_PER_SECTOR (EVENT_LOG_SLOTS - 1)
+#define EVENT_LOG_SLOTS_PER_PAGE (EVENT_LOG_PAGE_SIZE / EVENT_LOG_RECORD_SIZE)
+
+// Records waiting in RAM for the flush, a power of two
+#define EVENT_LOG_QUEUE 16
+
+// Free slots left in the active sector at which event_log_prepare erases
+// the next one: room for two full queues
+#define EVENT_LOG_PREPARE_SLOTS (2 * EVENT_LOG_QUEUE)
+
+// One excursion above the warning threshold. Times are seconds since the
+// boot numbered `boot`, levels deci-dB SPL. state is the worst alarm_state_t
+// reached, threshold the one it crossed and metric the monitor_metric_t
+// the LED followed. crc covers the bytes before it.
+typedef struct
+{
+    uint32_t start_s;
+    uint16_t boot;
+    uint16_t duration_s;
+    int16_t peak_decidb;
+    int16_t threshold_decidb;
+    uint8_t state;
+    uint8_t metric;
+    uint16_t crc;
+} event_record_t;
+
+// first_seq numbers the sector's first record, the others follow in slot
+// order. erase_count is carried from header to header of the same sector.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t first_seq;
+    uint32_t erase_count;
+    uint16_t version;
+    uint16_t crc;
+} event_sector_header_t;
+
+// Reserved flash region. base is where it reads through the memory map,
+// offsets passed to erase and program are relative to it.
+typedef struct
+{
+    const uint8_t *base;
+    uint32_t sectors;
+    void (*erase)(void *ctx, uint32_t offset);
+    void (*program)(void *ctx, uint32_t offset, const uint8_t *page);
+    void *ctx;
+} event_log_flash_t;
+
+// Ring of sectors written in order: when the active one is full the next
+// one, which holds the oldest records, is erased and takes over, so every
+// sector is erased once per trip round the region. The erase can be done
+// ahead of time by event_log_prepare. Records are appended to a RAM queue
+// by one task and programmed a page at a time by another, which is the
+// only one that may prepare, flush or read back.
+typedef struct
+{
+    event_log_flash_t flash;
+    uint16_t boot;
+
+    // Sector being written, its first_seq and the next free slot in it;
+    // slot == EVENT_LOG_SLOTS when a new sector has to be opened
+    uint32_t active;
+    uint32_t first_seq;
+    uint32_t slot;
+
+    // The sector after the active one has been erased ahead of time, and
+    // the erase count its header had
+    bool spare;
+    uint32_t spare_erase_count;
+
+    // Image of the page holding `slot`, reprogrammed with each batch
+    uint8_t page[EVENT_LOG_PAGE_SIZE];
+
+    event_record_t queue[EVENT_LOG_QUEUE];
+    atomic_uint queued;
+    atomic_uint flushed;
+    uint32_t dropped;
+} event_log_t;
+
+// Finds the newest sector and its first free slot with a binary search, so
+// it reads a few headers and slots however full the log is. Torn records
+// left by a power cut are skipped, half erased sectors ignored. boot is one
+// more than the boot of the last record.
+void event_log_mount(event_log_t *log, const event_log_flash_t *flash);
+
+// Queues a record without touching flash; false (and counted in dropped)
+// when the queue is full. boot and crc are filled in.
+bool event_log_append(event_log_t *log, const event_record_t *record);
+
+// Programs what is queued, erasing the next sector when one fills up and
+// event_log_prepare has not. Returns the number of records written.
+uint32_t event_log_flush(event_log_t *log);
+
+// Erases the next sector once the active one is down to
+// EVENT_LOG_PREPARE_SLOTS free slots, so the flushes that fill it only
+// program. Its records are dropped that much earlier. True when it erased.
+bool event_log_prepare(event_log_t *log);
+
+uint32_t event_log_pending(const event_log_t *log);
+
+// Records in flash are numbered from 0 in append order. next_seq is the
+// number the next flushed record will get, oldest_seq the first one that
+// may still be there.
+uint32_t event_log_next_seq(const event_log_t *log);
+uint32_t event_log_oldest_seq(const event_log_t *log);
+
+// False when seq has been overwritten, was never written or is torn
+bool event_log_read(const event_log_t *log, uint32_t seq, event_record_t *record);
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,32 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "event_log.h"
+
+// Time the store task waits after the first queued record before it
+// programs, so records close together share a page write
+#define EVENTS_BATCH_MS 2000
+
+// How often the store task looks for a quiet moment to erase the next
+// sector ahead of the flush that needs it
+#define EVENTS_PREPARE_MS 1000
+
+// Threshold crossings kept in the event log region of flash. The queue has
+// a single producer, so only the monitor task records; the store task is
+// the only one that touches flash.
+extern event_log_t event_log;
+extern TaskHandle_t events_task;
+
+// Mounts the log, before the scheduler starts
+void events_init(void);
+
+// Queues an event without blocking, false when the queue is full. Monitor
+// task only.
+bool events_record(const event_record_t *record);
+
+void vTaskStoreEvents(void *pvParameters);
+
+#endif // EVENTS_H
@@ -0,0 +1,19 @@
+#ifndef FFT_Q15_H
+#define FFT_Q15_H
+
+#include <stdint.h>
+
+#include "dsp_tables.h"
+
+// In-place radix-2 decimation-in-time FFT over interleaved {re, im} Q15
+// pairs already in bit-reversed order (see fft_q15_load_real). A stage is
+// halved only when its input could overflow; the number of halved stages
+// is returned, the true spectrum is data * 2^returned.
+unsigned fft_q15(int16_t *data, unsigned log2n);
+
+// Removes `mean`, scales by 2^shift, applies the Hann window and stores the
+// real samples in bit-reversed order, ready for fft_q15
+void fft_q15_load_real(int16_t *data, const uint16_t *samples, unsigned log2n,
+                       uint16_t mean, unsigned shift);
+
+#endif // FFT_Q15_H
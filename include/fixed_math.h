@@ -0,0 +1,11 @@
+#ifndef FIXED_MATH_H
+#define FIXED_MATH_H
+
+#include <stdint.h>
+
+uint32_t isqrt64(uint64_t value);
+
+// log2(value) in Q16 from a table and linear interpolation, 0 for 0
+uint32_t log2_q16(uint32_t value);
+
+#endif // FIXED_MATH_H
@@ -0,0 +1,121 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "calibration.h"
+
+// How far back each resolution reaches: two minutes of seconds, two hours
+// of minutes and two days of hours
+#define HISTORY_SECONDS 120
+#define HISTORY_MINUTES 120
+#define HISTORY_HOURS 48
+
+// Percentiles come from 1 dB buckets between 20 and 120 dB SPL, levels
+// outside are counted in the first or last bucket
+#define HISTORY_BUCKET_FLOOR_DECIDB 200
+#define HISTORY_BUCKET_DECIDB 10
+#define HISTORY_BUCKETS 100
+
+// Everything is static, checked against this at compile time
+#define HISTORY_RAM_BUDGET 6144
+
+typedef enum
+{
+    HISTORY_SECOND,
+    HISTORY_MINUTE,
+    HISTORY_HOUR,
+    HISTORY_RESOLUTION_COUNT
+} history_resolution_t;
+
+// One closed period, all in deci-dB SPL. min, max, L10 and L90 are over the
+// Fast level sampled once per block, Leq over the weighted signal itself.
+// gaps counts the places where capture lost samples inside the period,
+// which the levels leave out.
+typedef struct
+{
+    int16_t min;
+    int16_t max;
+    int16_t leq;
+    int16_t l10;
+    int16_t l90;
+    uint16_t gaps;
+} history_record_t;
+
+// Period being filled. energy is the sum of the block mean squares in Q8
+// counts^2, blocks all have the same length.
+typedef struct
+{
+    uint64_t energy;
+    uint32_t blocks;
+    uint32_t periods;
+    uint32_t gaps;
+    int16_t min;
+    int16_t max;
+    uint32_t buckets[HISTORY_BUCKETS];
+} history_accumulator_t;
+
+// Closed periods, newest at head - 1. The slot at head is the one being
+// written, so one slot more than the depth is kept and readers never see
+// a record half written.
+typedef struct
+{
+    history_record_t *records;
+    uint32_t capacity;
+    atomic_uint head;
+} history_ring_t;
+
+// Round robin store of the noise level at three resolutions. Blocks go
+// into the second being filled; each closed second is folded into the
+// minute and each closed minute into the hour, so every insert is O(1)
+// and a roll-up costs one pass over the buckets. One task adds, any task
+// may query.
+typedef struct
+{
+    const calibration_t *calibration;
+    uint32_t sample_rate;
+    uint32_t block_samples;
+    uint32_t samples;
+
+    history_accumulator_t pending[HISTORY_RESOLUTION_COUNT];
+    history_ring_t rings[HISTORY_RESOLUTION_COUNT];
+    history_record_t seconds[HISTORY_SECONDS + 1];
+    history_record_t minutes[HISTORY_MINUTES + 1];
+    history_record_t hours[HISTORY_HOURS + 1];
+} history_t;
+
+void history_init(history_t *history, const calibration_t *calibration, uint32_t block_samples,
+                  uint32_t sample_rate);
+
+// fast_q8 is the Fast level at the end of the block, block_q8 the weighted
+// RMS over the block, both Q8 counts like level_meter_t
+void history_add(history_t *history, uint32_t fast_q8, uint32_t block_q8);
+
+// lost samples went missing before the next block. They count in the
+// period being filled as a gap and move its clock on, by at most the rest
+// of the second.
+void history_gap(history_t *history, uint32_t lost);
+
+// Number of periods closed since start; period n covers [n, n + 1)
+// seconds, minutes or hours
+uint32_t history_closed(const history_t *history, history_resolution_t resolution);
+
+// Records that can be read back, at most the depth of the resolution
+uint32_t history_available(const history_t *history, history_resolution_t resolution);
+
+// age 0 is the last closed period. False when it is not available.
+bool history_get(const history_t *history, history_resolution_t resolution, uint32_t age,
+                 history_record_t *record);
+
+// The same by period number, for a reader that keeps its own place. False
+// when the period has not closed or is no longer kept.
+bool history_get_period(const history_t *history, history_resolution_t resolution, uint32_t period,
+                        history_record_t *record);
+
+// Level in deci-dB exceeded by `percent` of the counts, interpolated within
+// the bucket
+int16_t history_percentile(const uint32_t *buckets, uint32_t total, unsigned percent);
+
+#endif // HISTORY_H
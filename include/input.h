@@ -4,6 +4,47 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+#include "debounce.h"
+
+// Buttons read low while held. Their edge interrupts queue the time of
+// each change and the input task sleeps on that queue, waking only for an
+// edge or a settle or repeat deadline.
+#define INPUT_SETTLE_MS 20
+
+// Holding the joystick button this long switches the alarm metric, a
+// shorter press pages the display
+#define INPUT_LONG_PRESS_MS 1000
+
+// Held threshold buttons and joystick repeat, faster the longer they are held
+#define INPUT_REPEAT_HOLD_MS 400
+#define INPUT_REPEAT_MS 200
+#define INPUT_REPEAT_MIN_MS 40
+
+// Joystick X beyond this many counts off centre acts as a held button
+#define INPUT_JOYSTICK_CENTER 2048
+#define INPUT_JOYSTICK_DEADZONE 500
+
+// An edge still queued this long after it happened, or lost to a full
+// queue, is a missed deadline
+#define INPUT_DEADLINE_MS 50
+
+typedef enum
+{
+    INPUT_BUTTON_A,       // thresholds down
+    INPUT_BUTTON_B,       // thresholds up
+    INPUT_BUTTON_SW,      // joystick button
+    INPUT_JOYSTICK_LEFT,  // narrower gap
+    INPUT_JOYSTICK_RIGHT, // wider gap
+    INPUT_BUTTON_COUNT
+} input_button_t;
+
+void input_init(void);
+
+// Called with each new joystick reading; queues an edge when X crosses
+// into or out of the dead zone, counting the ones the queue has no room
+// for. Monitor task only, as capture hands it each reading.
+void input_joystick_moved(uint16_t x);
+
 void vTaskHandleInput(void *pvParameters);
 
-#endif // INPUT_H
\ No newline at end of file
+#endif // INPUT_H
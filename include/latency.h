@@ -0,0 +1,54 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+#include "capture_queue.h"
+#include "profile.h"
+#include "trace.h"
+
+// How long sound takes to reach the LED and the screen, from the moment the
+// last sample of its block is in RAM (capture_block_t.time_us). Histograms
+// use the power of two bins of profile_stats_t.
+typedef enum
+{
+    LATENCY_DSP,   // capture to levels computed
+    LATENCY_LED,   // capture to LED set
+    LATENCY_FRAME, // capture to the first frame showing the block sent
+    LATENCY_PATH_COUNT
+} latency_path_t;
+
+// Tasks with a deadline, and what counts as missing it
+typedef enum
+{
+    LATENCY_TASK_MONITOR, // LED not set within one block of capture
+    LATENCY_TASK_DISPLAY, // frame not drawn and sent within DISPLAY_MIN_FRAME_MS
+    LATENCY_TASK_INPUT,   // edge handled INPUT_DEADLINE_MS late, or dropped
+    LATENCY_TASK_COUNT
+} latency_task_t;
+
+// The monitor task writes the pipeline ring, the display DMA interrupt the
+// frame ring, so each ring has a single writer. Same for the histograms,
+// and for the miss counters, each kept by the task it belongs to.
+extern trace_ring_t latency_pipeline_trace;
+extern trace_ring_t latency_frame_trace;
+extern profile_stage_t latency_paths[LATENCY_PATH_COUNT];
+extern volatile uint32_t latency_misses[LATENCY_TASK_COUNT];
+
+void latency_init(void);
+
+// Monitor task, as the block reaches TRACE_CAPTURE, TRACE_DSP and TRACE_LED
+void latency_block_point(trace_point_t point, const capture_block_t *block);
+
+// Monitor task, along with the level of the block for the display
+void latency_block_published(const capture_block_t *block);
+
+// Display task, before the frame is drawn and once its bytes are ready to
+// go on an idle bus
+void latency_frame_begin(void);
+void latency_frame_submit(void);
+
+// Display DMA interrupt, when the frame has left
+void latency_frame_sent(void);
+
+#endif // LATENCY_H
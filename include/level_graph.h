@@ -0,0 +1,40 @@
+#ifndef LEVEL_GRAPH_H
+#define LEVEL_GRAPH_H
+
+#include <stdint.h>
+
+#include "history.h"
+#include "ssd1306_gfx.h"
+
+// The last two minutes as a bar graph under a one page title, one column
+// per second with the newest on the right. Bars are the Leq of each second
+// from the history. The warning threshold is dotted and the danger one
+// dashed across them, inverted over a bar so they stay visible. The dots
+// belong to their second, not to a screen column, so a graph moved one
+// column to the left is still the graph of the same seconds.
+#define LEVEL_GRAPH_COLUMNS HISTORY_SECONDS
+#define LEVEL_GRAPH_LEFT (ssd1306_width - LEVEL_GRAPH_COLUMNS)
+#define LEVEL_GRAPH_FIRST_PAGE 2
+#define LEVEL_GRAPH_HEIGHT (ssd1306_height - LEVEL_GRAPH_FIRST_PAGE * ssd1306_page_height)
+
+// 30 dB SPL at the bottom, one pixel per 1.5 dB, so 102 dB at the top
+#define LEVEL_GRAPH_FLOOR_DECIDB 300
+#define LEVEL_GRAPH_DECIDB_PER_PIXEL 15
+
+// Screen window of the bars
+extern const struct render_area level_graph_area;
+
+// Draws the column of second `second` (the closed period number) at x.
+// record is NULL for a second not in the history, which only shows the
+// threshold lines.
+void level_graph_column(uint8_t *ssd, int x, uint32_t second, const history_record_t *record, int warning,
+                        int danger);
+
+// Draws every column, second closed - 1 on the right
+void level_graph_draw(uint8_t *ssd, const history_t *history, uint32_t closed, int warning, int danger);
+
+// Moves the graph one column left, as ssd1306_scroll_column_left does on
+// the panel, and draws second closed - 1 in the column that frees up
+void level_graph_scroll(uint8_t *ssd, const history_t *history, uint32_t closed, int warning, int danger);
+
+#endif // LEVEL_GRAPH_H
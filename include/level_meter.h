@@ -0,0 +1,97 @@
+#ifndef LEVEL_METER_H
+#define LEVEL_METER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp_tables.h"
+
+// Raw samples are centred on mid-scale; the weighting removes what is left
+#define LEVEL_METER_MIDSCALE 2048
+
+#define LEVEL_METER_FAST_MS 125
+#define LEVEL_METER_SLOW_MS 1000
+
+// Leq integration period. The window moves on a tenth of it at a time, so
+// once full it covers the last 0.9 to 1 times LEVEL_METER_LEQ_S seconds;
+// until then it covers everything since the start or the last reset.
+#ifndef LEVEL_METER_LEQ_S
+#define LEVEL_METER_LEQ_S 60
+#endif
+#define LEVEL_METER_LEQ_SLOTS 10
+
+typedef enum
+{
+    WEIGHTING_A,
+    WEIGHTING_C,
+} weighting_curve_t;
+
+// One DF1 biquad of the cascade. x and y are Q12 ADC counts, error holds
+// the two previous rounding residues fed back into the recursion, which
+// keeps poles close to DC from amplifying the rounding.
+typedef struct
+{
+    int32_t x1, x2;
+    int32_t y1, y2;
+    int32_t error1, error2;
+} level_meter_section_t;
+
+// Sum of squares over one tenth of the Leq period
+typedef struct
+{
+    uint64_t sum_q6;
+    uint32_t samples;
+} level_meter_leq_slot_t;
+
+// Sound level meter over the continuous sample stream: A or C weighting,
+// Fast and Slow exponential time weighting and a Leq over the last
+// LEVEL_METER_LEQ_S seconds. Every level is a weighted RMS in ADC counts,
+// Q8 like block_stats_t.rms_q8.
+typedef struct
+{
+    weighting_curve_t curve;
+    uint32_t sample_rate;
+    unsigned section_count;
+    const dsp_biquad_q30_t *coefficients;
+    level_meter_section_t sections[DSP_A_WEIGHTING_SECTIONS];
+
+    // Integrator inputs are squares in Q6 counts^2, the states keep 32
+    // extra fraction bits so slow decays do not stall on small levels
+    uint32_t fast_alpha_q32;
+    uint32_t slow_alpha_q32;
+    int64_t fast_q38;
+    int64_t slow_q38;
+
+    // The slot being filled is leq_slot; the next one is the oldest and is
+    // cleared when the filled one reaches leq_slot_samples. Sums saturate.
+    level_meter_leq_slot_t leq_slots[LEVEL_METER_LEQ_SLOTS];
+    unsigned leq_slot;
+    uint32_t leq_slot_samples;
+
+    // Sum over the last block alone
+    uint64_t block_sum_q6;
+    uint32_t block_samples;
+} level_meter_t;
+
+// Fails when no coefficients were generated for sample_rate
+bool level_meter_init(level_meter_t *meter, weighting_curve_t curve, uint32_t sample_rate);
+void level_meter_process(level_meter_t *meter, const uint16_t *samples, uint32_t count);
+
+// Starts the Leq period again from the next sample
+void level_meter_reset_leq(level_meter_t *meter);
+
+// Weighting filters back to rest for samples that do not follow on from the
+// last ones; Fast, Slow and Leq carry on
+void level_meter_restart(level_meter_t *meter);
+
+uint32_t level_meter_fast_q8(const level_meter_t *meter);
+uint32_t level_meter_slow_q8(const level_meter_t *meter);
+uint32_t level_meter_leq_q8(const level_meter_t *meter);
+// Weighted RMS of the last block passed to level_meter_process
+uint32_t level_meter_block_q8(const level_meter_t *meter);
+
+// Analog IEC 61672 response at `frequency`, in dB, kept to check the
+// digital cascade against
+double level_meter_response_ref(weighting_curve_t curve, double frequency);
+
+#endif // LEVEL_METER_H
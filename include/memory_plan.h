@@ -0,0 +1,58 @@
+#ifndef MEMORY_PLAN_H
+#define MEMORY_PLAN_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Every task stack, TCB and kernel object is allocated statically from the
+// sizes below, and the kernel has no heap, so the link map is the whole
+// RAM budget and nothing can fail to allocate at run time.
+//
+// Stacks are in words. The stats and memory packets report the least free
+// stack each task has had; keep a quarter of each stack spare.
+#define MEMORY_STACK_MONITOR 384
+#ifdef NOISEGUARD_PROFILE
+#define MEMORY_STACK_DISPLAY 512 // snprintf on the profile pages
+#else
+#define MEMORY_STACK_DISPLAY 320
+#endif
+#define MEMORY_STACK_INPUT 256
+#define MEMORY_STACK_EVENTS 256
+#define MEMORY_STACK_TELEMETRY 384
+
+// Packets waiting for the USB task, 64 bytes each. Raw mode puts a block's
+// worth in at once, SAMPLES / TELEMETRY_RAW_SAMPLES packets.
+#define MEMORY_TELEMETRY_QUEUE 64
+
+// Button edges waiting for the input task, enough for a bouncing press on
+// each button at once
+#define MEMORY_INPUT_QUEUE 32
+
+// No task gets less than the kernel's minimum; the simulator raises it to
+// what a POSIX thread needs
+#define MEMORY_STACK_WORDS(words) ((words) > configMINIMAL_STACK_SIZE ? (words) : configMINIMAL_STACK_SIZE)
+
+// Tasks in the order the stats packet lists them
+typedef enum
+{
+    MEMORY_TASK_MONITOR,
+    MEMORY_TASK_DISPLAY,
+    MEMORY_TASK_INPUT,
+    MEMORY_TASK_EVENTS,
+    MEMORY_TASK_TELEMETRY,
+    MEMORY_TASK_COUNT
+} memory_task_t;
+
+extern TaskHandle_t memory_tasks[MEMORY_TASK_COUNT];
+
+// Creates the task on its planned stack and TCB, once per task
+TaskHandle_t memory_task_create(memory_task_t task, TaskFunction_t code, UBaseType_t priority);
+
+// Planned stack of a task, in words
+uint32_t memory_stack_words(memory_task_t task);
+
+// Bytes taken from the C library heap, which nothing in the firmware should
+// use; anything here is a library allocating behind our back
+uint32_t memory_heap_used(void);
+
+#endif // MEMORY_PLAN_H
@@ -0,0 +1,83 @@
+#ifndef MONITOR_STATE_H
+#define MONITOR_STATE_H
+
+#include <stdint.h>
+
+#include "dsp_tables.h"
+
+// Levels and thresholds are in deci-dB SPL (850 is 85.0 dB)
+#define DEFAULT_GAP 50
+#define MIN_GAP 10
+#define MAX_GAP 200
+#define GAP_STEP 10
+
+#define NOISE_THRESHOLD_WARNING 850
+#define NOISE_THRESHOLD_DANGER 900
+#define THRESHOLD_STEP 10
+
+// Range the buttons keep both thresholds in, the span the history buckets
+// cover
+#define MIN_THRESHOLD 200
+#define MAX_THRESHOLD 1200
+
+// What the LED thresholds are compared against
+typedef enum
+{
+    MONITOR_METRIC_LEVEL, // unweighted RMS of the last block
+    MONITOR_METRIC_FAST,  // weighted, Fast (125 ms) time weighting
+    MONITOR_METRIC_SLOW,  // weighted, Slow (1 s) time weighting
+    MONITOR_METRIC_LEQ,   // weighted, equivalent continuous level over LEVEL_METER_LEQ_S
+    MONITOR_METRIC_COUNT
+} monitor_metric_t;
+
+// State shared between the tasks. Each record has one writer: the level is
+// published by the noise monitor and the thresholds by the input task.
+// Reads never block and always return values that were published together.
+// All levels are calibrated deci-dB SPL. Bands are lowest first, centred
+// on dsp_octave_centre_hz and dsp_third_octave_centre_hz.
+typedef struct
+{
+    int level;
+    int fast;
+    int slow;
+    int leq;
+    int16_t octave_db[DSP_OCTAVE_BANDS];
+    int16_t third_octave_db[DSP_THIRD_OCTAVE_BANDS];
+} monitor_level_t;
+
+typedef struct
+{
+    int warning;
+    int danger;
+    int gap;
+    monitor_metric_t metric;
+} monitor_thresholds_t;
+
+typedef struct
+{
+    monitor_level_t level;
+    monitor_thresholds_t thresholds;
+    uint32_t level_version;
+    uint32_t thresholds_version;
+} monitor_snapshot_t;
+
+void monitor_state_init(void);
+
+void monitor_state_publish_level(const monitor_level_t *level);
+void monitor_state_publish_thresholds(const monitor_thresholds_t *thresholds);
+
+uint32_t monitor_state_level(monitor_level_t *level);
+uint32_t monitor_state_thresholds(monitor_thresholds_t *thresholds);
+void monitor_state_snapshot(monitor_snapshot_t *snapshot);
+
+// Moves both thresholds by step, keeping the gap
+void monitor_thresholds_shift(monitor_thresholds_t *thresholds, int step);
+
+// Moves the danger threshold by changing the gap by step, within MIN_GAP
+// .. MAX_GAP. Both keep the thresholds within MIN_THRESHOLD .. MAX_THRESHOLD.
+void monitor_thresholds_widen(monitor_thresholds_t *thresholds, int step);
+
+int monitor_level_metric(const monitor_level_t *level, monitor_metric_t metric);
+const char *monitor_metric_name(monitor_metric_t metric);
+
+#endif // MONITOR_STATE_H
@@ -4,21 +4,58 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
-#define DEFAULT_GAP 1000
-#define MIN_GAP 200
-#define MAX_GAP 2000
+#include "alarm.h"
+#include "clip_ring.h"
+#include "history.h"
+#include "level_meter.h"
+#include "monitor_state.h"
+#include "noise_pipeline.h"
 
-#define NOISE_THRESHOLD_WARNING 2000
-#define NOISE_THRESHOLD_DANGER 3000
-#define SAMPLE_RATE_MS 100
+// Spectrum of the first 2^NOISE_SPECTRUM_LOG2 samples of every block, 8 or 9
+#ifndef NOISE_SPECTRUM_LOG2
+#define NOISE_SPECTRUM_LOG2 9
+#endif
 
-void vTaskMonitorNoise(void *pvParameters);
+// Frequency weighting of the Fast, Slow and Leq levels
+#define NOISE_WEIGHTING WEIGHTING_A
+
+// Sound kept around a danger crossing: NOISE_CLIP_RING_MS of audio in RAM,
+// of which a clip holds NOISE_CLIP_PRE_MS up to the crossing and
+// NOISE_CLIP_POST_MS after it. The ring is what has to fit in RAM, about
+// 24 KB a second at 48 kHz with ADPCM and twice that with mu-law.
+#ifndef NOISE_CLIP_CODEC
+#define NOISE_CLIP_CODEC CLIP_CODEC_ADPCM
+#endif
+#ifndef NOISE_CLIP_RING_MS
+#define NOISE_CLIP_RING_MS 3000
+#endif
+#ifndef NOISE_CLIP_PRE_MS
+#define NOISE_CLIP_PRE_MS 1500
+#endif
+#ifndef NOISE_CLIP_POST_MS
+#define NOISE_CLIP_POST_MS 1000
+#endif
+
+// Whole blocks covering ms
+#define NOISE_CLIP_BLOCKS(ms) \
+    ((uint32_t)(((uint64_t)(ms) * AUDIO_SAMPLE_RATE + SAMPLES * 1000 - 1) / ((uint64_t)SAMPLES * 1000)))
+
+// Set up by the monitor task before its first block and only run by it;
+// the telemetry code it calls reads the settings
+extern noise_pipeline_t noise_pipeline;
 
-void update_led_status(int level);
+// Level history kept by the monitor task, readable from any task
+extern history_t noise_history;
+
+// Recorded and triggered by the monitor task, read by the telemetry task
+extern clip_ring_t noise_clips;
+
+// True from the block the level goes above the warning threshold until
+// the stretch is logged; read by the event store task
+bool noise_monitor_episode_open(void);
+
+void vTaskMonitorNoise(void *pvParameters);
 
-extern int noise_level;
-extern int warning_threshold;
-extern int danger_threshold;
-extern int threshold_gap;
+void update_led_status(alarm_state_t state);
 
 #endif // NOISE_MONITOR_H
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef NOISE_PIPELINE_H
+#define NOISE_PIPELINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "alarm.h"
+#include "block_stats.h"
+#include "calibration.h"
+#include "level_meter.h"
+#include "monitor_state.h"
+#include "spectrum.h"
+
+// What the monitor task does with each block of decimated samples, from
+// the weighting filters to the alarm state, kept apart from the task so a
+// replay on the host runs the same code. The stages are separate calls so
+// the monitor can time each one; noise_pipeline_process runs them all.
+typedef struct
+{
+    spectrum_t spectrum;
+    level_meter_t meter;
+    calibration_profile_t profile;
+    calibration_t calibration;
+    block_stats_t stats;
+    uint32_t thirds_q8[DSP_THIRD_OCTAVE_BANDS];
+    uint32_t octaves_q8[DSP_OCTAVE_BANDS];
+    monitor_level_t level;
+} noise_pipeline_t;
+
+// Keeps a copy of profile. Fails when no filters were generated for
+// sample_rate.
+bool noise_pipeline_init(noise_pipeline_t *pipeline, const calibration_profile_t *profile, uint32_t adc_vref_mv,
+                         weighting_curve_t weighting, unsigned spectrum_log2, uint32_t sample_rate);
+
+void noise_pipeline_meter(noise_pipeline_t *pipeline, const uint16_t *samples, uint32_t count);
+void noise_pipeline_stats(noise_pipeline_t *pipeline, const uint16_t *samples, uint32_t count);
+void noise_pipeline_spectrum(noise_pipeline_t *pipeline, const uint16_t *samples);
+
+// Calibrated levels of the block into pipeline->level, and the alarm state
+// of the metric the thresholds choose, whose level goes to metric_level
+alarm_state_t noise_pipeline_levels(noise_pipeline_t *pipeline, const monitor_thresholds_t *thresholds,
+                                    int *metric_level);
+
+// The next block does not follow on from the last one: the weighting
+// filters start again from rest instead of ringing on the step between them
+void noise_pipeline_restart(noise_pipeline_t *pipeline);
+
+alarm_state_t noise_pipeline_process(noise_pipeline_t *pipeline, const uint16_t *samples, uint32_t count,
+                                     const monitor_thresholds_t *thresholds, int *metric_level);
+
+#endif // NOISE_PIPELINE_H
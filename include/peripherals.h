@@ -5,6 +5,9 @@
 #include "hardware/adc.h"
 #include "hardware/i2c.h"
 #include "hardware/dma.h"
+#include "hardware/flash.h"
+
+#include "adc_rr.h"
 
 #define LED_RED 13
 #define LED_GREEN 11
@@ -18,14 +21,39 @@
 #define I2C_SDA 14
 #define I2C_SCL 15
 
-#define SAMPLES 200
+#define JOYSTICK_X_ADC_INPUT 1
+#define MIC_ADC_INPUT 2
+
+// Microphone rate after decimation: 16000, 24000 or 48000
+#ifndef AUDIO_SAMPLE_RATE
+#define AUDIO_SAMPLE_RATE 48000
+#endif
+
+// Audio samples per block handed to the monitor
+#ifndef SAMPLES
+#define SAMPLES 1024
+#endif
+
+#define ADC_VREF_MV 3300
+
+// Calibration profile (calibration_profile_t) in the last flash sector
+#define CALIBRATION_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+
+// Event log sectors just below it
+#define EVENT_LOG_SECTORS 8
+#define EVENT_LOG_FLASH_OFFSET (CALIBRATION_FLASH_OFFSET - EVENT_LOG_SECTORS * FLASH_SECTOR_SIZE)
+
+// Raw samples per audio sample: CIC by 4 (by 2 at 48 kHz), then FIR by 2
+#define AUDIO_DECIMATION (AUDIO_SAMPLE_RATE > 24000 ? 4 : 8)
+
+// The ADC converts at 48 MHz / (ADC_CLKDIV + 1), shared by the round-robin
+// inputs, so each input runs at AUDIO_DECIMATION times the audio rate
+#define ADC_CONVERSION_RATE (AUDIO_SAMPLE_RATE * AUDIO_DECIMATION * ADC_RR_CHANNELS)
+#define ADC_CLKDIV (48000000.0f / ADC_CONVERSION_RATE - 1.0f)
 
 void init_peripherals(void);
 int read_joystick_x(void);
-float calculate_rms(uint16_t *buffer, int samples);
 
 extern uint16_t adc_buffer[];
-extern uint dma_channel;
-extern dma_channel_config dma_cfg;
 
 #endif // PERIPHERALS_H
\ No newline at end of file
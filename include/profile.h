@@ -0,0 +1,43 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#include "seqlatch.h"
+
+// Durations in us, binned by powers of two: bin 0 holds 0 and 1 us, bin b
+// 2^b to 2^(b+1) - 1 us, and the last bin everything longer
+#define PROFILE_BINS 16
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t bins[PROFILE_BINS];
+} profile_stats_t;
+
+// One stage of the pipeline, timed by the task that runs it (or by one
+// interrupt). Readers get whole records through the latch.
+typedef struct
+{
+    profile_stats_t working;
+    seqlatch_t latch;
+    profile_stats_t copies[2];
+} profile_stage_t;
+
+void profile_stage_init(profile_stage_t *stage);
+
+// Only from the stage's own task
+void profile_stage_record(profile_stage_t *stage, uint32_t us);
+
+// From any task
+void profile_stage_read(const profile_stage_t *stage, profile_stats_t *stats);
+
+uint32_t profile_mean_us(const profile_stats_t *stats);
+
+// Upper edge of the bin holding the given percentile, 0 with no samples
+uint32_t profile_percentile_us(const profile_stats_t *stats, unsigned percent);
+
+#endif // PROFILE_H
@@ -0,0 +1,25 @@
+#ifndef SEQLATCH_H
+#define SEQLATCH_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Single-writer record kept in two copies. An odd sequence sends readers to
+// copy 1 while copy 0 is rewritten, an even one to copy 0 while copy 1
+// catches up, so a reader never waits for a preempted writer. It retries
+// when a publish starts or moves on to the other copy during its own.
+typedef struct
+{
+    atomic_uint seq;
+} seqlatch_t;
+
+// copies points to two consecutive records of `size` bytes
+void seqlatch_init(seqlatch_t *latch, void *copies, const void *value, size_t size);
+void seqlatch_publish(seqlatch_t *latch, void *copies, const void *value, size_t size);
+
+// Copies a consistent record into value and returns its version, the number
+// of publishes so far
+uint32_t seqlatch_read(const seqlatch_t *latch, const void *copies, void *value, size_t size);
+
+#endif // SEQLATCH_H
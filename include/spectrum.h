@@ -0,0 +1,45 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdint.h>
+
+#include "block_stats.h"
+#include "dsp_tables.h"
+
+#define SPECTRUM_MAX_BANDS DSP_THIRD_OCTAVE_BANDS
+
+typedef enum
+{
+    SPECTRUM_OCTAVE,
+    SPECTRUM_THIRD_OCTAVE,
+} spectrum_resolution_t;
+
+// Band analysis of the first 2^log2n samples of a block. first_bin and
+// bin_count map each band onto the FFT bins whose centre falls inside it;
+// bands below the bin spacing or above Nyquist get no bins and read 0.
+typedef struct
+{
+    spectrum_resolution_t resolution;
+    unsigned log2n;
+    uint32_t sample_rate;
+    unsigned band_count;
+    uint16_t first_bin[SPECTRUM_MAX_BANDS];
+    uint16_t bin_count[SPECTRUM_MAX_BANDS];
+    int16_t data[2 * DSP_FFT_MAX_SIZE];
+} spectrum_t;
+
+void spectrum_init(spectrum_t *spectrum, spectrum_resolution_t resolution, unsigned log2n,
+                   uint32_t sample_rate);
+const uint16_t *spectrum_band_centres_hz(const spectrum_t *spectrum);
+
+// Per band AC RMS in ADC counts, Q8 like block_stats_t.rms_q8. `stats`
+// are the statistics of the block the samples come from.
+void spectrum_compute(spectrum_t *spectrum, const uint16_t *samples, const block_stats_t *stats,
+                      uint32_t *band_rms_q8);
+// Octave k spans third octaves 3k..3k+2 and is centred on 3k+1, so its
+// energy is the sum of theirs
+void spectrum_octaves_from_thirds(const uint32_t *third_rms_q8, uint32_t *octave_rms_q8);
+
+void spectrum_compute_ref(const spectrum_t *spectrum, const uint16_t *samples, double *band_rms);
+
+#endif // SPECTRUM_H
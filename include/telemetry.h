@@ -0,0 +1,314 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary stream sent to the host: fixed 64 byte packets, one USB full speed
+// bulk packet each, little endian. The sync bytes mark where a packet may
+// start and the CRC-16/CCITT-FALSE over the rest confirms it, so a reader
+// that joins mid-stream or loses bytes finds its way back. A change to the
+// layout gets new sync bytes.
+#define TELEMETRY_SYNC0 0xA5
+#define TELEMETRY_SYNC1 0x5B
+#define TELEMETRY_PACKET_SIZE 64
+#define TELEMETRY_PAYLOAD_SIZE 56
+
+// Host to device commands, single bytes on the same port
+#define TELEMETRY_COMMAND_RAW_ON 'r'
+#define TELEMETRY_COMMAND_RAW_OFF 'n'
+
+typedef enum
+{
+    TELEMETRY_LEVELS = 1, // telemetry_levels_t
+    TELEMETRY_BANDS,      // telemetry_bands_t
+    TELEMETRY_STATE,      // telemetry_state_t
+    TELEMETRY_STATS,      // telemetry_stats_t
+    TELEMETRY_RAW,        // telemetry_raw_t
+    TELEMETRY_PROFILE,    // telemetry_profile_t
+    TELEMETRY_LOAD,       // telemetry_load_t
+    TELEMETRY_LATENCY,    // telemetry_profile_t, stage is a latency_path_t
+    TELEMETRY_TRACE,      // telemetry_trace_t
+    TELEMETRY_MEMORY,     // telemetry_memory_t
+    TELEMETRY_CLIP,       // telemetry_clip_t
+    TELEMETRY_INFO,       // telemetry_info_t
+    TELEMETRY_HISTORY,    // telemetry_history_t
+    TELEMETRY_TYPE_COUNT
+} telemetry_type_t;
+
+// length is the payload bytes in use, the rest are zero. seq counts packets
+// as they leave the device, so a gap is a packet lost on the way; packets
+// the device had no room for are counted in the stats instead. crc covers
+// the bytes before it. Payloads are copied in and out, they are not aligned.
+typedef struct
+{
+    uint8_t sync[2];
+    uint8_t type;
+    uint8_t length;
+    uint16_t seq;
+    uint8_t payload[TELEMETRY_PAYLOAD_SIZE];
+    uint16_t crc;
+} telemetry_packet_t;
+
+// Payloads. Levels are deci-dB SPL, times ms since boot.
+
+typedef struct
+{
+    int16_t level;
+    int16_t fast;
+    int16_t slow;
+    int16_t leq;
+} telemetry_level_t;
+
+#define TELEMETRY_LEVELS_PER_PACKET 6
+
+// Consecutive blocks, the first one ending at time_ms and the others
+// block_us apart
+typedef struct
+{
+    uint32_t time_ms;
+    uint16_t block_us;
+    uint8_t count;
+    uint8_t reserved;
+    telemetry_level_t levels[TELEMETRY_LEVELS_PER_PACKET];
+} telemetry_levels_t;
+
+#define TELEMETRY_BANDS_PER_PACKET 24
+
+// Bands first .. first + count - 1 of one block, lowest first; resolution
+// is 1 for octaves and 3 for third octaves
+typedef struct
+{
+    uint32_t time_ms;
+    uint8_t resolution;
+    uint8_t first;
+    uint8_t count;
+    uint8_t reserved;
+    int16_t bands[TELEMETRY_BANDS_PER_PACKET];
+} telemetry_bands_t;
+
+// Sent when the thresholds or the alarm state change and once a second
+typedef struct
+{
+    uint32_t time_ms;
+    int16_t warning;
+    int16_t danger;
+    int16_t gap;
+    uint8_t metric;
+    uint8_t alarm;
+    int16_t metric_level;
+    uint8_t raw;
+    uint8_t reserved;
+} telemetry_state_t;
+
+#define TELEMETRY_STATS_TASKS 6
+#define TELEMETRY_DEADLINE_TASKS 3
+
+// Counters since boot, sent once a second. stack_free is the least free
+// stack each task has had, in words, in the order the firmware lists them.
+// deadline_misses are per latency_task_t: monitor, display, input.
+typedef struct
+{
+    uint32_t time_ms;
+    uint32_t capture_blocks;
+    uint32_t capture_dropped;
+    uint32_t capture_overruns;
+    uint32_t display_frames;
+    uint32_t packets_sent;
+    uint32_t packets_dropped;
+    uint32_t bytes_sent;
+    uint16_t events_pending;
+    uint16_t events_dropped;
+    uint16_t stack_free[TELEMETRY_STATS_TASKS];
+    uint16_t deadline_misses[TELEMETRY_DEADLINE_TASKS];
+    uint16_t reserved;
+} telemetry_stats_t;
+
+// Sent with the stats: the planned stack of each task next to the least
+// it has had free, both in words and in the stats order, and the bytes
+// taken from the C library heap, which should stay at 0
+typedef struct
+{
+    uint32_t time_ms;
+    uint32_t heap_used;
+    uint16_t stack_words[TELEMETRY_STATS_TASKS];
+    uint16_t stack_free[TELEMETRY_STATS_TASKS];
+} telemetry_memory_t;
+
+#define TELEMETRY_RAW_SAMPLES 22
+
+// Decimated microphone samples offset .. offset + count - 1 of block
+// number block, as 12-bit ADC counts. lost is the capture_block_t count of
+// samples lost right before the block, where the device's processing
+// started again; only the packet at offset 0 carries it.
+typedef struct
+{
+    uint32_t block;
+    uint16_t offset;
+    uint16_t count;
+    uint32_t lost;
+    uint16_t samples[TELEMETRY_RAW_SAMPLES];
+} telemetry_raw_t;
+
+#define TELEMETRY_CLIP_DATA 42
+
+// Bytes offset .. offset + length - 1 of the encoding of one block of a
+// clip, bytes long in all, as the clip ring stores it (codec is a
+// clip_codec_t). Blocks are numbered from the start of the clip, which has
+// count of them; the danger threshold was crossed in block trigger.
+typedef struct
+{
+    uint16_t clip;
+    uint16_t block;
+    uint16_t count;
+    uint16_t trigger;
+    uint16_t bytes;
+    uint16_t offset;
+    uint8_t codec;
+    uint8_t length;
+    uint8_t data[TELEMETRY_CLIP_DATA];
+} telemetry_clip_t;
+
+#define TELEMETRY_FIRMWARE 16
+
+// How the device turns samples into levels, enough to run raw mode samples
+// through the same processing on the host. Sent when a host connects and
+// when raw mode is turned on, ahead of the first raw packet. weighting is
+// a weighting_curve_t, firmware the version, NUL padded.
+typedef struct
+{
+    uint32_t sample_rate;
+    uint16_t block_samples;
+    uint16_t adc_vref_mv;
+    int16_t sensitivity_decidbv;
+    int16_t offset_decidb;
+    uint8_t weighting;
+    uint8_t spectrum_log2;
+    uint8_t reserved[2];
+    char firmware[TELEMETRY_FIRMWARE];
+} telemetry_info_t;
+
+#define TELEMETRY_HISTORY_RECORDS 4
+
+// One closed period of the history, as history_record_t keeps it
+typedef struct
+{
+    int16_t min;
+    int16_t max;
+    int16_t leq;
+    int16_t l10;
+    int16_t l90;
+    uint16_t gaps;
+} telemetry_history_record_t;
+
+// Periods first .. first + count - 1 since boot of the minutes (resolution
+// 1) or hours (2), oldest first. Whatever the device still keeps goes out
+// when a host connects, then each period once it closes.
+typedef struct
+{
+    uint32_t first;
+    uint8_t resolution;
+    uint8_t count;
+    uint8_t reserved[2];
+    telemetry_history_record_t records[TELEMETRY_HISTORY_RECORDS];
+} telemetry_history_t;
+
+#define TELEMETRY_PROFILE_BINS 16
+
+// Timings of one pipeline stage since boot, from profiling builds, or of
+// one latency path. bins are the share of the runs in each power of two
+// bin of profile_stats_t, in thousandths.
+typedef struct
+{
+    uint32_t time_ms;
+    uint8_t stage;
+    uint8_t reserved[3];
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t mean_us;
+    uint16_t bins[TELEMETRY_PROFILE_BINS];
+} telemetry_profile_t;
+
+#define TELEMETRY_LOAD_TASKS 4
+#define TELEMETRY_LOAD_NAME 10
+
+typedef struct
+{
+    char name[TELEMETRY_LOAD_NAME];
+    uint16_t permille;
+} telemetry_task_load_t;
+
+// CPU share of tasks first .. first + count - 1 of total over the last
+// interval, from profiling builds
+typedef struct
+{
+    uint32_t time_ms;
+    uint8_t first;
+    uint8_t count;
+    uint8_t total;
+    uint8_t reserved;
+    telemetry_task_load_t tasks[TELEMETRY_LOAD_TASKS];
+} telemetry_load_t;
+
+#define TELEMETRY_TRACE_ENTRIES 6
+
+// A trace_point_t reached by block (its low 16 bits) at time_us on the
+// device's 1 MHz timer
+typedef struct
+{
+    uint32_t time_us;
+    uint16_t block;
+    uint8_t point;
+    uint8_t reserved;
+} telemetry_trace_entry_t;
+
+// Pipeline trace, oldest first. lost is the entries the device overwrote
+// before this packet could take them.
+typedef struct
+{
+    uint32_t lost;
+    uint8_t count;
+    uint8_t reserved[3];
+    telemetry_trace_entry_t entries[TELEMETRY_TRACE_ENTRIES];
+} telemetry_trace_t;
+
+// Header and payload of a packet still to be sent; length is at most
+// TELEMETRY_PAYLOAD_SIZE
+void telemetry_pack(telemetry_packet_t *packet, telemetry_type_t type, const void *payload, size_t length);
+
+// Numbers the packet and fills in its CRC, just before it goes out
+void telemetry_seal(telemetry_packet_t *packet, uint16_t seq);
+
+// Copies the payload out, zero filling past length; false when the packet
+// is not of the type asked for
+bool telemetry_unpack(const telemetry_packet_t *packet, telemetry_type_t type, void *payload, size_t size);
+
+// Reassembles packets from a byte stream cut anywhere. Bytes that do not
+// make a valid packet are skipped one at a time until one does.
+typedef void (*telemetry_packet_fn)(const telemetry_packet_t *packet, void *ctx);
+
+typedef struct
+{
+    telemetry_packet_t packet;
+    uint32_t fill;
+    bool synced;
+    uint16_t next_seq;
+
+    uint64_t bytes;
+    uint64_t skipped;
+    uint32_t packets;
+    uint32_t crc_errors;
+    uint32_t lost;
+    uint32_t by_type[TELEMETRY_TYPE_COUNT];
+} telemetry_decoder_t;
+
+void telemetry_decoder_init(telemetry_decoder_t *decoder);
+
+// Calls packet for every valid packet in bytes, in order. A damaged packet
+// counts as a CRC error and, once the next one arrives, as lost.
+void telemetry_decode(telemetry_decoder_t *decoder, const uint8_t *bytes, size_t len, telemetry_packet_fn packet,
+                      void *ctx);
+
+#endif // TELEMETRY_H
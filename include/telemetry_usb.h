@@ -0,0 +1,60 @@
+#ifndef TELEMETRY_USB_H
+#define TELEMETRY_USB_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "alarm.h"
+#include "capture_queue.h"
+#include "memory_plan.h"
+#include "monitor_state.h"
+#include "telemetry.h"
+
+// Reported in the info packet
+#ifndef NOISEGUARD_VERSION
+#define NOISEGUARD_VERSION "unknown"
+#endif
+
+// Packets handed to the USB stack per write
+#define TELEMETRY_WRITE_BATCH 8
+
+// Blocks between two sets of band packets
+#define TELEMETRY_BANDS_EVERY 5
+
+#define TELEMETRY_STATE_MS 1000
+
+// Counters and latencies, and in profiling builds the stage timings and
+// task loads
+#define TELEMETRY_STATS_MS 1000
+
+// Longest the USB task sleeps with nothing queued, which is also how
+// often it looks for host commands
+#define TELEMETRY_POLL_MS 50
+
+// Held clip blocks sent per pass of the USB task. While a clip has blocks
+// waiting the task does not sleep, so the ring drains as fast as the port
+// takes it, well ahead of the audio coming in.
+#define TELEMETRY_CLIP_BLOCKS 4
+
+typedef struct
+{
+    uint32_t packets_sent;
+    uint32_t packets_dropped;
+    uint32_t bytes_sent;
+} telemetry_usb_stats_t;
+
+// The telemetry task owns the USB serial port; nothing else writes to it
+extern TaskHandle_t telemetry_task;
+extern telemetry_usb_stats_t telemetry_usb_stats;
+
+void telemetry_init(void);
+
+// Called by the monitor once per block. Batches the levels and queues what
+// is due without blocking; packets that do not fit are dropped and
+// counted. Does nothing while no host has the port open.
+void telemetry_publish_block(const monitor_level_t *level, const monitor_thresholds_t *thresholds,
+                             alarm_state_t state, int metric_level, const capture_block_t *block);
+
+void vTaskSendTelemetry(void *pvParameters);
+
+#endif // TELEMETRY_USB_H
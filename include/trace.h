@@ -0,0 +1,54 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Points a block passes on its way from the microphone to the LED and the
+// panel
+typedef enum
+{
+    TRACE_CAPTURE, // last sample of the block is in RAM
+    TRACE_DSP,     // levels and bands computed
+    TRACE_LED,     // LED set for the block's alarm state
+    TRACE_FRAME,   // frame showing the block has left on the I2C bus
+    TRACE_POINT_COUNT
+} trace_point_t;
+
+// time_us is on the 1 MHz timer and block is the capture block number
+typedef struct
+{
+    uint32_t time_us;
+    uint32_t block;
+    uint8_t point;
+} trace_entry_t;
+
+// Entries kept, a power of two so positions wrap with the 32-bit head
+#define TRACE_RING_LENGTH 64
+
+// Fixed-size log with one writer, a task or an interrupt handler, and any
+// number of readers, each with its own cursor. The writer never waits: it
+// overwrites the oldest entry, and readers that fall behind skip what was
+// overwritten and count it. The slot at head is the one being written, so
+// readers get at most TRACE_RING_LENGTH - 1 entries back.
+typedef struct
+{
+    trace_entry_t entries[TRACE_RING_LENGTH];
+    atomic_uint head;
+} trace_ring_t;
+
+void trace_ring_init(trace_ring_t *ring);
+
+// Only from the ring's writer
+void trace_ring_put(trace_ring_t *ring, trace_point_t point, uint32_t block, uint32_t time_us);
+
+// Entries written so far; a reader that starts here sees only new ones
+uint32_t trace_ring_head(const trace_ring_t *ring);
+
+// Copies up to max entries from *cursor on, oldest first, and moves the
+// cursor past them. Entries overwritten before they could be copied are
+// added to *lost.
+unsigned trace_ring_read(const trace_ring_t *ring, uint32_t *cursor, trace_entry_t *entries, unsigned max,
+                         uint32_t *lost);
+
+#endif // TRACE_H
@@ -0,0 +1,68 @@
+#ifndef WIDGET_H
+#define WIDGET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ssd1306_gfx.h"
+
+// Retained text on the status pages. A screen is a fixed list of widgets
+// drawn once when it is shown; after that a widget is drawn again only
+// when its text or value changes, and its cell is added to the screen's
+// dirty areas, which is all the display then has to send. Numbers are
+// turned into digits without the C library.
+
+// Glyphs are 8 pixels wide, as in ssd1306_font.txt
+#define WIDGET_CHAR_WIDTH 8
+
+#define WIDGET_MAX 8
+
+typedef enum
+{
+    WIDGET_LABEL,  // text, left aligned
+    WIDGET_DECIDB, // value in tenths, "72.4", right aligned
+    WIDGET_NUMBER  // whole value, right aligned; negative shows as "-"
+} widget_kind_t;
+
+typedef struct
+{
+    widget_kind_t kind;
+    uint8_t x;     // pixels
+    uint8_t y;     // pixels, any row
+    uint8_t chars; // cell width
+    const char *text;
+    int32_t value;
+    bool dirty;
+} widget_t;
+
+typedef struct
+{
+    widget_t widgets[WIDGET_MAX];
+    unsigned count;
+} widget_screen_t;
+
+widget_t *widget_add(widget_screen_t *screen, widget_kind_t kind, int x, int y, int chars, const char *text);
+
+// Mark the widget for redrawing only if what it shows changes
+void widget_set_text(widget_t *widget, const char *text);
+void widget_set_value(widget_t *widget, int32_t value);
+
+// Clears the frame and draws every widget
+void widget_screen_show(widget_screen_t *screen, uint8_t *ssd);
+
+// Draws the widgets that changed and returns the areas they cover, at most
+// one per widget
+int widget_screen_draw(widget_screen_t *screen, uint8_t *ssd, struct render_area *areas);
+
+// Longest text widget_format writes, NUL included, as for INT32_MIN with
+// one decimal: "-214748364.8"
+#define WIDGET_FORMAT_BYTES 13
+#define WIDGET_FORMAT_MAX_DECIMALS 9
+
+// Digits of value into text (WIDGET_FORMAT_BYTES), "-" first when negative
+// and with a point before the last `decimals` digits, 0 to
+// WIDGET_FORMAT_MAX_DECIMALS of them; more are cut to that. Returns the
+// length.
+int widget_format(char *text, int32_t value, int decimals);
+
+#endif // WIDGET_H
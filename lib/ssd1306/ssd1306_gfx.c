@@ -0,0 +1,211 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306_gfx.h"
+#include "ssd1306_font.h"
+
+// Calcular quanto do buffer será destinado à área de renderização
+void calculate_render_area_buffer_length(struct render_area *area) {
+    area->buffer_length = (area->end_column - area->start_column + 1) * (area->end_page - area->start_page + 1);
+}
+
+// Compara o quadro com a cópia do último quadro enviado (shadow) e gera as
+// áreas de renderização mínimas, uma por trecho alterado de cada página.
+// Páginas inteiras consecutivas viram uma só área. A shadow é atualizada.
+int ssd1306_diff_areas(const uint8_t *ssd, uint8_t *shadow, struct render_area *areas, int max_areas) {
+    int count = 0;
+
+    for (int page = 0; page < ssd1306_n_pages; page++) {
+        const uint8_t *row = ssd + page * ssd1306_width;
+        uint8_t *shadow_row = shadow + page * ssd1306_width;
+        int column = 0;
+
+        while (column < ssd1306_width) {
+            while (column < ssd1306_width && row[column] == shadow_row[column]) {
+                column++;
+            }
+            if (column == ssd1306_width) {
+                break;
+            }
+
+            int start = column;
+            int end = column;
+            for (; column < ssd1306_width; column++) {
+                if (row[column] != shadow_row[column]) {
+                    end = column;
+                }
+                else if (column - end > ssd1306_diff_merge_gap) {
+                    break;
+                }
+            }
+            column = end + 1;
+
+            memcpy(shadow_row + start, row + start, end - start + 1);
+
+            struct render_area *last = count ? &areas[count - 1] : NULL;
+            bool full_row = start == 0 && end == ssd1306_width - 1;
+            if (last && full_row && last->start_column == 0 && last->end_column == ssd1306_width - 1 &&
+                last->end_page == page - 1) {
+                last->end_page = page;
+                calculate_render_area_buffer_length(last);
+                continue;
+            }
+
+            // Alterações demais: mais barato reenviar o quadro inteiro
+            if (count == max_areas) {
+                memcpy(shadow, ssd, ssd1306_buffer_length);
+                areas[0] = (struct render_area) {
+                    .start_column = 0,
+                    .end_column = ssd1306_width - 1,
+                    .start_page = 0,
+                    .end_page = ssd1306_n_pages - 1};
+                calculate_render_area_buffer_length(&areas[0]);
+                return 1;
+            }
+
+            areas[count] = (struct render_area) {
+                .start_column = start,
+                .end_column = end,
+                .start_page = page,
+                .end_page = page};
+            calculate_render_area_buffer_length(&areas[count]);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// Determina o pixel a ser aceso (no display) de acordo com a coordenada fornecida
+void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set) {
+    assert(x >= 0 && x < ssd1306_width && y >= 0 && y < ssd1306_height);
+
+    const int bytes_per_row = ssd1306_width;
+
+    int byte_idx = (y / 8) * bytes_per_row + x;
+    uint8_t byte = ssd[byte_idx];
+
+    if (set) {
+        byte |= 1 << (y % 8);
+    }
+    else {
+        byte &= ~(1 << (y % 8));
+    }
+
+    ssd[byte_idx] = byte;
+}
+
+// Algoritmo de Bresenham básico
+void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set) {
+    int dx = abs(x_1 - x_0); // Deslocamentos
+    int dy = -abs(y_1 - y_0);
+    int sx = x_0 < x_1 ? 1 : -1; // Direção de avanço
+    int sy = y_0 < y_1 ? 1 : -1;
+    int error = dx + dy; // Erro acumulado
+    int error_2;
+
+    while (true) {
+        ssd1306_set_pixel(ssd, x_0, y_0, set); // Acende pixel no ponto atual
+        if (x_0 == x_1 && y_0 == y_1) {
+            break; // Verifica se o ponto final foi alcançado
+        }
+
+        error_2 = 2 * error; // Ajusta o erro acumulado
+
+        if (error_2 >= dy) {
+            error += dy;
+            x_0 += sx; // Avança na direção x
+        }
+        if (error_2 <= dx) {
+            error += dx;
+            y_0 += sy; // Avança na direção y
+        }
+    }
+}
+
+// Preenche (ou apaga) um retângulo, uma página de cada vez com máscara de bits;
+// o que cai fora da tela é cortado
+void ssd1306_fill_rect(uint8_t *ssd, int x, int y, int width, int height, bool set) {
+    int x_end = x + width < ssd1306_width ? x + width : ssd1306_width;
+    int y_end = y + height < ssd1306_height ? y + height : ssd1306_height;
+
+    x = x < 0 ? 0 : x;
+    y = y < 0 ? 0 : y;
+
+    for (int page = y / 8; page * 8 < y_end; page++) {
+        int top = page * 8 > y ? page * 8 : y;
+        int bottom = page * 8 + 8 < y_end ? page * 8 + 8 : y_end;
+        uint8_t mask = (uint8_t)((0xFFu << (top - page * 8)) & (0xFFu >> (page * 8 + 8 - bottom)));
+        uint8_t *row = ssd + page * ssd1306_width;
+
+        for (int column = x; column < x_end; column++) {
+            row[column] = set ? row[column] | mask : row[column] & ~mask;
+        }
+    }
+}
+
+// Faz no quadro o mesmo que ssd1306_scroll_column_left faz na GDDRAM: a área
+// anda uma coluna para a esquerda e a primeira coluna volta na última
+void ssd1306_scroll_left(uint8_t *ssd, const struct render_area *area) {
+    int width = area->end_column - area->start_column;
+
+    for (int page = area->start_page; page <= area->end_page; page++) {
+        uint8_t *row = ssd + page * ssd1306_width + area->start_column;
+        uint8_t first = row[0];
+        memmove(row, row + 1, width);
+        row[width] = first;
+    }
+}
+
+// Adquire os pixels para um caractere (de acordo com ssd1306_font.h, gerado de
+// ssd1306_font.txt); caracteres fora da fonte viram '?'
+static inline const uint8_t *ssd1306_get_font(uint8_t character) {
+    uint8_t idx = character - ssd1306_font_first;
+
+    if (idx >= ssd1306_font_count) {
+        idx = '?' - ssd1306_font_first;
+    }
+    return font + idx * ssd1306_font_width;
+}
+
+// Copia um glifo para a página `page`, deslocado `shift` linhas para baixo. Com
+// shift != 0 cada coluna vira uma palavra de 16 bits que ocupa duas páginas;
+// keep_top e keep_bottom preservam os pixels vizinhos nas duas páginas
+static inline void ssd1306_blit_glyph(uint8_t *top, const uint8_t *glyph, int shift,
+                                      uint8_t keep_top, uint8_t keep_bottom) {
+    if (shift == 0) {
+        memcpy(top, glyph, ssd1306_font_width);
+        return;
+    }
+
+    uint8_t *bottom = top + ssd1306_width;
+    for (int i = 0; i < ssd1306_font_width; i++) {
+        uint16_t column = (uint16_t)glyph[i] << shift;
+        top[i] = (top[i] & keep_top) | (uint8_t)column;
+        bottom[i] = (bottom[i] & keep_bottom) | (uint8_t)(column >> 8);
+    }
+}
+
+// Desenha um único caractere no display, em qualquer linha y
+void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character) {
+    ssd1306_draw_string(ssd, x, y, (const char[]){ (char)character, '\0' });
+}
+
+// Desenha uma string: o recorte é calculado uma vez e os glifos são copiados
+// direto para o quadro, sem checagem por caractere
+void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, const char *string) {
+    if (x < 0 || y < 0 || x > ssd1306_width - ssd1306_font_width || y > ssd1306_height - 8) {
+        return;
+    }
+
+    int shift = y % ssd1306_page_height;
+    uint8_t keep_top = (uint8_t)~(0xFF << shift);
+    uint8_t keep_bottom = (uint8_t)~(0xFF >> (8 - shift));
+    uint8_t *out = ssd + (y / ssd1306_page_height) * ssd1306_width + x;
+    int room = (ssd1306_width - x) / ssd1306_font_width;
+
+    for (int n = 0; n < room && string[n]; n++) {
+        ssd1306_blit_glyph(out, ssd1306_get_font((uint8_t)string[n]), shift, keep_top, keep_bottom);
+        out += ssd1306_font_width;
+    }
+}
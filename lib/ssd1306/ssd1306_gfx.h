@@ -0,0 +1,70 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef ssd1306_gfx_inc_h
+#define ssd1306_gfx_inc_h
+
+// Parte do driver sem dependência do Pico SDK (compila também no host)
+
+// Comandos de configuração (endereços)
+#define ssd1306_set_memory_mode 0x20u
+#define ssd1306_set_column_address 0x21u
+#define ssd1306_set_page_address 0x22u
+#define ssd1306_set_horizontal_scroll 0x26u
+#define ssd1306_set_scroll 0x2Eu
+// Rolagem de uma única coluna (SSD1306 rev. 1.5 em diante), à direita ou à
+// esquerda, dentro de uma janela de páginas e colunas
+#define ssd1306_scroll_column_right 0x2Cu
+#define ssd1306_scroll_column_left 0x2Du
+
+#define ssd1306_set_display_start_line 0x40u
+
+#define ssd1306_set_contrast 0x81u
+#define ssd1306_set_charge_pump 0x8Du
+
+#define ssd1306_set_segment_remap 0xA0u
+#define ssd1306_set_entire_on 0xA4u
+#define ssd1306_set_all_on 0xA5u
+#define ssd1306_set_normal_display 0xA6u
+#define ssd1306_set_inverse_display 0xA7u
+#define ssd1306_set_mux_ratio 0xA8u
+#define ssd1306_set_display 0xAEu
+#define ssd1306_set_common_output_direction 0xC0u
+#define ssd1306_set_common_output_direction_flip 0xC0u
+
+#define ssd1306_set_display_offset 0xD3u
+#define ssd1306_set_display_clock_divide_ratio 0xD5u
+#define ssd1306_set_precharge 0xD9u
+#define ssd1306_set_common_pin_configuration 0xDAu
+#define ssd1306_set_vcomh_deselect_level 0xDBu
+
+#define ssd1306_height 64 // Define a altura do display (32 pixels)
+#define ssd1306_width 128 // Define a largura do display (128 pixels)
+
+#define ssd1306_page_height 8u
+#define ssd1306_n_pages (ssd1306_height / ssd1306_page_height)
+#define ssd1306_buffer_length (ssd1306_n_pages * ssd1306_width)
+
+// Trechos alterados separados por até este número de colunas iguais viram uma
+// única área, pois cada área extra custa uma transação de endereçamento no I2C
+#define ssd1306_diff_merge_gap 8
+
+struct render_area {
+    uint8_t start_column;
+    uint8_t end_column;
+    uint8_t start_page;
+    uint8_t end_page;
+
+    int buffer_length;
+};
+
+extern void calculate_render_area_buffer_length(struct render_area *area);
+extern int ssd1306_diff_areas(const uint8_t *ssd, uint8_t *shadow, struct render_area *areas, int max_areas);
+extern void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set);
+extern void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set);
+extern void ssd1306_fill_rect(uint8_t *ssd, int x, int y, int width, int height, bool set);
+extern void ssd1306_scroll_left(uint8_t *ssd, const struct render_area *area);
+extern void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character);
+extern void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, const char *string);
+
+#endif
@@ -1,41 +1,103 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <ctype.h>
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "hardware/i2c.h"
-#include "ssd1306_font.h"
 #include "ssd1306_i2c.h"
+#include "ssd1306_stream.h"
 
-// Calcular quanto do buffer será destinado à área de renderização
-void calculate_render_area_buffer_length(struct render_area *area) {
-    area->buffer_length = (area->end_column - area->start_column + 1) * (area->end_page - area->start_page + 1);
+// Sequência usada pelas funções síncronas abaixo
+static ssd1306_stream_t ssd1306_sync_stream;
+
+// Escreve as palavras direto no registrador IC_DATA_CMD, esperando espaço na FIFO
+static void ssd1306_blocking_submit(ssd1306_bus_t *bus, const uint16_t *words, size_t count) {
+    i2c_hw_t *hw = i2c_get_hw(i2c1);
+
+    hw->enable = 0;
+    hw->tar = ssd1306_i2c_address;
+    hw->enable = 1;
+
+    for (size_t i = 0; i < count; i++) {
+        while (!(hw->status & I2C_IC_STATUS_TFNF_BITS)) {
+            tight_loop_contents();
+        }
+        hw->data_cmd = words[i];
+    }
+}
+
+// Espera a FIFO esvaziar e o último STOP sair no barramento
+static void ssd1306_blocking_wait(ssd1306_bus_t *bus) {
+    i2c_hw_t *hw = i2c_get_hw(i2c1);
+
+    while (!(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS)) {
+        tight_loop_contents();
+    }
+
+    // Display ausente (NACK): limpa o estado de abort para a próxima transação
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        (void)hw->clr_tx_abrt;
+    }
+}
+
+static ssd1306_bus_t ssd1306_blocking_bus = {
+    .submit = ssd1306_blocking_submit,
+    .wait = ssd1306_blocking_wait,
+};
+
+static ssd1306_bus_t *ssd1306_active_bus = &ssd1306_blocking_bus;
+
+// Troca o transporte (por exemplo, para DMA) usado pelas funções síncronas
+void ssd1306_set_bus(ssd1306_bus_t *bus) {
+    ssd1306_bus_wait(ssd1306_active_bus);
+    ssd1306_active_bus = bus ? bus : &ssd1306_blocking_bus;
+}
+
+// Transporte em uso
+ssd1306_bus_t *ssd1306_get_bus(void) {
+    return ssd1306_active_bus;
+}
+
+// Envia a sequência montada e espera terminar
+static void ssd1306_sync_flush(void) {
+    ssd1306_bus_wait(ssd1306_active_bus);
+    ssd1306_bus_submit(ssd1306_active_bus, &ssd1306_sync_stream);
+    ssd1306_bus_wait(ssd1306_active_bus);
 }
 
 // Processo de escrita do i2c espera um byte de controle, seguido por dados
 void ssd1306_send_command(uint8_t command) {
-    uint8_t buffer[2] = {0x80, command};
-    i2c_write_blocking(i2c1, ssd1306_i2c_address, buffer, 2, false);
+    ssd1306_stream_reset(&ssd1306_sync_stream);
+    ssd1306_stream_commands(&ssd1306_sync_stream, &command, 1);
+    ssd1306_sync_flush();
 }
 
-// Envia uma lista de comandos ao hardware
+// Envia uma lista de comandos ao hardware numa única transação
 void ssd1306_send_command_list(uint8_t *ssd, int number) {
-    for (int i = 0; i < number; i++) {
-        ssd1306_send_command(ssd[i]);
+    while (number > 0) {
+        int chunk = number < ssd1306_stream_capacity - 1 ? number : ssd1306_stream_capacity - 1;
+
+        ssd1306_stream_reset(&ssd1306_sync_stream);
+        ssd1306_stream_commands(&ssd1306_sync_stream, ssd, chunk);
+        ssd1306_sync_flush();
+
+        ssd += chunk;
+        number -= chunk;
     }
 }
 
-// Copia buffer de referência num novo buffer, a fim de adicionar o byte de controle desde o início
+// Envia dados de GDDRAM; o byte de controle vai na própria sequência, sem cópia extra
 void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
-    uint8_t *temp_buffer = malloc(buffer_length + 1);
+    while (buffer_length > 0) {
+        int chunk = buffer_length < ssd1306_stream_capacity - 1 ? buffer_length : ssd1306_stream_capacity - 1;
 
-    temp_buffer[0] = 0x40;
-    memcpy(temp_buffer + 1, ssd, buffer_length);
+        ssd1306_stream_reset(&ssd1306_sync_stream);
+        ssd1306_stream_data(&ssd1306_sync_stream, ssd, chunk);
+        ssd1306_sync_flush();
 
-    i2c_write_blocking(i2c1, ssd1306_i2c_address, temp_buffer, buffer_length + 1, false);
-
-    free(temp_buffer);
+        ssd += chunk;
+        buffer_length -= chunk;
+    }
 }
 
 // Cria a lista de comandos (com base nos endereços definidos em ssd1306_i2c.h) para a inicialização do display
@@ -74,104 +136,17 @@ void ssd1306_scroll(bool set) {
     ssd1306_send_command_list(commands, count_of(commands));
 }
 
-// Atualiza uma parte do display com uma área de renderização
+// Atualiza uma parte do display com uma área de renderização (endereçamento e dados num só envio)
 void render_on_display(uint8_t *ssd, struct render_area *area) {
     uint8_t commands[] = {
         ssd1306_set_column_address, area->start_column, area->end_column,
         ssd1306_set_page_address, area->start_page, area->end_page
     };
 
-    ssd1306_send_command_list(commands, count_of(commands));
-    ssd1306_send_buffer(ssd, area->buffer_length);
-}
-
-// Determina o pixel a ser aceso (no display) de acordo com a coordenada fornecida
-void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set) {
-    assert(x >= 0 && x < ssd1306_width && y >= 0 && y < ssd1306_height);
-
-    const int bytes_per_row = ssd1306_width;
-
-    int byte_idx = (y / 8) * bytes_per_row + x;
-    uint8_t byte = ssd[byte_idx];
-
-    if (set) {
-        byte |= 1 << (y % 8);
-    }
-    else {
-        byte &= ~(1 << (y % 8));
-    }
-
-    ssd[byte_idx] = byte;
-}
-
-// Algoritmo de Bresenham básico
-void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set) {
-    int dx = abs(x_1 - x_0); // Deslocamentos
-    int dy = -abs(y_1 - y_0);
-    int sx = x_0 < x_1 ? 1 : -1; // Direção de avanço
-    int sy = y_0 < y_1 ? 1 : -1;
-    int error = dx + dy; // Erro acumulado
-    int error_2;
-
-    while (true) {
-        ssd1306_set_pixel(ssd, x_0, y_0, set); // Acende pixel no ponto atual
-        if (x_0 == x_1 && y_0 == y_1) {
-            break; // Verifica se o ponto final foi alcançado
-        }
-
-        error_2 = 2 * error; // Ajusta o erro acumulado
-
-        if (error_2 >= dy) {
-            error += dy;
-            x_0 += sx; // Avança na direção x
-        }
-        if (error_2 <= dx) {
-            error += dx;
-            y_0 += sy; // Avança na direção y
-        }
-    }
-}
-
-// Adquire os pixels para um caractere (de acordo com ssd1306_font.h)
-inline int ssd1306_get_font(uint8_t character)
-{
-  if (character >= 'A' && character <= 'Z') {
-    return character - 'A' + 1;
-  }
-  else if (character >= '0' && character <= '9') {
-    return character - '0' + 27;
-  }
-  else
-    return 0;
-}
-
-// Desenha um único caractere no display
-void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character) {
-    if (x > ssd1306_width - 8 || y > ssd1306_height - 8) {
-        return;
-    }
-
-    y = y / 8;
-
-    character = toupper(character);
-    int idx = ssd1306_get_font(character);
-    int fb_idx = y * 128 + x;
-
-    for (int i = 0; i < 8; i++) {
-        ssd[fb_idx++] = font[idx * 8 + i];
-    }
-}
-
-// Desenha uma string, chamando a função de desenhar caractere várias vezes
-void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, char *string) {
-    if (x > ssd1306_width - 8 || y > ssd1306_height - 8) {
-        return;
-    }
-
-    while (*string) {
-        ssd1306_draw_char(ssd, x, y, *string++);
-        x += 8;
-    }
+    ssd1306_stream_reset(&ssd1306_sync_stream);
+    ssd1306_stream_commands(&ssd1306_sync_stream, commands, count_of(commands));
+    ssd1306_stream_data(&ssd1306_sync_stream, ssd, area->buffer_length);
+    ssd1306_sync_flush();
 }
 
 // Comando de configuração com base na estrutura ssd1306_t
@@ -0,0 +1,104 @@
+#include <string.h>
+#include "ssd1306_stream.h"
+
+// Total de bytes entregues ao barramento I2C pelo driver
+uint32_t ssd1306_bytes_sent;
+
+// Verifica se cabem mais `words` palavras na sequência
+static bool ssd1306_stream_room(const ssd1306_stream_t *stream, size_t words) {
+    return stream->count + words <= ssd1306_stream_capacity;
+}
+
+// Esvazia a sequência para montar uma nova atualização
+void ssd1306_stream_reset(ssd1306_stream_t *stream) {
+    stream->count = 0;
+}
+
+// Acrescenta uma lista de comandos como uma única transação I2C
+bool ssd1306_stream_commands(ssd1306_stream_t *stream, const uint8_t *commands, int number) {
+    if (number <= 0 || !ssd1306_stream_room(stream, number + 1)) {
+        return false;
+    }
+
+    uint16_t *out = stream->words + stream->count;
+    *out++ = ssd1306_control_command;
+    for (int i = 0; i < number; i++) {
+        *out++ = commands[i];
+    }
+    out[-1] |= ssd1306_stream_stop;
+
+    stream->count += number + 1;
+    return true;
+}
+
+// Acrescenta dados de GDDRAM como uma única transação I2C
+bool ssd1306_stream_data(ssd1306_stream_t *stream, const uint8_t *data, int length) {
+    if (length <= 0 || !ssd1306_stream_room(stream, length + 1)) {
+        return false;
+    }
+
+    uint16_t *out = stream->words + stream->count;
+    *out++ = ssd1306_control_data;
+    for (int i = 0; i < length; i++) {
+        *out++ = data[i];
+    }
+    out[-1] |= ssd1306_stream_stop;
+
+    stream->count += length + 1;
+    return true;
+}
+
+// Acrescenta a rolagem de uma coluna para a esquerda dentro da área. A rolagem
+// contínua precisa estar desligada, e o controlador pede dois quadros de
+// intervalo entre duas rolagens seguidas
+bool ssd1306_stream_scroll_left(ssd1306_stream_t *stream, const struct render_area *area) {
+    uint8_t commands[] = {
+        ssd1306_scroll_column_left, 0x00, area->start_page, 0x01, area->end_page,
+        0x00, area->start_column, area->end_column
+    };
+    return ssd1306_stream_commands(stream, commands, sizeof(commands));
+}
+
+// Acrescenta o endereçamento e os dados de uma área, lidos do quadro inteiro
+// `ssd` página por página
+bool ssd1306_stream_area(ssd1306_stream_t *stream, const uint8_t *ssd, const struct render_area *area) {
+    int width = area->end_column - area->start_column + 1;
+    int pages = area->end_page - area->start_page + 1;
+
+    if (!ssd1306_stream_room(stream, 7 + 1 + width * pages)) {
+        return false;
+    }
+
+    uint8_t commands[] = {
+        ssd1306_set_column_address, area->start_column, area->end_column,
+        ssd1306_set_page_address, area->start_page, area->end_page
+    };
+    ssd1306_stream_commands(stream, commands, sizeof(commands));
+
+    uint16_t *out = stream->words + stream->count;
+    *out++ = ssd1306_control_data;
+    for (int page = area->start_page; page <= area->end_page; page++) {
+        const uint8_t *row = ssd + page * ssd1306_width + area->start_column;
+        for (int i = 0; i < width; i++) {
+            *out++ = row[i];
+        }
+    }
+    out[-1] |= ssd1306_stream_stop;
+
+    stream->count += width * pages + 1;
+    return true;
+}
+
+// Entrega a sequência ao transporte, que pode enviá-la em segundo plano
+void ssd1306_bus_submit(ssd1306_bus_t *bus, const ssd1306_stream_t *stream) {
+    if (stream->count == 0) {
+        return;
+    }
+    ssd1306_bytes_sent += stream->count;
+    bus->submit(bus, stream->words, stream->count);
+}
+
+// Aguarda o fim do envio anterior
+void ssd1306_bus_wait(ssd1306_bus_t *bus) {
+    bus->wait(bus);
+}
@@ -0,0 +1,43 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ssd1306_gfx.h"
+
+#ifndef ssd1306_stream_inc_h
+#define ssd1306_stream_inc_h
+
+// Uma atualização do display é descrita como uma sequência de palavras de 16
+// bits no formato do registrador IC_DATA_CMD do RP2040: byte nos bits 0-7 e
+// STOP no último byte de cada transação. O RP2040 replica escritas de 8 bits
+// nos periféricos, por isso o DMA precisa dessas palavras e não de bytes.
+#define ssd1306_stream_stop 0x200u
+
+#define ssd1306_control_command 0x00u
+#define ssd1306_control_data 0x40u
+
+// Quadro inteiro mais o endereçamento de até 16 áreas
+#define ssd1306_stream_capacity (ssd1306_buffer_length + 16 * 8)
+
+typedef struct {
+    uint16_t words[ssd1306_stream_capacity];
+    size_t count;
+} ssd1306_stream_t;
+
+// Transporte que leva a sequência até o display (I2C bloqueante, DMA ou mock)
+typedef struct ssd1306_bus {
+    void (*submit)(struct ssd1306_bus *bus, const uint16_t *words, size_t count);
+    void (*wait)(struct ssd1306_bus *bus);
+} ssd1306_bus_t;
+
+extern uint32_t ssd1306_bytes_sent;
+
+extern void ssd1306_stream_reset(ssd1306_stream_t *stream);
+extern bool ssd1306_stream_commands(ssd1306_stream_t *stream, const uint8_t *commands, int number);
+extern bool ssd1306_stream_data(ssd1306_stream_t *stream, const uint8_t *data, int length);
+extern bool ssd1306_stream_scroll_left(ssd1306_stream_t *stream, const struct render_area *area);
+extern bool ssd1306_stream_area(ssd1306_stream_t *stream, const uint8_t *ssd, const struct render_area *area);
+
+extern void ssd1306_bus_submit(ssd1306_bus_t *bus, const ssd1306_stream_t *stream);
+extern void ssd1306_bus_wait(ssd1306_bus_t *bus);
+
+#endif
@@ -0,0 +1,168 @@
+#include "audio_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AUDIO_BIAS 2048
+
+static uint32_t audio_le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t audio_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint8_t *audio_read_all(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *data = length > 0 ? malloc((size_t)length) : NULL;
+    if (!data || fread(data, 1, (size_t)length, f) != (size_t)length)
+    {
+        fprintf(stderr, "%s: cannot read\n", path);
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *size = (size_t)length;
+    return data;
+}
+
+static bool audio_file_store(audio_file_t *file, const uint8_t *data, size_t frames,
+                             unsigned stride, uint32_t rate)
+{
+    memset(file, 0, sizeof(*file));
+    file->pcm = malloc(frames * sizeof(int16_t));
+    if (!file->pcm || frames == 0)
+    {
+        free(file->pcm);
+        file->pcm = NULL;
+        return false;
+    }
+
+    for (size_t i = 0; i < frames; i++)
+    {
+        file->pcm[i] = (int16_t)audio_le16(data + i * stride);
+    }
+    file->frames = frames;
+    file->rate = rate;
+    audio_file_set_output_rate(file, rate);
+    return true;
+}
+
+bool audio_file_load_wav(audio_file_t *file, const char *path)
+{
+    size_t size;
+    uint8_t *data = audio_read_all(path, &size);
+    if (!data)
+    {
+        return false;
+    }
+
+    bool ok = false;
+    uint16_t channels = 0;
+    uint16_t bits = 0;
+    uint32_t rate = 0;
+
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0)
+    {
+        fprintf(stderr, "%s: not a WAV file\n", path);
+        goto done;
+    }
+
+    for (size_t offset = 12; offset + 8 <= size;)
+    {
+        uint32_t chunk = audio_le32(data + offset + 4);
+        const uint8_t *body = data + offset + 8;
+        if (chunk > size - offset - 8)
+        {
+            chunk = (uint32_t)(size - offset - 8);
+        }
+
+        if (memcmp(data + offset, "fmt ", 4) == 0 && chunk >= 16)
+        {
+            if (audio_le16(body) != 1)
+            {
+                fprintf(stderr, "%s: only PCM WAV is supported\n", path);
+                goto done;
+            }
+            channels = audio_le16(body + 2);
+            rate = audio_le32(body + 4);
+            bits = audio_le16(body + 14);
+        }
+        else if (memcmp(data + offset, "data", 4) == 0)
+        {
+            if (bits != 16 || channels == 0 || rate == 0)
+            {
+                fprintf(stderr, "%s: need 16-bit PCM before the data chunk\n", path);
+                goto done;
+            }
+            unsigned stride = 2u * channels;
+            ok = audio_file_store(file, body, chunk / stride, stride, rate);
+            goto done;
+        }
+
+        offset += 8 + chunk + (chunk & 1);
+    }
+    fprintf(stderr, "%s: no data chunk\n", path);
+
+done:
+    free(data);
+    return ok;
+}
+
+bool audio_file_load_raw(audio_file_t *file, const char *path, uint32_t rate)
+{
+    size_t size;
+    uint8_t *data = audio_read_all(path, &size);
+    if (!data)
+    {
+        return false;
+    }
+
+    bool ok = audio_file_store(file, data, size / 2, 2, rate);
+    free(data);
+    return ok;
+}
+
+void audio_file_set_output_rate(audio_file_t *file, uint32_t rate)
+{
+    file->step_q32 = rate ? ((uint64_t)file->rate << 32) / rate : 1ull << 32;
+}
+
+uint16_t audio_file_next(void *ctx)
+{
+    audio_file_t *file = ctx;
+    size_t index = (size_t)(file->position_q32 >> 32);
+
+    if (index >= file->frames)
+    {
+        file->position_q32 -= (uint64_t)file->frames << 32;
+        index -= file->frames;
+    }
+    file->position_q32 += file->step_q32;
+
+    // +-32768 onto +-2048 counts
+    int32_t value = AUDIO_BIAS + file->pcm[index] / 16;
+    return (uint16_t)(value < 0 ? 0 : value > 4095 ? 4095 : value);
+}
+
+void audio_file_free(audio_file_t *file)
+{
+    free(file->pcm);
+    memset(file, 0, sizeof(*file));
+}
@@ -0,0 +1,32 @@
+#ifndef AUDIO_FILE_H
+#define AUDIO_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Recorded audio played into the simulated microphone input. The file is
+// loaded whole, resampled to the ADC rate by sample and hold, mapped from
+// 16-bit PCM onto 12-bit ADC counts around mid-scale, and looped.
+typedef struct
+{
+    int16_t *pcm;
+    size_t frames;
+    uint32_t rate;
+
+    uint64_t step_q32;
+    uint64_t position_q32;
+} audio_file_t;
+
+// 16-bit PCM WAV, the first channel is used
+bool audio_file_load_wav(audio_file_t *file, const char *path);
+
+// Headerless signed 16-bit little-endian mono
+bool audio_file_load_raw(audio_file_t *file, const char *path, uint32_t rate);
+
+void audio_file_set_output_rate(audio_file_t *file, uint32_t rate);
+uint16_t audio_file_next(void *file);
+
+void audio_file_free(audio_file_t *file);
+
+#endif // AUDIO_FILE_H
@@ -0,0 +1,60 @@
+#include "fake_adc_dma.h"
+
+static void fake_adc_dma_service_irq(fake_adc_dma_t *fake)
+{
+    if (fake->irq_masked || !fake->irq_pending)
+    {
+        return;
+    }
+
+    unsigned filling = fake->cursor < fake->block_len ? 0 : 1;
+    capture_queue_on_irq(fake->queue, fake->irq_pending, filling);
+    fake->irq_pending = 0;
+}
+
+void fake_adc_dma_init(fake_adc_dma_t *fake, capture_queue_t *queue, uint16_t *buffer,
+                       uint32_t block_len, fake_adc_sample_fn next_sample, void *ctx)
+{
+    capture_queue_init(queue, buffer, block_len);
+
+    fake->queue = queue;
+    fake->buffer = buffer;
+    fake->block_len = block_len;
+    fake->cursor = 0;
+    fake->next_sample = next_sample;
+    fake->ctx = ctx;
+    fake->irq_masked = false;
+    fake->irq_pending = 0;
+    fake->samples_converted = 0;
+}
+
+void fake_adc_dma_run(fake_adc_dma_t *fake, uint32_t samples)
+{
+    while (samples--)
+    {
+        fake->buffer[fake->cursor++] = fake->next_sample(fake->ctx) & 0x0FFF;
+        fake->samples_converted++;
+
+        if (fake->cursor == fake->block_len || fake->cursor == 2 * fake->block_len)
+        {
+            unsigned half = fake->cursor == fake->block_len ? 0 : 1;
+            if (half)
+            {
+                fake->cursor = 0;
+            }
+            fake->irq_pending |= 1u << half;
+            fake_adc_dma_service_irq(fake);
+        }
+    }
+}
+
+void fake_adc_dma_mask_irq(fake_adc_dma_t *fake)
+{
+    fake->irq_masked = true;
+}
+
+void fake_adc_dma_unmask_irq(fake_adc_dma_t *fake)
+{
+    fake->irq_masked = false;
+    fake_adc_dma_service_irq(fake);
+}
@@ -0,0 +1,38 @@
+#ifndef FAKE_ADC_DMA_H
+#define FAKE_ADC_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "capture_queue.h"
+
+// Host stand-in for the free-running ADC feeding the two chained DMA
+// channels in src/capture.c. Samples land in the same buffer layout and
+// completions reach the capture queue through the same IRQ entry point,
+// including the collapsing of completions while the IRQ is masked.
+typedef uint16_t (*fake_adc_sample_fn)(void *ctx);
+
+typedef struct
+{
+    capture_queue_t *queue;
+    uint16_t *buffer;
+    uint32_t block_len;
+    uint32_t cursor;
+
+    fake_adc_sample_fn next_sample;
+    void *ctx;
+
+    bool irq_masked;
+    unsigned irq_pending;
+    uint64_t samples_converted;
+} fake_adc_dma_t;
+
+void fake_adc_dma_init(fake_adc_dma_t *fake, capture_queue_t *queue, uint16_t *buffer,
+                       uint32_t block_len, fake_adc_sample_fn next_sample, void *ctx);
+
+void fake_adc_dma_run(fake_adc_dma_t *fake, uint32_t samples);
+
+void fake_adc_dma_mask_irq(fake_adc_dma_t *fake);
+void fake_adc_dma_unmask_irq(fake_adc_dma_t *fake);
+
+#endif // FAKE_ADC_DMA_H
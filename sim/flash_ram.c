@@ -0,0 +1,85 @@
+#include "flash_ram.h"
+
+#include <assert.h>
+#include <string.h>
+
+// One byte write, false once the power is gone
+static bool flash_ram_spend(flash_ram_t *ram)
+{
+    if (ram->cut)
+    {
+        return false;
+    }
+    if (ram->budget == 0)
+    {
+        ram->cut = true;
+        return false;
+    }
+    if (ram->budget > 0)
+    {
+        ram->budget--;
+    }
+    return true;
+}
+
+static void flash_ram_erase(void *ctx, uint32_t offset)
+{
+    flash_ram_t *ram = ctx;
+    assert(offset % EVENT_LOG_SECTOR_SIZE == 0 && offset / EVENT_LOG_SECTOR_SIZE < ram->sectors);
+
+    if (!ram->cut)
+    {
+        ram->erase_counts[offset / EVENT_LOG_SECTOR_SIZE]++;
+    }
+    for (uint32_t i = 0; i < EVENT_LOG_SECTOR_SIZE && flash_ram_spend(ram); i++)
+    {
+        ram->bytes[offset + i] = 0xFF;
+    }
+}
+
+static void flash_ram_program(void *ctx, uint32_t offset, const uint8_t *page)
+{
+    flash_ram_t *ram = ctx;
+    assert(offset % EVENT_LOG_PAGE_SIZE == 0 && offset < ram->sectors * EVENT_LOG_SECTOR_SIZE);
+
+    if (!ram->cut)
+    {
+        ram->programs++;
+    }
+    for (uint32_t i = 0; i < EVENT_LOG_PAGE_SIZE && flash_ram_spend(ram); i++)
+    {
+        ram->bytes[offset + i] &= page[i];
+    }
+}
+
+void flash_ram_init(flash_ram_t *ram, uint8_t *bytes, uint32_t sectors)
+{
+    assert(sectors <= FLASH_RAM_MAX_SECTORS);
+
+    memset(ram, 0, sizeof(*ram));
+    ram->bytes = bytes;
+    ram->sectors = sectors;
+    ram->budget = -1;
+    memset(bytes, 0xFF, (size_t)sectors * EVENT_LOG_SECTOR_SIZE);
+}
+
+void flash_ram_attach(flash_ram_t *ram, event_log_flash_t *flash)
+{
+    *flash = (event_log_flash_t){
+        .base = ram->bytes,
+        .sectors = ram->sectors,
+        .erase = flash_ram_erase,
+        .program = flash_ram_program,
+        .ctx = ram};
+}
+
+void flash_ram_cut_after(flash_ram_t *ram, int64_t writes)
+{
+    ram->budget = writes;
+}
+
+void flash_ram_power_on(flash_ram_t *ram)
+{
+    ram->budget = -1;
+    ram->cut = false;
+}
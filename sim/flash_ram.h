@@ -0,0 +1,36 @@
+#ifndef FLASH_RAM_H
+#define FLASH_RAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "event_log.h"
+
+#define FLASH_RAM_MAX_SECTORS 64
+
+// NOR flash held in RAM: erase sets a sector to 0xFF, program can only
+// clear bits. Power can be cut after a given number of byte writes, which
+// leaves the operation in progress half done and ignores the ones after,
+// as a device losing power mid-write would.
+typedef struct
+{
+    uint8_t *bytes;
+    uint32_t sectors;
+    uint32_t erase_counts[FLASH_RAM_MAX_SECTORS];
+    uint32_t programs;
+
+    // Byte writes left before the cut, negative while powered for good
+    int64_t budget;
+    bool cut;
+} flash_ram_t;
+
+// bytes holds sectors * EVENT_LOG_SECTOR_SIZE and starts erased
+void flash_ram_init(flash_ram_t *ram, uint8_t *bytes, uint32_t sectors);
+
+// Fills in the event log view of this flash
+void flash_ram_attach(flash_ram_t *ram, event_log_flash_t *flash);
+
+void flash_ram_cut_after(flash_ram_t *ram, int64_t writes);
+void flash_ram_power_on(flash_ram_t *ram);
+
+#endif // FLASH_RAM_H
@@ -0,0 +1,41 @@
+#ifndef SIM_FREERTOS_CONFIG_H
+#define SIM_FREERTOS_CONFIG_H
+
+// The firmware's kernel configuration with the changes the POSIX port needs.
+// Tasks run as pthreads, so stacks must clear PTHREAD_STACK_MIN.
+
+#include <assert.h>
+
+#include "../../include/FreeRTOSConfig.h"
+
+// 1 ms ticks so the simulated hardware can deliver DMA blocks one at a time
+#undef configTICK_RATE_HZ
+#define configTICK_RATE_HZ 1000
+
+#undef configMINIMAL_STACK_SIZE
+#define configMINIMAL_STACK_SIZE 4096
+
+// The firmware's tasks stay static; the simulated hardware task comes from
+// the host heap
+#undef configSUPPORT_DYNAMIC_ALLOCATION
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+
+// Per-task CPU time, reported by noiseguard_sim on exit
+#undef configGENERATE_RUN_TIME_STATS
+#define configGENERATE_RUN_TIME_STATS 1
+#undef configUSE_TRACE_FACILITY
+#define configUSE_TRACE_FACILITY 1
+#undef configUSE_STATS_FORMATTING_FUNCTIONS
+#define configUSE_STATS_FORMATTING_FUNCTIONS 1
+
+unsigned long sim_run_time_counter(void);
+#undef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#undef portGET_RUN_TIME_COUNTER_VALUE
+#define portGET_RUN_TIME_COUNTER_VALUE() sim_run_time_counter()
+
+// Stage timings on the same host clock; simulated time only moves a
+// millisecond at a time
+#define PROFILE_CLOCK_US() ((uint32_t)sim_run_time_counter())
+
+#endif // SIM_FREERTOS_CONFIG_H
@@ -0,0 +1,51 @@
+#ifndef SIM_HARDWARE_I2C_H
+#define SIM_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+#define I2C_IC_DATA_CMD_STOP_BITS 0x200u
+#define I2C_IC_STATUS_ACTIVITY_BITS 0x01u
+#define I2C_IC_STATUS_TFNF_BITS 0x02u
+#define I2C_IC_STATUS_TFE_BITS 0x04u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x40u
+
+#define DREQ_I2C0_TX 32
+#define DREQ_I2C1_TX 34
+
+// Only the registers the firmware touches. CPU stores to data_cmd are not
+// seen by the model; display traffic reaches it through the DMA.
+typedef struct
+{
+    volatile uint32_t tar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t clr_tx_abrt;
+    volatile uint32_t enable;
+    volatile uint32_t status;
+} i2c_hw_t;
+
+typedef struct i2c_inst
+{
+    i2c_hw_t *hw;
+    uint baudrate;
+} i2c_inst_t;
+
+extern i2c_inst_t sim_i2c0_inst;
+extern i2c_inst_t sim_i2c1_inst;
+#define i2c0 (&sim_i2c0_inst)
+#define i2c1 (&sim_i2c1_inst)
+
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c)
+{
+    return i2c->hw;
+}
+
+static inline uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx)
+{
+    return (i2c == i2c1 ? DREQ_I2C1_TX : DREQ_I2C0_TX) + (is_tx ? 0 : 1);
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif // SIM_HARDWARE_I2C_H
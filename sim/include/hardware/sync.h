@@ -0,0 +1,18 @@
+#ifndef SIM_HARDWARE_SYNC_H
+#define SIM_HARDWARE_SYNC_H
+
+#include "pico/stdlib.h"
+
+// Simulated interrupts only run between ticks of the hardware task, so
+// there is nothing to mask
+static inline uint32_t save_and_disable_interrupts(void)
+{
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status)
+{
+    (void)status;
+}
+
+#endif // SIM_HARDWARE_SYNC_H
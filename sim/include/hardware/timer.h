@@ -0,0 +1,7 @@
+#ifndef SIM_HARDWARE_TIMER_H
+#define SIM_HARDWARE_TIMER_H
+
+// time_us_32 and friends live with the rest of the shims
+#include "pico/stdlib.h"
+
+#endif // SIM_HARDWARE_TIMER_H
@@ -0,0 +1,6 @@
+#ifndef SIM_PICO_BINARY_INFO_H
+#define SIM_PICO_BINARY_INFO_H
+
+#define bi_decl(...)
+
+#endif // SIM_PICO_BINARY_INFO_H
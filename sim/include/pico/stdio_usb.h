@@ -0,0 +1,22 @@
+#ifndef SIM_PICO_STDIO_USB_H
+#define SIM_PICO_STDIO_USB_H
+
+// USB serial port, backed by sim_hw_attach_usb. Only the members of the
+// driver the firmware calls directly are here.
+
+#include "pico/stdlib.h"
+
+#define PICO_ERROR_NO_DATA -3
+
+typedef struct stdio_driver
+{
+    void (*out_chars)(const char *buf, int len);
+    void (*out_flush)(void);
+    int (*in_chars)(char *buf, int len);
+} stdio_driver_t;
+
+extern stdio_driver_t stdio_usb;
+
+bool stdio_usb_connected(void);
+
+#endif // SIM_PICO_STDIO_USB_H
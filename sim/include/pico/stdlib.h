@@ -0,0 +1,67 @@
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+// Host stand-in for the parts of the Pico SDK the firmware uses, backed by
+// the peripheral model in sim/sim_hw.c. Signatures follow SDK 2.1.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef unsigned int uint;
+
+#define _u(x) x##u
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+// Flash is memory mapped from XIP_BASE; the simulator backs it with an array
+extern uint8_t sim_flash[];
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#define XIP_BASE ((uintptr_t)sim_flash)
+
+#define GPIO_IN false
+#define GPIO_OUT true
+
+enum gpio_function
+{
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+
+enum gpio_irq_level
+{
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+// One callback for every pin, as with the SDK's default GPIO handler; only
+// edge events are modelled
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+
+bool stdio_init_all(void);
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+void sleep_ms(uint32_t ms);
+
+static inline void tight_loop_contents(void)
+{
+}
+
+#endif // SIM_PICO_STDLIB_H
@@ -0,0 +1,109 @@
+#include "signal_gen.h"
+
+#include <math.h>
+
+#define SIGNAL_BIAS 2048
+#define SIGNAL_FULL_SCALE 4095
+
+// Bursts last 50 ms out of every 250 ms, driven 4x past full scale
+#define BURST_PERIOD_MS 250
+#define BURST_LENGTH_MS 50
+#define BURST_OVERDRIVE 4
+
+static const char *const signal_names[SIGNAL_KIND_COUNT] = {
+    "sine",
+    "noise",
+    "burst",
+};
+
+static int32_t signal_gen_noise(signal_gen_t *gen)
+{
+    // xorshift32, uniform over [-amplitude, amplitude]
+    uint32_t x = gen->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    gen->rng = x;
+    return (int32_t)(x % (2u * gen->amplitude + 1)) - gen->amplitude;
+}
+
+static double signal_gen_sine(signal_gen_t *gen)
+{
+    double value = sin(gen->phase);
+    gen->phase += 2.0 * M_PI * gen->frequency / gen->sample_rate;
+    if (gen->phase >= 2.0 * M_PI)
+    {
+        gen->phase -= 2.0 * M_PI;
+    }
+    return value;
+}
+
+void signal_gen_init(signal_gen_t *gen, signal_kind_t kind, uint32_t sample_rate,
+                     uint32_t frequency, int amplitude)
+{
+    gen->kind = kind;
+    gen->sample_rate = sample_rate;
+    gen->frequency = frequency;
+    gen->amplitude = amplitude;
+    gen->phase = 0.0;
+    gen->rng = 0x2545F491u;
+    gen->index = 0;
+}
+
+uint16_t signal_gen_next(void *ctx)
+{
+    signal_gen_t *gen = ctx;
+    int32_t value = SIGNAL_BIAS;
+
+    switch (gen->kind)
+    {
+    case SIGNAL_SINE:
+        value += (int32_t)lrint(gen->amplitude * signal_gen_sine(gen));
+        break;
+    case SIGNAL_WHITE_NOISE:
+        value += signal_gen_noise(gen);
+        break;
+    case SIGNAL_CLIPPED_BURST:
+    {
+        uint64_t period = (uint64_t)gen->sample_rate * BURST_PERIOD_MS / 1000;
+        uint64_t length = (uint64_t)gen->sample_rate * BURST_LENGTH_MS / 1000;
+        double tone = signal_gen_sine(gen);
+        if (gen->index % period < length)
+        {
+            value += (int32_t)lrint(BURST_OVERDRIVE * gen->amplitude * tone);
+        }
+        else
+        {
+            value += signal_gen_noise(gen) / 16;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    gen->index++;
+
+    if (value < 0)
+    {
+        value = 0;
+    }
+    else if (value > SIGNAL_FULL_SCALE)
+    {
+        value = SIGNAL_FULL_SCALE;
+    }
+    return (uint16_t)value;
+}
+
+void signal_gen_fill(signal_gen_t *gen, uint16_t *samples, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        samples[i] = signal_gen_next(gen);
+    }
+}
+
+const char *signal_gen_name(signal_kind_t kind)
+{
+    return kind < SIGNAL_KIND_COUNT ? signal_names[kind] : "?";
+}
@@ -0,0 +1,34 @@
+#ifndef SIGNAL_GEN_H
+#define SIGNAL_GEN_H
+
+#include <stdint.h>
+
+// Synthetic microphone signals as raw 12-bit ADC samples around mid-scale
+typedef enum
+{
+    SIGNAL_SINE,
+    SIGNAL_WHITE_NOISE,
+    SIGNAL_CLIPPED_BURST,
+    SIGNAL_KIND_COUNT
+} signal_kind_t;
+
+typedef struct
+{
+    signal_kind_t kind;
+    uint32_t sample_rate;
+    uint32_t frequency;
+    int amplitude;
+    double phase;
+    uint32_t rng;
+    uint64_t index;
+} signal_gen_t;
+
+void signal_gen_init(signal_gen_t *gen, signal_kind_t kind, uint32_t sample_rate,
+                     uint32_t frequency, int amplitude);
+
+uint16_t signal_gen_next(void *gen);
+void signal_gen_fill(signal_gen_t *gen, uint16_t *samples, uint32_t count);
+
+const char *signal_gen_name(signal_kind_t kind);
+
+#endif // SIGNAL_GEN_H
@@ -0,0 +1,871 @@
+#include "sim_hw.h"
+
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "pico/stdio_usb.h"
+#include "pico/stdlib.h"
+
+#include <assert.h>
+
+#define SIM_ADC_CLOCK_HZ 48000000u
+#define SIM_ADC_FIFO_DEPTH 4
+#define SIM_I2C_BITS_PER_BYTE 9
+#define SIM_IRQ_COUNT 32
+#define SIM_IRQ_MAX_HANDLERS 4
+#define SIM_USB_HOST_BUFFER 64
+
+typedef struct
+{
+    bool claimed;
+    bool busy;
+    bool irq_enabled[2];
+    bool irq_status[2];
+    dma_channel_config config;
+    uintptr_t read_addr;
+    uintptr_t write_addr;
+    uint32_t remaining;
+    uint32_t reload;
+} sim_dma_channel_t;
+
+typedef struct
+{
+    uint64_t now_us;
+    sim_hw_stats_t stats;
+
+    bool gpio_out[SIM_HW_GPIO_COUNT];
+    bool gpio_level[SIM_HW_GPIO_COUNT];
+    bool gpio_input[SIM_HW_GPIO_COUNT];
+    bool gpio_pull_up[SIM_HW_GPIO_COUNT];
+    bool gpio_input_set[SIM_HW_GPIO_COUNT];
+    uint32_t gpio_irq_mask[SIM_HW_GPIO_COUNT];
+    gpio_irq_callback_t gpio_callback;
+
+    // Contact bounce in progress: the line flips at bounce_flip_us until
+    // bounce_end_us, then rests at bounce_level
+    uint64_t bounce_end_us[SIM_HW_GPIO_COUNT];
+    uint64_t bounce_flip_us[SIM_HW_GPIO_COUNT];
+    bool bounce_level[SIM_HW_GPIO_COUNT];
+    unsigned bouncing;
+    uint32_t bounce_seed;
+
+    sim_hw_adc_source_fn adc_source[SIM_HW_ADC_INPUTS];
+    void *adc_ctx[SIM_HW_ADC_INPUTS];
+    unsigned adc_input;
+    unsigned adc_rr_mask;
+    bool adc_running;
+    bool adc_fifo_dreq;
+    float adc_clkdiv;
+    uint64_t adc_phase;
+    uint16_t adc_fifo[SIM_ADC_FIFO_DEPTH];
+    unsigned adc_fifo_level;
+
+    sim_dma_channel_t dma[NUM_DMA_CHANNELS];
+
+    irq_handler_t irq_handlers[SIM_IRQ_COUNT][SIM_IRQ_MAX_HANDLERS];
+    unsigned irq_handler_count[SIM_IRQ_COUNT];
+    bool irq_enabled[SIM_IRQ_COUNT];
+    bool in_irq;
+    bool dma_irq_pending;
+
+    uint64_t i2c_phase;
+    uint16_t i2c_words[ssd1306_stream_capacity];
+    uint32_t i2c_word_count;
+    ssd1306_bus_mock_t *panel;
+    sim_hw_frame_fn frame;
+    void *frame_ctx;
+
+    sim_hw_usb_fn usb_receive;
+    void *usb_ctx;
+    // Host to device bytes: head moves on the simulator side, tail on the
+    // firmware side
+    char usb_host[SIM_USB_HOST_BUFFER];
+    volatile uint32_t usb_head;
+    volatile uint32_t usb_tail;
+} sim_hw_t;
+
+static sim_hw_t sim;
+
+// Memory-mapped flash contents, see sim_hw_load_flash
+uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+
+static i2c_hw_t sim_i2c_regs[2] = {
+    {.status = I2C_IC_STATUS_TFE_BITS | I2C_IC_STATUS_TFNF_BITS},
+    {.status = I2C_IC_STATUS_TFE_BITS | I2C_IC_STATUS_TFNF_BITS},
+};
+
+adc_hw_t sim_adc_hw;
+i2c_inst_t sim_i2c0_inst = {.hw = &sim_i2c_regs[0]};
+i2c_inst_t sim_i2c1_inst = {.hw = &sim_i2c_regs[1]};
+
+// ---- simulator side ----
+
+void sim_hw_set_adc_source(unsigned input, sim_hw_adc_source_fn source, void *ctx)
+{
+    if (input < SIM_HW_ADC_INPUTS)
+    {
+        sim.adc_source[input] = source;
+        sim.adc_ctx[input] = ctx;
+    }
+}
+
+static void sim_gpio_change(unsigned gpio, bool level)
+{
+    bool was = gpio_get(gpio);
+    sim.gpio_input[gpio] = level;
+    sim.gpio_input_set[gpio] = true;
+
+    uint32_t event = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if (level == was || sim.gpio_out[gpio] || !(sim.gpio_irq_mask[gpio] & event) || !sim.gpio_callback ||
+        sim.in_irq)
+    {
+        return;
+    }
+    sim.in_irq = true;
+    sim.gpio_callback(gpio, event);
+    sim.in_irq = false;
+    sim.stats.gpio_edges++;
+}
+
+void sim_hw_set_gpio_input(unsigned gpio, bool level)
+{
+    if (gpio < SIM_HW_GPIO_COUNT)
+    {
+        if (sim.bounce_end_us[gpio])
+        {
+            sim.bounce_end_us[gpio] = 0;
+            sim.bouncing--;
+        }
+        sim_gpio_change(gpio, level);
+    }
+}
+
+// 20 to 400 us between flips
+static uint32_t sim_bounce_gap_us(void)
+{
+    sim.bounce_seed = sim.bounce_seed * 1664525u + 1013904223u;
+    return 20 + (sim.bounce_seed >> 16) % 381;
+}
+
+void sim_hw_bounce_gpio_input(unsigned gpio, bool level, uint32_t bounce_us)
+{
+    if (gpio >= SIM_HW_GPIO_COUNT || bounce_us == 0)
+    {
+        sim_hw_set_gpio_input(gpio, level);
+        return;
+    }
+    if (!sim.bounce_end_us[gpio])
+    {
+        sim.bouncing++;
+    }
+    sim.bounce_end_us[gpio] = sim.now_us + bounce_us;
+    sim.bounce_flip_us[gpio] = sim.now_us;
+    sim.bounce_level[gpio] = level;
+}
+
+static void sim_bounce_step(void)
+{
+    for (unsigned gpio = 0; gpio < SIM_HW_GPIO_COUNT; gpio++)
+    {
+        if (!sim.bounce_end_us[gpio] || sim.now_us < sim.bounce_flip_us[gpio])
+        {
+            continue;
+        }
+        if (sim.now_us >= sim.bounce_end_us[gpio])
+        {
+            sim.bounce_end_us[gpio] = 0;
+            sim.bouncing--;
+            sim_gpio_change(gpio, sim.bounce_level[gpio]);
+            continue;
+        }
+        sim_gpio_change(gpio, !gpio_get(gpio));
+        sim.bounce_flip_us[gpio] = sim.now_us + sim_bounce_gap_us();
+    }
+}
+
+bool sim_hw_gpio_output(unsigned gpio)
+{
+    return gpio < SIM_HW_GPIO_COUNT && sim.gpio_level[gpio];
+}
+
+void sim_hw_attach_panel(ssd1306_bus_mock_t *panel, sim_hw_frame_fn frame, void *ctx)
+{
+    sim.panel = panel;
+    sim.frame = frame;
+    sim.frame_ctx = ctx;
+}
+
+static uint32_t sim_adc_rate(void)
+{
+    // One conversion every 1 + div ADC clocks, never faster than 96 clocks
+    float period = 1.0f + sim.adc_clkdiv;
+    if (period < 96.0f)
+    {
+        period = 96.0f;
+    }
+    return (uint32_t)(SIM_ADC_CLOCK_HZ / period);
+}
+
+uint32_t sim_hw_adc_channel_rate(void)
+{
+    unsigned inputs = sim.adc_rr_mask ? (unsigned)__builtin_popcount(sim.adc_rr_mask) : 1;
+    return sim_adc_rate() / inputs;
+}
+
+uint64_t sim_hw_now_us(void)
+{
+    return sim.now_us;
+}
+
+const sim_hw_stats_t *sim_hw_stats(void)
+{
+    return &sim.stats;
+}
+
+// ---- interrupts ----
+
+static void sim_irq_raise(unsigned irq)
+{
+    if (!sim.irq_enabled[irq] || sim.in_irq)
+    {
+        return;
+    }
+
+    sim.in_irq = true;
+    for (unsigned i = 0; i < sim.irq_handler_count[irq]; i++)
+    {
+        sim.irq_handlers[irq][i]();
+    }
+    sim.in_irq = false;
+    sim.stats.dma_irqs++;
+}
+
+static void sim_dma_raise_pending(void)
+{
+    sim.dma_irq_pending = false;
+    for (unsigned line = 0; line < 2; line++)
+    {
+        for (unsigned ch = 0; ch < NUM_DMA_CHANNELS; ch++)
+        {
+            if (sim.dma[ch].irq_status[line])
+            {
+                sim_irq_raise(line ? DMA_IRQ_1 : DMA_IRQ_0);
+                break;
+            }
+        }
+    }
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority)
+{
+    (void)order_priority;
+    if (num < SIM_IRQ_COUNT && sim.irq_handler_count[num] < SIM_IRQ_MAX_HANDLERS)
+    {
+        sim.irq_handlers[num][sim.irq_handler_count[num]++] = handler;
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    if (num < SIM_IRQ_COUNT)
+    {
+        sim.irq_enabled[num] = enabled;
+    }
+}
+
+// ---- DMA ----
+
+static void sim_dma_trigger(uint channel)
+{
+    sim_dma_channel_t *dma = &sim.dma[channel];
+    dma->busy = true;
+    dma->remaining = dma->reload;
+}
+
+static void sim_dma_complete(uint channel)
+{
+    sim_dma_channel_t *dma = &sim.dma[channel];
+    dma->busy = false;
+
+    for (unsigned line = 0; line < 2; line++)
+    {
+        if (dma->irq_enabled[line])
+        {
+            dma->irq_status[line] = true;
+            sim.dma_irq_pending = true;
+        }
+    }
+    if (dma->config.chain_to != channel)
+    {
+        sim_dma_trigger(dma->config.chain_to);
+    }
+}
+
+static uintptr_t sim_dma_step_addr(uintptr_t addr, unsigned size, bool ring, unsigned ring_bits)
+{
+    if (!ring || ring_bits == 0)
+    {
+        return addr + size;
+    }
+    uintptr_t mask = ((uintptr_t)1 << ring_bits) - 1;
+    return (addr & ~mask) | ((addr + size) & mask);
+}
+
+// Moves one item on a channel; the caller supplies or consumes the value
+static uint32_t sim_dma_transfer(uint channel, uint32_t value, bool from_peripheral)
+{
+    sim_dma_channel_t *dma = &sim.dma[channel];
+    unsigned size = 1u << dma->config.size;
+
+    if (from_peripheral)
+    {
+        void *dst = (void *)dma->write_addr;
+        if (size == 1)
+        {
+            *(uint8_t *)dst = (uint8_t)value;
+        }
+        else if (size == 2)
+        {
+            *(uint16_t *)dst = (uint16_t)value;
+        }
+        else
+        {
+            *(uint32_t *)dst = value;
+        }
+    }
+    else
+    {
+        const void *src = (const void *)dma->read_addr;
+        value = size == 1 ? *(const uint8_t *)src : size == 2 ? *(const uint16_t *)src : *(const uint32_t *)src;
+    }
+
+    if (dma->config.read_increment)
+    {
+        dma->read_addr = sim_dma_step_addr(dma->read_addr, size, !dma->config.ring_write, dma->config.ring_size_bits);
+    }
+    if (dma->config.write_increment)
+    {
+        dma->write_addr = sim_dma_step_addr(dma->write_addr, size, dma->config.ring_write, dma->config.ring_size_bits);
+    }
+
+    if (--dma->remaining == 0)
+    {
+        sim_dma_complete(channel);
+    }
+    return value;
+}
+
+static int sim_dma_find_paced(uint dreq)
+{
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++)
+    {
+        if (sim.dma[ch].busy && sim.dma[ch].config.dreq == dreq)
+        {
+            return (int)ch;
+        }
+    }
+    return -1;
+}
+
+int dma_claim_unused_channel(bool required)
+{
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++)
+    {
+        if (!sim.dma[ch].claimed)
+        {
+            sim.dma[ch].claimed = true;
+            return (int)ch;
+        }
+    }
+    if (required)
+    {
+        fprintf(stderr, "sim: no free DMA channel\n");
+        abort();
+    }
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    return (dma_channel_config){
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .dreq = DREQ_FORCE,
+        .chain_to = channel,
+    };
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    c->write_increment = incr;
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits)
+{
+    c->ring_write = write;
+    c->ring_size_bits = size_bits;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+    c->dreq = dreq;
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to)
+{
+    c->chain_to = chain_to;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    sim_dma_channel_t *dma = &sim.dma[channel];
+    dma->config = *config;
+    dma->write_addr = (uintptr_t)write_addr;
+    dma->read_addr = (uintptr_t)read_addr;
+    dma->reload = transfer_count;
+    if (trigger)
+    {
+        dma_channel_start(channel);
+    }
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr,
+                                          uint32_t transfer_count)
+{
+    sim.dma[channel].read_addr = (uintptr_t)read_addr;
+    sim.dma[channel].reload = transfer_count;
+    dma_channel_start(channel);
+}
+
+void dma_channel_start(uint channel)
+{
+    sim_dma_trigger(channel);
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+    return sim.dma[channel].busy;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled)
+{
+    sim.dma[channel].irq_enabled[0] = enabled;
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled)
+{
+    sim.dma[channel].irq_enabled[1] = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel)
+{
+    return sim.dma[channel].irq_status[0];
+}
+
+bool dma_channel_get_irq1_status(uint channel)
+{
+    return sim.dma[channel].irq_status[1];
+}
+
+void dma_channel_acknowledge_irq0(uint channel)
+{
+    sim.dma[channel].irq_status[0] = false;
+}
+
+void dma_channel_acknowledge_irq1(uint channel)
+{
+    sim.dma[channel].irq_status[1] = false;
+}
+
+// ---- ADC ----
+
+static uint16_t sim_adc_convert(void)
+{
+    unsigned input = sim.adc_input;
+    uint16_t value = sim.adc_source[input] ? sim.adc_source[input](sim.adc_ctx[input]) : 2048;
+
+    // Round robin moves on to the next enabled input after every conversion
+    if (sim.adc_rr_mask)
+    {
+        do
+        {
+            input = (input + 1) % SIM_HW_ADC_INPUTS;
+        } while (!(sim.adc_rr_mask & (1u << input)));
+        sim.adc_input = input;
+    }
+
+    sim.stats.adc_conversions++;
+    return value & 0xFFF;
+}
+
+static void sim_adc_push(uint16_t value)
+{
+    if (sim.adc_fifo_level == SIM_ADC_FIFO_DEPTH)
+    {
+        sim.stats.adc_overflows++;
+        return;
+    }
+    sim.adc_fifo[sim.adc_fifo_level++] = value;
+
+    int channel = sim.adc_fifo_dreq ? sim_dma_find_paced(DREQ_ADC) : -1;
+    while (channel >= 0 && sim.adc_fifo_level > 0)
+    {
+        sim_dma_transfer(channel, sim.adc_fifo[0], true);
+        sim.adc_fifo_level--;
+        memmove(sim.adc_fifo, sim.adc_fifo + 1, sim.adc_fifo_level * sizeof(sim.adc_fifo[0]));
+        channel = sim_dma_find_paced(DREQ_ADC);
+    }
+}
+
+void adc_init(void)
+{
+    sim.adc_input = 0;
+    sim.adc_rr_mask = 0;
+    sim.adc_running = false;
+    sim.adc_fifo_level = 0;
+}
+
+void adc_gpio_init(uint gpio)
+{
+    (void)gpio;
+}
+
+void adc_select_input(uint input)
+{
+    sim.adc_input = input % SIM_HW_ADC_INPUTS;
+}
+
+uint adc_get_selected_input(void)
+{
+    return sim.adc_input;
+}
+
+void adc_set_round_robin(uint input_mask)
+{
+    sim.adc_rr_mask = input_mask & ((1u << SIM_HW_ADC_INPUTS) - 1);
+}
+
+uint16_t adc_read(void)
+{
+    return sim_adc_convert();
+}
+
+void adc_run(bool run)
+{
+    sim.adc_running = run;
+}
+
+void adc_set_clkdiv(float clkdiv)
+{
+    sim.adc_clkdiv = clkdiv;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift)
+{
+    (void)en;
+    (void)dreq_thresh;
+    (void)err_in_fifo;
+    (void)byte_shift;
+    sim.adc_fifo_dreq = dreq_en;
+}
+
+void adc_fifo_drain(void)
+{
+    sim.adc_fifo_level = 0;
+}
+
+// ---- flash ----
+
+bool sim_hw_load_flash(const char *path)
+{
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    if (!path)
+    {
+        return true;
+    }
+
+    // A missing image is a new device
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        return true;
+    }
+    size_t read = fread(sim_flash, 1, sizeof(sim_flash), f);
+    fclose(f);
+    if (read != sizeof(sim_flash))
+    {
+        fprintf(stderr, "%s: not a %u byte flash image\n", path, (unsigned)sizeof(sim_flash));
+        return false;
+    }
+    return true;
+}
+
+bool sim_hw_save_flash(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        perror(path);
+        return false;
+    }
+    bool ok = fwrite(sim_flash, 1, sizeof(sim_flash), f) == sizeof(sim_flash);
+    return fclose(f) == 0 && ok;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    assert(flash_offs % FLASH_SECTOR_SIZE == 0 && count % FLASH_SECTOR_SIZE == 0);
+    assert(flash_offs + count <= sizeof(sim_flash));
+    memset(sim_flash + flash_offs, 0xFF, count);
+    sim.stats.flash_erases += count / FLASH_SECTOR_SIZE;
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    assert(flash_offs % FLASH_PAGE_SIZE == 0 && count % FLASH_PAGE_SIZE == 0);
+    assert(flash_offs + count <= sizeof(sim_flash));
+    for (size_t i = 0; i < count; i++)
+    {
+        sim_flash[flash_offs + i] &= data[i];
+    }
+    sim.stats.flash_pages += count / FLASH_PAGE_SIZE;
+}
+
+// ---- USB serial ----
+
+void sim_hw_attach_usb(sim_hw_usb_fn receive, void *ctx)
+{
+    sim.usb_receive = receive;
+    sim.usb_ctx = ctx;
+}
+
+bool sim_hw_usb_send(const char *bytes, size_t len)
+{
+    if (len > SIM_USB_HOST_BUFFER - (sim.usb_head - sim.usb_tail))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        sim.usb_host[(sim.usb_head + i) % SIM_USB_HOST_BUFFER] = bytes[i];
+    }
+    sim.usb_head += len;
+    return true;
+}
+
+bool stdio_usb_connected(void)
+{
+    return sim.usb_receive != NULL;
+}
+
+static void sim_usb_out_chars(const char *buf, int len)
+{
+    if (sim.usb_receive)
+    {
+        sim.stats.usb_bytes += len;
+        sim.usb_receive((const uint8_t *)buf, (size_t)len, sim.usb_ctx);
+    }
+}
+
+static int sim_usb_in_chars(char *buf, int len)
+{
+    int count = 0;
+    while (count < len && sim.usb_tail != sim.usb_head)
+    {
+        buf[count++] = sim.usb_host[sim.usb_tail++ % SIM_USB_HOST_BUFFER];
+    }
+    return count > 0 ? count : PICO_ERROR_NO_DATA;
+}
+
+stdio_driver_t stdio_usb = {
+    .out_chars = sim_usb_out_chars,
+    .in_chars = sim_usb_in_chars,
+};
+
+// ---- I2C ----
+
+static void sim_i2c_word(uint16_t word)
+{
+    sim.stats.i2c_bytes++;
+    if (sim.i2c_word_count < ssd1306_stream_capacity)
+    {
+        sim.i2c_words[sim.i2c_word_count++] = word;
+    }
+
+    if ((word & I2C_IC_DATA_CMD_STOP_BITS) && sim.panel)
+    {
+        sim.panel->bus.submit(&sim.panel->bus, sim.i2c_words, sim.i2c_word_count);
+        ssd1306_bus_mock_clear_log(sim.panel);
+    }
+    if (word & I2C_IC_DATA_CMD_STOP_BITS)
+    {
+        sim.i2c_word_count = 0;
+    }
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)i2c;
+    (void)addr;
+    (void)src;
+    (void)nostop;
+    return (int)len;
+}
+
+// ---- GPIO and time ----
+
+void gpio_init(uint gpio)
+{
+    sim.gpio_out[gpio] = false;
+    sim.gpio_level[gpio] = false;
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    sim.gpio_out[gpio] = out;
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    sim.gpio_level[gpio] = value;
+}
+
+bool gpio_get(uint gpio)
+{
+    if (sim.gpio_out[gpio])
+    {
+        return sim.gpio_level[gpio];
+    }
+    return sim.gpio_input_set[gpio] ? sim.gpio_input[gpio] : sim.gpio_pull_up[gpio];
+}
+
+void gpio_pull_up(uint gpio)
+{
+    sim.gpio_pull_up[gpio] = true;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+    (void)gpio;
+    (void)fn;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled)
+{
+    if (enabled)
+    {
+        sim.gpio_irq_mask[gpio] |= event_mask;
+    }
+    else
+    {
+        sim.gpio_irq_mask[gpio] &= ~event_mask;
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback)
+{
+    sim.gpio_callback = callback;
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+}
+
+bool stdio_init_all(void)
+{
+    return true;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)sim.now_us;
+}
+
+uint64_t time_us_64(void)
+{
+    return sim.now_us;
+}
+
+void sleep_ms(uint32_t ms)
+{
+    sim_hw_advance(ms * 1000u);
+}
+
+// ---- time base ----
+
+void sim_hw_advance(uint32_t us)
+{
+    uint64_t adc_rate = sim_adc_rate();
+    uint64_t i2c_rate = sim_i2c1_inst.baudrate / SIM_I2C_BITS_PER_BYTE;
+
+    // Display transfers are only started from task context, between calls
+    int i2c_channel = sim_dma_find_paced(i2c_get_dreq(i2c1, true));
+    if (i2c_channel < 0)
+    {
+        sim.i2c_phase = 0;
+    }
+
+    // Step one microsecond at a time so ADC and I2C events interleave in the
+    // order they would on the chip
+    for (uint32_t t = 0; t < us; t++)
+    {
+        sim.now_us++;
+
+        if (sim.adc_running)
+        {
+            sim.adc_phase += adc_rate;
+            while (sim.adc_phase >= 1000000u)
+            {
+                sim.adc_phase -= 1000000u;
+                sim_adc_push(sim_adc_convert());
+            }
+        }
+
+        if (i2c_channel >= 0)
+        {
+            sim.i2c_phase += i2c_rate;
+            while (sim.i2c_phase >= 1000000u && sim.dma[i2c_channel].busy)
+            {
+                sim.i2c_phase -= 1000000u;
+                sim_i2c_word((uint16_t)sim_dma_transfer(i2c_channel, 0, false));
+            }
+            if (!sim.dma[i2c_channel].busy)
+            {
+                i2c_channel = -1;
+                sim.i2c_phase = 0;
+                sim.stats.panel_frames++;
+                if (sim.frame && sim.panel)
+                {
+                    sim.frame(sim.panel, sim.frame_ctx);
+                }
+            }
+        }
+
+        if (sim.dma_irq_pending)
+        {
+            sim_dma_raise_pending();
+        }
+
+        if (sim.bouncing)
+        {
+            sim_bounce_step();
+        }
+    }
+}
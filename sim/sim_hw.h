@@ -0,0 +1,70 @@
+#ifndef SIM_HW_H
+#define SIM_HW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ssd1306_bus_mock.h"
+
+// Peripheral model behind the Pico SDK shims in sim/include. Time only moves
+// when sim_hw_advance is called: the ADC converts at the rate set by
+// adc_set_clkdiv, paced DMA channels move one item per conversion or per
+// I2C byte time, and DMA interrupts run their handlers on the caller's
+// stack as an ISR would.
+
+#define SIM_HW_GPIO_COUNT 30
+#define SIM_HW_ADC_INPUTS 5
+
+typedef uint16_t (*sim_hw_adc_source_fn)(void *ctx);
+typedef void (*sim_hw_frame_fn)(const ssd1306_bus_mock_t *panel, void *ctx);
+typedef void (*sim_hw_usb_fn)(const uint8_t *bytes, size_t len, void *ctx);
+
+typedef struct
+{
+    uint64_t adc_conversions;
+    uint64_t adc_overflows;
+    uint64_t dma_irqs;
+    uint64_t i2c_bytes;
+    uint64_t panel_frames;
+    uint64_t flash_erases;
+    uint64_t flash_pages;
+    uint64_t usb_bytes;
+    uint64_t gpio_edges;
+} sim_hw_stats_t;
+
+void sim_hw_set_adc_source(unsigned input, sim_hw_adc_source_fn source, void *ctx);
+
+// Level seen by gpio_get when the pin is not driven by the firmware. A
+// change raises the pin's edge interrupt if it is enabled.
+void sim_hw_set_gpio_input(unsigned gpio, bool level);
+
+// Same, but the contact chatters for bounce_us first, flipping the line at
+// irregular intervals of a few hundred microseconds
+void sim_hw_bounce_gpio_input(unsigned gpio, bool level, uint32_t bounce_us);
+bool sim_hw_gpio_output(unsigned gpio);
+
+// DMA traffic to the I2C data register lands in the panel model; frame is
+// called each time a DMA display transfer completes
+void sim_hw_attach_panel(ssd1306_bus_mock_t *panel, sim_hw_frame_fn frame, void *ctx);
+
+// Conversions per second on one input, given the current round-robin mask
+uint32_t sim_hw_adc_channel_rate(void);
+
+// A host on the USB serial port: the port reads as connected once one is
+// attached, and everything the firmware writes goes to it. Bytes sent by
+// the host wait for the firmware to read them; false when there is no room.
+void sim_hw_attach_usb(sim_hw_usb_fn receive, void *ctx);
+bool sim_hw_usb_send(const char *bytes, size_t len);
+
+// Flash starts blank (all 0xFF), or from an image saved by an earlier run
+// so the event log and calibration carry over; a missing file is blank
+bool sim_hw_load_flash(const char *path);
+bool sim_hw_save_flash(const char *path);
+
+void sim_hw_advance(uint32_t us);
+uint64_t sim_hw_now_us(void);
+
+const sim_hw_stats_t *sim_hw_stats(void);
+
+#endif // SIM_HW_H
@@ -0,0 +1,422 @@
+#include "audio_file.h"
+#include "capture.h"
+#include "display.h"
+#include "events.h"
+#include "latency.h"
+#include "peripherals.h"
+#include "signal_gen.h"
+#include "sim_hw.h"
+#include "sim_script.h"
+#include "ssd1306_bus_mock.h"
+#include "telemetry_usb.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_HW_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#define SIM_DEFAULT_DURATION_MS 10000
+#define SIM_RUN_TIME_STATS_LENGTH 2048
+
+// src/main.c, renamed by the build so the simulator can wrap it
+int noiseguard_main(void);
+
+typedef struct
+{
+    uint32_t duration_ms;
+    const char *script_path;
+    const char *wav_path;
+    const char *raw_path;
+    uint32_t raw_rate;
+    const char *frames_dir;
+    const char *flash_path;
+    const char *telemetry_path;
+} sim_options_t;
+
+static sim_options_t options = {
+    .duration_ms = SIM_DEFAULT_DURATION_MS,
+    .raw_rate = 48000,
+};
+
+static sim_script_t script;
+static signal_gen_t generator;
+static audio_file_t recording;
+static bool playing_recording;
+static uint32_t mic_rate;
+static uint16_t joystick_x = 2048;
+
+static ssd1306_bus_mock_t panel;
+static FILE *frame_index;
+static uint32_t frames_written;
+static int led_state = -1;
+static FILE *telemetry_capture;
+
+unsigned long sim_run_time_counter(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000000ul + ts.tv_nsec / 1000;
+}
+
+static uint32_t sim_now_ms(void)
+{
+    return (uint32_t)(sim_hw_now_us() / 1000);
+}
+
+static uint16_t sim_mic_sample(void *ctx)
+{
+    (void)ctx;
+    return playing_recording ? audio_file_next(&recording) : signal_gen_next(&generator);
+}
+
+static uint16_t sim_joystick_sample(void *ctx)
+{
+    (void)ctx;
+    return joystick_x;
+}
+
+// Sources follow the per-input rate, which changes once capture turns on round robin
+static void sim_update_mic_rate(void)
+{
+    uint32_t rate = sim_hw_adc_channel_rate();
+    if (rate != mic_rate)
+    {
+        mic_rate = rate;
+        generator.sample_rate = rate;
+        if (recording.pcm)
+        {
+            audio_file_set_output_rate(&recording, rate);
+        }
+    }
+}
+
+static bool sim_play_recording(const char *path, bool raw)
+{
+    audio_file_t file;
+    bool loaded = raw ? audio_file_load_raw(&file, path, options.raw_rate)
+                      : audio_file_load_wav(&file, path);
+    if (!loaded)
+    {
+        return false;
+    }
+
+    audio_file_free(&recording);
+    recording = file;
+    audio_file_set_output_rate(&recording, mic_rate);
+    playing_recording = true;
+    return true;
+}
+
+// Panel pixels as a binary PBM, lit pixels black
+static void sim_frame(const ssd1306_bus_mock_t *mock, void *ctx)
+{
+    (void)ctx;
+    if (!options.frames_dir)
+    {
+        return;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%05u.pbm", options.frames_dir, frames_written);
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        perror(path);
+        options.frames_dir = NULL;
+        return;
+    }
+
+    fprintf(f, "P4\n%u %u\n", ssd1306_width, ssd1306_height);
+    for (unsigned y = 0; y < ssd1306_height; y++)
+    {
+        for (unsigned x = 0; x < ssd1306_width; x += 8)
+        {
+            uint8_t bits = 0;
+            for (unsigned i = 0; i < 8; i++)
+            {
+                uint8_t column = mock->gddram[(y / 8) * ssd1306_width + x + i];
+                bits |= ((column >> (y % 8)) & 1) << (7 - i);
+            }
+            fputc(bits, f);
+        }
+    }
+    fclose(f);
+
+    fprintf(frame_index, "%05u %u\n", frames_written, sim_now_ms());
+    frames_written++;
+}
+
+// The host end of the USB serial port, keeping what the firmware sends
+static void sim_usb_receive(const uint8_t *bytes, size_t len, void *ctx)
+{
+    fwrite(bytes, 1, len, ctx);
+}
+
+static void sim_log_leds(void)
+{
+    static const char *const colours[8] = {
+        "off", "red", "green", "yellow", "blue", "magenta", "cyan", "white"};
+
+    int state = sim_hw_gpio_output(LED_RED) | sim_hw_gpio_output(LED_GREEN) << 1 |
+                sim_hw_gpio_output(LED_BLUE) << 2;
+    if (state != led_state)
+    {
+        led_state = state;
+        printf("%8u ms  led %s\n", sim_now_ms(), colours[state]);
+    }
+}
+
+static void sim_report(void)
+{
+    const sim_hw_stats_t *hw = sim_hw_stats();
+    static char run_time_stats[SIM_RUN_TIME_STATS_LENGTH];
+
+    printf("\n== noiseguard_sim: %u ms simulated ==\n", sim_now_ms());
+    printf("adc      %llu conversions, %u S/s per input, %llu FIFO overflows\n",
+           (unsigned long long)hw->adc_conversions, mic_rate, (unsigned long long)hw->adc_overflows);
+    printf("capture  %u raw halves, %u processed, %u dropped, %u overruns\n",
+           capture_queue.produced, capture_queue.consumed, capture_queue.dropped, capture_queue.overruns);
+    printf("display  %u frames drawn, %llu sent to the panel, %llu I2C bytes\n",
+           display_frames, (unsigned long long)hw->panel_frames, (unsigned long long)hw->i2c_bytes);
+    printf("events   %u in flash (from #%u), %u waiting, %u dropped, %llu sector erases, %llu page writes\n",
+           event_log_next_seq(&event_log) - event_log_oldest_seq(&event_log), event_log_oldest_seq(&event_log),
+           event_log_pending(&event_log), event_log.dropped, (unsigned long long)hw->flash_erases,
+           (unsigned long long)hw->flash_pages);
+    printf("input    %llu button edges, %u late or dropped\n", (unsigned long long)hw->gpio_edges,
+           latency_misses[LATENCY_TASK_INPUT]);
+    if (options.telemetry_path)
+    {
+        uint32_t seconds = sim_now_ms() / 1000 ? sim_now_ms() / 1000 : 1;
+        printf("usb      %u packets sent, %u dropped, %llu bytes (%llu B/s) in %s\n",
+               telemetry_usb_stats.packets_sent, telemetry_usb_stats.packets_dropped,
+               (unsigned long long)hw->usb_bytes, (unsigned long long)hw->usb_bytes / seconds,
+               options.telemetry_path);
+    }
+    if (options.frames_dir)
+    {
+        printf("frames   %u PBM files in %s\n", frames_written, options.frames_dir);
+    }
+
+    // Host CPU time per task, only meaningful relative to each other
+    vTaskGetRunTimeStats(run_time_stats);
+    printf("\ntask\t\tabs time (us)\tshare\n%s", run_time_stats);
+}
+
+static void sim_finish(void)
+{
+    sim_report();
+    if (frame_index)
+    {
+        fclose(frame_index);
+    }
+    if (telemetry_capture)
+    {
+        fclose(telemetry_capture);
+    }
+    if (options.flash_path)
+    {
+        sim_hw_save_flash(options.flash_path);
+    }
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+static void sim_apply(const sim_event_t *event)
+{
+    switch (event->kind)
+    {
+    case SIM_EVENT_PRESS:
+    case SIM_EVENT_RELEASE:
+        // Buttons pull the pin low while held
+        sim_hw_bounce_gpio_input(event->button == 'A' ? BTN_A : event->button == 'B' ? BTN_B : JOYSTICK_SW,
+                                 event->kind == SIM_EVENT_RELEASE, (uint32_t)event->value * 1000u);
+        break;
+    case SIM_EVENT_JOYSTICK:
+        joystick_x = (uint16_t)(event->value < 0 ? 0 : event->value > 4095 ? 4095 : event->value);
+        break;
+    case SIM_EVENT_SIGNAL:
+        signal_gen_init(&generator, event->signal, mic_rate, event->frequency, event->value);
+        playing_recording = false;
+        break;
+    case SIM_EVENT_WAV:
+        sim_play_recording(event->path, false);
+        break;
+    case SIM_EVENT_USB:
+        sim_hw_usb_send(event->path, strlen(event->path));
+        break;
+    case SIM_EVENT_END:
+        sim_finish();
+        break;
+    }
+}
+
+// Plays the part of the hardware: every tick it advances the peripheral
+// model by one millisecond, which runs the DMA interrupt handlers, and
+// applies the script events that came due
+static void sim_hardware_task(void *pvParameters)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1)
+    {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(1));
+
+        sim_update_mic_rate();
+
+        const sim_event_t *event;
+        while ((event = sim_script_next(&script, sim_now_ms())) != NULL)
+        {
+            sim_apply(event);
+        }
+
+        sim_hw_advance(1000);
+        sim_log_leds();
+
+        if (options.duration_ms && sim_now_ms() >= options.duration_ms)
+        {
+            sim_finish();
+        }
+    }
+}
+
+static void sim_usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--duration ms] [--script file] [--signal kind:freq:amplitude]\n"
+            "       [--wav file | --raw file [--raw-rate hz]] [--frames dir] [--flash image]\n"
+            "       [--telemetry file]\n"
+            "  --duration 0 runs until the script ends\n"
+            "  --flash keeps the flash contents in image from one run to the next\n"
+            "  --telemetry opens the USB port and captures the stream into file\n",
+            argv0);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    signal_kind_t kind = SIGNAL_SINE;
+    unsigned frequency = 1000;
+    int amplitude = 600;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (!value)
+        {
+            sim_usage(argv[0]);
+        }
+        i++;
+
+        if (strcmp(arg, "--duration") == 0)
+        {
+            options.duration_ms = (uint32_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(arg, "--script") == 0)
+        {
+            options.script_path = value;
+        }
+        else if (strcmp(arg, "--signal") == 0)
+        {
+            char name[16];
+            bool found = false;
+            if (sscanf(value, "%15[^:]:%u:%d", name, &frequency, &amplitude) == 3)
+            {
+                for (signal_kind_t k = 0; k < SIGNAL_KIND_COUNT; k++)
+                {
+                    if (strcmp(name, signal_gen_name(k)) == 0)
+                    {
+                        kind = k;
+                        found = true;
+                    }
+                }
+            }
+            if (!found)
+            {
+                sim_usage(argv[0]);
+            }
+        }
+        else if (strcmp(arg, "--wav") == 0)
+        {
+            options.wav_path = value;
+        }
+        else if (strcmp(arg, "--raw") == 0)
+        {
+            options.raw_path = value;
+        }
+        else if (strcmp(arg, "--raw-rate") == 0)
+        {
+            options.raw_rate = (uint32_t)strtoul(value, NULL, 0);
+        }
+        else if (strcmp(arg, "--frames") == 0)
+        {
+            options.frames_dir = value;
+        }
+        else if (strcmp(arg, "--flash") == 0)
+        {
+            options.flash_path = value;
+        }
+        else if (strcmp(arg, "--telemetry") == 0)
+        {
+            options.telemetry_path = value;
+        }
+        else
+        {
+            sim_usage(argv[0]);
+        }
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    if (options.script_path && !sim_script_load(&script, options.script_path))
+    {
+        return EXIT_FAILURE;
+    }
+    if (!sim_hw_load_flash(options.flash_path))
+    {
+        return EXIT_FAILURE;
+    }
+    signal_gen_init(&generator, kind, 1, frequency, amplitude);
+    if ((options.wav_path && !sim_play_recording(options.wav_path, false)) ||
+        (options.raw_path && !sim_play_recording(options.raw_path, true)))
+    {
+        return EXIT_FAILURE;
+    }
+    if (options.frames_dir)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/frames.txt", options.frames_dir);
+        frame_index = fopen(path, "w");
+        if (!frame_index)
+        {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+        fprintf(frame_index, "# frame time_ms\n");
+    }
+    if (options.telemetry_path)
+    {
+        telemetry_capture = fopen(options.telemetry_path, "wb");
+        if (!telemetry_capture)
+        {
+            perror(options.telemetry_path);
+            return EXIT_FAILURE;
+        }
+        sim_hw_attach_usb(sim_usb_receive, telemetry_capture);
+    }
+
+    ssd1306_bus_mock_init(&panel);
+    sim_hw_attach_panel(&panel, sim_frame, NULL);
+    sim_hw_set_adc_source(MIC_ADC_INPUT, sim_mic_sample, NULL);
+    sim_hw_set_adc_source(JOYSTICK_X_ADC_INPUT, sim_joystick_sample, NULL);
+
+    xTaskCreate(sim_hardware_task, "SimHardware", configMINIMAL_STACK_SIZE, NULL,
+                SIM_HW_TASK_PRIORITY, NULL);
+
+    return noiseguard_main();
+}
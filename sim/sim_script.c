@@ -0,0 +1,139 @@
+#include "sim_script.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool sim_script_signal(const char *name, signal_kind_t *kind)
+{
+    for (signal_kind_t k = 0; k < SIGNAL_KIND_COUNT; k++)
+    {
+        if (strcmp(name, signal_gen_name(k)) == 0)
+        {
+            *kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool sim_script_parse(const char *line, sim_event_t *event)
+{
+    char verb[16];
+    char arg[SIM_SCRIPT_PATH_MAX];
+    unsigned long time_ms;
+    int used;
+
+    memset(event, 0, sizeof(*event));
+    if (sscanf(line, "%lu %15s%n", &time_ms, verb, &used) != 2)
+    {
+        return false;
+    }
+    event->time_ms = (uint32_t)time_ms;
+    line += used;
+
+    if (strcmp(verb, "press") == 0 || strcmp(verb, "release") == 0)
+    {
+        event->kind = verb[0] == 'p' ? SIM_EVENT_PRESS : SIM_EVENT_RELEASE;
+        // Optional contact bounce in milliseconds after the button
+        if (sscanf(line, " %1s %d", arg, &event->value) < 1 || event->value < 0)
+        {
+            return false;
+        }
+        event->button = (char)toupper((unsigned char)arg[0]);
+        return event->button == 'A' || event->button == 'B' || event->button == 'S';
+    }
+    if (strcmp(verb, "joystick") == 0)
+    {
+        event->kind = SIM_EVENT_JOYSTICK;
+        return sscanf(line, "%d", &event->value) == 1;
+    }
+    if (strcmp(verb, "signal") == 0)
+    {
+        event->kind = SIM_EVENT_SIGNAL;
+        return sscanf(line, " %15s %u %d", arg, &event->frequency, &event->value) == 3 &&
+               sim_script_signal(arg, &event->signal);
+    }
+    if (strcmp(verb, "wav") == 0)
+    {
+        event->kind = SIM_EVENT_WAV;
+        return sscanf(line, " %255s", event->path) == 1;
+    }
+    if (strcmp(verb, "usb") == 0)
+    {
+        event->kind = SIM_EVENT_USB;
+        return sscanf(line, " %255s", event->path) == 1;
+    }
+    if (strcmp(verb, "end") == 0)
+    {
+        event->kind = SIM_EVENT_END;
+        return true;
+    }
+    return false;
+}
+
+bool sim_script_load(sim_script_t *script, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        perror(path);
+        return false;
+    }
+
+    memset(script, 0, sizeof(*script));
+    size_t capacity = 0;
+    char line[512];
+    unsigned number = 0;
+    uint32_t last_ms = 0;
+
+    while (fgets(line, sizeof(line), f))
+    {
+        number++;
+        char *text = line;
+        while (isspace((unsigned char)*text))
+        {
+            text++;
+        }
+        if (*text == '\0' || *text == '#')
+        {
+            continue;
+        }
+
+        if (script->count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 16;
+            script->events = realloc(script->events, capacity * sizeof(sim_event_t));
+        }
+
+        sim_event_t *event = &script->events[script->count];
+        if (!sim_script_parse(text, event) || event->time_ms < last_ms)
+        {
+            fprintf(stderr, "%s:%u: bad event: %s", path, number, line);
+            fclose(f);
+            sim_script_free(script);
+            return false;
+        }
+        last_ms = event->time_ms;
+        script->count++;
+    }
+
+    fclose(f);
+    return true;
+}
+
+const sim_event_t *sim_script_next(sim_script_t *script, uint32_t now_ms)
+{
+    if (script->next < script->count && script->events[script->next].time_ms <= now_ms)
+    {
+        return &script->events[script->next++];
+    }
+    return NULL;
+}
+
+void sim_script_free(sim_script_t *script)
+{
+    free(script->events);
+    memset(script, 0, sizeof(*script));
+}
@@ -0,0 +1,60 @@
+#ifndef SIM_SCRIPT_H
+#define SIM_SCRIPT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "signal_gen.h"
+
+#define SIM_SCRIPT_PATH_MAX 256
+
+// Timed stimulus for noiseguard_sim, one event per line:
+//
+//   # time_ms  event
+//   0     signal sine 1000 600     generator on the microphone: kind freq amplitude
+//   500   press a                  button A, B or S (joystick switch) held down
+//   700   release a 3              optional: contact bounce for 3 ms first
+//   1000  joystick 3900            joystick X in ADC counts
+//   2000  wav recording.wav        play a file into the microphone
+//   3000  usb r                    host writes these bytes to the USB serial port
+//   5000  end                      stop the simulation
+//
+// Times are absolute and must not go backwards.
+typedef enum
+{
+    SIM_EVENT_PRESS,
+    SIM_EVENT_RELEASE,
+    SIM_EVENT_JOYSTICK,
+    SIM_EVENT_SIGNAL,
+    SIM_EVENT_WAV,
+    SIM_EVENT_USB,
+    SIM_EVENT_END,
+} sim_event_kind_t;
+
+typedef struct
+{
+    uint32_t time_ms;
+    sim_event_kind_t kind;
+    char button;
+    int value;
+    signal_kind_t signal;
+    uint32_t frequency;
+    char path[SIM_SCRIPT_PATH_MAX];
+} sim_event_t;
+
+typedef struct
+{
+    sim_event_t *events;
+    size_t count;
+    size_t next;
+} sim_script_t;
+
+bool sim_script_load(sim_script_t *script, const char *path);
+
+// Next event due at or before now_ms, NULL when none is
+const sim_event_t *sim_script_next(sim_script_t *script, uint32_t now_ms);
+
+void sim_script_free(sim_script_t *script);
+
+#endif // SIM_SCRIPT_H
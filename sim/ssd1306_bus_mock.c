@@ -0,0 +1,178 @@
+#include "ssd1306_bus_mock.h"
+
+#include <string.h>
+
+// Number of argument bytes that follow each SSD1306 command
+static int ssd1306_mock_command_args(uint8_t command)
+{
+    switch (command)
+    {
+    case ssd1306_set_memory_mode:
+    case ssd1306_set_contrast:
+    case ssd1306_set_charge_pump:
+    case ssd1306_set_mux_ratio:
+    case ssd1306_set_display_offset:
+    case ssd1306_set_display_clock_divide_ratio:
+    case ssd1306_set_precharge:
+    case ssd1306_set_common_pin_configuration:
+    case ssd1306_set_vcomh_deselect_level:
+        return 1;
+    case ssd1306_set_column_address:
+    case ssd1306_set_page_address:
+        return 2;
+    case ssd1306_set_horizontal_scroll:
+    case ssd1306_set_horizontal_scroll | 0x01:
+        return 6;
+    case ssd1306_scroll_column_right:
+    case ssd1306_scroll_column_left:
+        return 7;
+    default:
+        return 0;
+    }
+}
+
+static void ssd1306_mock_apply_command(ssd1306_bus_mock_t *mock, const uint8_t *command)
+{
+    switch (command[0])
+    {
+    case ssd1306_set_column_address:
+        mock->column_start = mock->column = command[1] % ssd1306_width;
+        mock->column_end = command[2] % ssd1306_width;
+        break;
+    case ssd1306_set_page_address:
+        mock->page_start = mock->page = command[1] % ssd1306_n_pages;
+        mock->page_end = command[2] % ssd1306_n_pages;
+        break;
+    case ssd1306_scroll_column_left:
+    case ssd1306_scroll_column_right:
+    {
+        // Rotates the window's RAM by one column
+        struct render_area area = {
+            .start_column = command[6] % ssd1306_width,
+            .end_column = command[7] % ssd1306_width,
+            .start_page = command[2] % ssd1306_n_pages,
+            .end_page = command[4] % ssd1306_n_pages};
+        int width = area.end_column - area.start_column;
+        if (width <= 0 || area.end_page < area.start_page)
+        {
+            break;
+        }
+        if (command[0] == ssd1306_scroll_column_left)
+        {
+            ssd1306_scroll_left(mock->gddram, &area);
+            break;
+        }
+        for (int page = area.start_page; page <= area.end_page; page++)
+        {
+            uint8_t *row = mock->gddram + page * ssd1306_width + area.start_column;
+            uint8_t last = row[width];
+            memmove(row + 1, row, width);
+            row[0] = last;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Horizontal addressing mode: column wraps to the next page inside the window
+static void ssd1306_mock_write_data(ssd1306_bus_mock_t *mock, uint8_t value)
+{
+    mock->gddram[mock->page * ssd1306_width + mock->column] = value;
+
+    if (mock->column == mock->column_end)
+    {
+        mock->column = mock->column_start;
+        mock->page = mock->page == mock->page_end ? mock->page_start : mock->page + 1;
+    }
+    else
+    {
+        mock->column = (mock->column + 1) % ssd1306_width;
+    }
+}
+
+static void ssd1306_mock_transaction(ssd1306_bus_mock_t *mock, const uint8_t *bytes, uint32_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    if (bytes[0] == ssd1306_control_data)
+    {
+        for (uint32_t i = 1; i < length; i++)
+        {
+            ssd1306_mock_write_data(mock, bytes[i]);
+        }
+        return;
+    }
+
+    for (uint32_t i = 1; i < length;)
+    {
+        int args = ssd1306_mock_command_args(bytes[i]);
+        if (i + args < length)
+        {
+            ssd1306_mock_apply_command(mock, &bytes[i]);
+        }
+        i += 1 + args;
+    }
+}
+
+static void ssd1306_mock_submit(ssd1306_bus_t *bus, const uint16_t *words, size_t count)
+{
+    ssd1306_bus_mock_t *mock = (ssd1306_bus_mock_t *)bus;
+    uint8_t transaction[1 + ssd1306_stream_capacity];
+    uint32_t length = 0;
+
+    mock->submits++;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        transaction[length++] = words[i] & 0xFF;
+        if (!(words[i] & ssd1306_stream_stop) && i + 1 < count)
+        {
+            continue;
+        }
+
+        ssd1306_mock_transaction(mock, transaction, length);
+
+        if (mock->transaction_count < SSD1306_MOCK_MAX_TRANSACTIONS &&
+            mock->byte_count + length <= SSD1306_MOCK_MAX_BYTES)
+        {
+            mock->transactions[mock->transaction_count].offset = mock->byte_count;
+            mock->transactions[mock->transaction_count].length = length;
+            memcpy(mock->bytes + mock->byte_count, transaction, length);
+            mock->transaction_count++;
+            mock->byte_count += length;
+        }
+        else
+        {
+            mock->overflowed = true;
+        }
+        length = 0;
+    }
+}
+
+static void ssd1306_mock_wait(ssd1306_bus_t *bus)
+{
+    (void)bus;
+}
+
+ssd1306_bus_t *ssd1306_bus_mock_init(ssd1306_bus_mock_t *mock)
+{
+    memset(mock, 0, sizeof(*mock));
+    mock->bus.submit = ssd1306_mock_submit;
+    mock->bus.wait = ssd1306_mock_wait;
+    mock->column_end = ssd1306_width - 1;
+    mock->page_end = ssd1306_n_pages - 1;
+    return &mock->bus;
+}
+
+void ssd1306_bus_mock_clear_log(ssd1306_bus_mock_t *mock)
+{
+    mock->transaction_count = 0;
+    mock->byte_count = 0;
+    mock->submits = 0;
+    mock->overflowed = false;
+}
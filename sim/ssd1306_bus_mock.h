@@ -0,0 +1,43 @@
+#ifndef SSD1306_BUS_MOCK_H
+#define SSD1306_BUS_MOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ssd1306_stream.h"
+
+#define SSD1306_MOCK_MAX_TRANSACTIONS 256
+#define SSD1306_MOCK_MAX_BYTES 8192
+
+// One I2C write as the display would see it: control byte first
+typedef struct
+{
+    uint32_t offset;
+    uint32_t length;
+} ssd1306_mock_transaction_t;
+
+// Records every transaction submitted to it and replays them into a model
+// of the controller's GDDRAM, so callers can check both the bus traffic and
+// what the panel ends up showing. The one column content scrolls move the
+// GDDRAM the way the controller does.
+typedef struct
+{
+    ssd1306_bus_t bus;
+
+    uint8_t bytes[SSD1306_MOCK_MAX_BYTES];
+    ssd1306_mock_transaction_t transactions[SSD1306_MOCK_MAX_TRANSACTIONS];
+    uint32_t transaction_count;
+    uint32_t byte_count;
+    uint32_t submits;
+    bool overflowed;
+
+    uint8_t gddram[ssd1306_buffer_length];
+    uint8_t column_start, column_end, column;
+    uint8_t page_start, page_end, page;
+} ssd1306_bus_mock_t;
+
+ssd1306_bus_t *ssd1306_bus_mock_init(ssd1306_bus_mock_t *mock);
+void ssd1306_bus_mock_clear_log(ssd1306_bus_mock_t *mock);
+
+#endif // SSD1306_BUS_MOCK_H
@@ -0,0 +1,221 @@
+#include "capture.h"
+#include "adc_rr.h"
+#include "decimator.h"
+#include "diagnostics.h"
+#include "input.h"
+#include "peripherals.h"
+
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+
+#include <assert.h>
+
+// Each half holds CAPTURE_HALF_FRAMES round-robin frames at the raw rate,
+// one sample per ADC channel; blocks of SAMPLES audio samples are
+// assembled from several halves
+#define CAPTURE_HALF_FRAMES 256
+#define CAPTURE_HALF_SAMPLES (CAPTURE_HALF_FRAMES * ADC_RR_CHANNELS)
+#define CAPTURE_HALF_BYTES (CAPTURE_HALF_SAMPLES * sizeof(uint16_t))
+#define CAPTURE_HALF_AUDIO (CAPTURE_HALF_FRAMES / AUDIO_DECIMATION)
+
+static_assert((CAPTURE_HALF_BYTES & (CAPTURE_HALF_BYTES - 1)) == 0,
+              "each capture half must be a power of two in bytes");
+static_assert(CAPTURE_HALF_FRAMES % AUDIO_DECIMATION == 0, "a half must decimate to whole samples");
+static_assert(SAMPLES % CAPTURE_HALF_AUDIO == 0, "a block must be made of whole halves");
+
+// Each channel wraps inside its own half, so the DMA never leaves the buffer
+// even when the IRQ is serviced late.
+uint16_t adc_buffer[2 * CAPTURE_HALF_SAMPLES] __attribute__((aligned(CAPTURE_HALF_BYTES)));
+capture_queue_t capture_queue;
+
+// Raw microphone samples of one half, de-interleaved out of the DMA buffer
+static uint16_t capture_raw_audio[CAPTURE_HALF_FRAMES];
+
+// Decimated block being assembled, returned once full
+static uint16_t capture_audio[SAMPLES];
+static uint32_t capture_audio_len;
+static uint32_t capture_blocks;
+static decimator_t capture_decimator;
+
+// Decimated samples lost since the last block returned
+static uint32_t capture_lost;
+
+// Time spent with interrupts off, written by capture_stalled, and how much
+// of it the consumer has counted
+static volatile uint32_t capture_stall_us;
+static uint32_t capture_stall_seen_us;
+
+// Joystick X averaged over the last block, centred until the first one lands
+static volatile uint16_t capture_joystick_x_value = 2048;
+
+// When each half last finished filling, stamped by the interrupt
+static volatile uint32_t capture_half_us[2];
+
+static uint capture_dma[2];
+static TaskHandle_t capture_consumer;
+
+static void capture_dma_irq_handler(void)
+{
+    unsigned pending = 0;
+    for (unsigned i = 0; i < 2; i++)
+    {
+        if (dma_channel_get_irq0_status(capture_dma[i]))
+        {
+            dma_channel_acknowledge_irq0(capture_dma[i]);
+            pending |= 1u << i;
+        }
+    }
+
+    if (!pending)
+    {
+        return;
+    }
+    uint32_t now_us = time_us_32();
+    for (unsigned i = 0; i < 2; i++)
+    {
+        if (pending & (1u << i))
+        {
+            capture_half_us[i] = now_us;
+        }
+    }
+
+    unsigned filling = dma_channel_is_busy(capture_dma[0]) ? 0 : 1;
+    capture_queue_on_irq(&capture_queue, pending, filling);
+
+    BaseType_t woken = pdFALSE;
+    if (capture_consumer)
+    {
+        vTaskNotifyGiveFromISR(capture_consumer, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+void capture_init(void)
+{
+    capture_queue_init(&capture_queue, adc_buffer, CAPTURE_HALF_SAMPLES);
+
+    bool decimator_ok = decimator_init(&capture_decimator, AUDIO_SAMPLE_RATE, AUDIO_DECIMATION);
+    configASSERT(decimator_ok);
+
+    capture_dma[0] = dma_claim_unused_channel(true);
+    capture_dma[1] = dma_claim_unused_channel(true);
+
+    for (unsigned i = 0; i < 2; i++)
+    {
+        dma_channel_config cfg = dma_channel_get_default_config(capture_dma[i]);
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+        channel_config_set_read_increment(&cfg, false);
+        channel_config_set_write_increment(&cfg, true);
+        channel_config_set_ring(&cfg, true, __builtin_ctz(CAPTURE_HALF_BYTES));
+        channel_config_set_dreq(&cfg, DREQ_ADC);
+        channel_config_set_chain_to(&cfg, capture_dma[i ^ 1]);
+
+        dma_channel_configure(capture_dma[i], &cfg,
+                              capture_queue.halves[i],
+                              &adc_hw->fifo,
+                              CAPTURE_HALF_SAMPLES,
+                              false);
+        dma_channel_set_irq0_enabled(capture_dma[i], true);
+    }
+
+    irq_add_shared_handler(DMA_IRQ_0, capture_dma_irq_handler,
+                           PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+void capture_start(TaskHandle_t consumer)
+{
+    capture_consumer = consumer;
+
+    // Round robin advances from the selected input, so frames start with the joystick
+    adc_run(false);
+    adc_set_round_robin((1u << JOYSTICK_X_ADC_INPUT) | (1u << MIC_ADC_INPUT));
+    adc_select_input(JOYSTICK_X_ADC_INPUT);
+    adc_fifo_drain();
+
+    dma_channel_start(capture_dma[0]);
+    adc_run(true);
+}
+
+// Raw halves went missing: what was decimated before them is thrown away
+// with them and the decimator starts again, so a block never spans a gap
+static void capture_gap(uint32_t halves)
+{
+    capture_lost += capture_audio_len + halves * CAPTURE_HALF_AUDIO;
+    capture_audio_len = 0;
+    decimator_reset(&capture_decimator);
+}
+
+void capture_stalled(uint32_t us)
+{
+    capture_stall_us += us;
+}
+
+// Halves the DMA went round while nothing took them off the buffer
+static uint32_t capture_stall_halves(void)
+{
+    uint32_t stalled_us = capture_stall_us - capture_stall_seen_us;
+    capture_stall_seen_us += stalled_us;
+    return (uint32_t)((uint64_t)stalled_us * AUDIO_SAMPLE_RATE * AUDIO_DECIMATION /
+                      (1000000ull * CAPTURE_HALF_FRAMES));
+}
+
+bool capture_wait_block(capture_block_t *block, TickType_t timeout)
+{
+    capture_block_t raw;
+
+    while (1)
+    {
+        while (!capture_queue_acquire(&capture_queue, &raw))
+        {
+            if (ulTaskNotifyTake(pdTRUE, timeout) == 0)
+            {
+                return false;
+            }
+        }
+
+        PROFILE_START(half_start);
+        uint32_t half_us = capture_half_us[raw.seq % 2];
+        uint32_t joystick_sum = adc_rr_split(raw.samples, CAPTURE_HALF_FRAMES, capture_raw_audio);
+        // The queue sees at most the two halves whose interrupts were
+        // pending, a stall may have hidden many more
+        uint32_t lost = raw.lost / CAPTURE_HALF_SAMPLES;
+        uint32_t stalled = capture_stall_halves();
+        lost = stalled > lost ? stalled : lost;
+        if (lost)
+        {
+            capture_gap(lost);
+        }
+
+        // The raw half goes straight back to the DMA; a copy it lapped is discarded
+        if (!capture_queue_release(&capture_queue, &raw))
+        {
+            capture_gap(1);
+            continue;
+        }
+        capture_joystick_x_value = joystick_sum / CAPTURE_HALF_FRAMES;
+        input_joystick_moved(capture_joystick_x_value);
+
+        // Filter state runs across halves and blocks, only the output is cut into blocks
+        capture_audio_len += decimator_process(&capture_decimator, capture_raw_audio, CAPTURE_HALF_FRAMES,
+                                               capture_audio + capture_audio_len);
+        PROFILE_STOP(PROFILE_CAPTURE, half_start);
+        if (capture_audio_len == SAMPLES)
+        {
+            capture_audio_len = 0;
+
+            block->samples = capture_audio;
+            block->len = SAMPLES;
+            block->seq = capture_blocks++;
+            block->time_us = half_us;
+            block->lost = capture_lost;
+            capture_lost = 0;
+            return true;
+        }
+    }
+}
+
+uint16_t capture_joystick_x(void)
+{
+    return capture_joystick_x_value;
+}
@@ -0,0 +1,14 @@
+#include "adc_rr.h"
+
+uint32_t adc_rr_split(const uint16_t *raw, uint32_t frames, uint16_t *audio)
+{
+    uint32_t control_sum = 0;
+
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        control_sum += raw[ADC_RR_CONTROL_SLOT];
+        audio[i] = raw[ADC_RR_AUDIO_SLOT];
+        raw += ADC_RR_CHANNELS;
+    }
+    return control_sum;
+}
@@ -0,0 +1,51 @@
+#include "alarm.h"
+
+alarm_state_t alarm_classify(int level, int warning_threshold, int danger_threshold)
+{
+    if (level < warning_threshold)
+    {
+        return ALARM_OK;
+    }
+    else if (level < danger_threshold)
+    {
+        return ALARM_WARNING;
+    }
+    return ALARM_DANGER;
+}
+
+bool alarm_episode_update(alarm_episode_t *episode, alarm_state_t state, int level, int threshold,
+                          uint32_t now_ms)
+{
+    if (state == ALARM_OK)
+    {
+        if (!episode->active)
+        {
+            return false;
+        }
+        episode->active = false;
+        episode->duration_ms = now_ms - episode->start_ms;
+        return true;
+    }
+
+    if (!episode->active)
+    {
+        *episode = (alarm_episode_t){
+            .active = true,
+            .worst = state,
+            .start_ms = now_ms,
+            .peak = level,
+            .threshold = threshold};
+        return false;
+    }
+
+    if (state > episode->worst)
+    {
+        episode->worst = state;
+        episode->threshold = threshold;
+    }
+    if (level > episode->peak)
+    {
+        episode->peak = level;
+    }
+    return false;
+}
@@ -0,0 +1,88 @@
+#include "block_stats.h"
+#include "fixed_math.h"
+
+#include <math.h>
+#include <string.h>
+
+void block_stats_compute(const uint16_t *samples, uint32_t count, block_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (count == 0)
+    {
+        return;
+    }
+
+    // 12-bit samples: the sum fits 32 bits, each square fits 24 bits
+    uint32_t sum = 0;
+    uint64_t sum_sq = 0;
+    uint32_t min = 0xFFFF;
+    uint32_t max = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t x = samples[i];
+        sum += x;
+        sum_sq += x * x;
+        if (x < min)
+        {
+            min = x;
+        }
+        if (x > max)
+        {
+            max = x;
+        }
+    }
+
+    uint32_t mean = (sum + count / 2) / count;
+
+    // n^2 * variance, exact in integers
+    uint64_t var_n2 = (uint64_t)count * sum_sq - (uint64_t)sum * sum;
+    uint64_t var_q16 = ((var_n2 / count) << 16) / count;
+    uint32_t rms_q8 = isqrt64(var_q16);
+
+    uint32_t peak = max - mean > mean - min ? max - mean : mean - min;
+
+    stats->mean = mean;
+    stats->min = min;
+    stats->max = max;
+    stats->peak = peak;
+    stats->rms_q8 = rms_q8;
+    stats->crest_q8 = rms_q8 ? (uint32_t)(((uint64_t)peak << 16) / rms_q8) : 0;
+}
+
+// Two-pass floating point version, kept to check the integer kernel against
+void block_stats_compute_ref(const uint16_t *samples, uint32_t count, block_stats_ref_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (count == 0)
+    {
+        return;
+    }
+
+    double sum = 0.0;
+    double min = samples[0];
+    double max = samples[0];
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sum += samples[i];
+        min = samples[i] < min ? samples[i] : min;
+        max = samples[i] > max ? samples[i] : max;
+    }
+    double mean = sum / count;
+
+    double sum_sq = 0.0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        double ac = samples[i] - mean;
+        sum_sq += ac * ac;
+    }
+    double rms = sqrt(sum_sq / count);
+    double peak = fmax(max - mean, mean - min);
+
+    stats->mean = (float)mean;
+    stats->min = (float)min;
+    stats->max = (float)max;
+    stats->peak = (float)peak;
+    stats->rms = (float)rms;
+    stats->crest = rms > 0.0 ? (float)(peak / rms) : 0.0f;
+}
@@ -0,0 +1,86 @@
+#include "calibration.h"
+#include "fixed_math.h"
+
+#include <math.h>
+#include <stddef.h>
+
+// 200 log10(2): deci-dB per doubling, Q6
+#define CALIBRATION_DECIDB_PER_OCTAVE_Q6 3853
+
+// Reference pressure of the sensitivity, 94 dB SPL = 1 Pa
+#define CALIBRATION_REFERENCE_DECIDB 940
+
+const calibration_profile_t calibration_default_profile = {
+    .magic = CALIBRATION_PROFILE_MAGIC,
+    .version = CALIBRATION_PROFILE_VERSION,
+    .sensitivity_decidbv = CALIBRATION_DEFAULT_SENSITIVITY_DECIDBV,
+    .offset_decidb = 0,
+};
+
+uint16_t calibration_profile_checksum(const calibration_profile_t *profile)
+{
+    const uint8_t *bytes = (const uint8_t *)profile;
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+
+    for (size_t i = 0; i < offsetof(calibration_profile_t, checksum); i++)
+    {
+        sum1 = (sum1 + bytes[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (uint16_t)(sum2 << 8 | sum1);
+}
+
+const calibration_profile_t *calibration_profile_select(const calibration_profile_t *stored)
+{
+    if (stored != NULL && stored->magic == CALIBRATION_PROFILE_MAGIC &&
+        stored->version == CALIBRATION_PROFILE_VERSION &&
+        stored->checksum == calibration_profile_checksum(stored))
+    {
+        return stored;
+    }
+    return &calibration_default_profile;
+}
+
+int32_t calibration_counts_decidb(uint32_t rms_q8)
+{
+    // Q16 log2 down to Q12 so the product stays within 32 bits
+    int32_t log2_q12 = (int32_t)(log2_q16(rms_q8) >> 4) - (8 << 12);
+    return (log2_q12 * CALIBRATION_DECIDB_PER_OCTAVE_Q6 + (1 << 17)) >> 18;
+}
+
+void calibration_init(calibration_t *calibration, const calibration_profile_t *profile, uint32_t adc_vref_mv)
+{
+    calibration->profile = profile;
+
+    // One count is adc_vref_mv / 4096 mV: its level in dBV is
+    // 20 log10(adc_vref_mv / 4096000), rounded once from the log2 difference
+    int32_t log2_q12 = (int32_t)(log2_q16(adc_vref_mv) >> 4) - (int32_t)(log2_q16(4096000u) >> 4);
+    int32_t count_decidbv = (log2_q12 * CALIBRATION_DECIDB_PER_OCTAVE_Q6 + (1 << 17)) >> 18;
+
+    calibration->spl_offset_decidb =
+        count_decidbv - profile->sensitivity_decidbv + CALIBRATION_REFERENCE_DECIDB + profile->offset_decidb;
+}
+
+int32_t calibration_spl_decidb(const calibration_t *calibration, uint32_t rms_q8)
+{
+    if (rms_q8 == 0)
+    {
+        return CALIBRATION_FLOOR_DECIDB;
+    }
+
+    int32_t spl = calibration_counts_decidb(rms_q8) + calibration->spl_offset_decidb;
+    return spl > CALIBRATION_FLOOR_DECIDB ? spl : CALIBRATION_FLOOR_DECIDB;
+}
+
+double calibration_counts_db_ref(double rms)
+{
+    return 20.0 * log10(rms);
+}
+
+double calibration_spl_db_ref(const calibration_profile_t *profile, uint32_t adc_vref_mv, double rms)
+{
+    double volts = rms * adc_vref_mv / 4096.0 / 1000.0;
+    double spl = 20.0 * log10(volts) - profile->sensitivity_decidbv / 10.0 + 94.0 + profile->offset_decidb / 10.0;
+    return spl > CALIBRATION_FLOOR_DECIDB / 10.0 ? spl : CALIBRATION_FLOOR_DECIDB / 10.0;
+}
@@ -0,0 +1,177 @@
+#include "capture_file.h"
+#include "crc16.h"
+
+#include <string.h>
+
+_Static_assert(sizeof(capture_file_header_t) == 48, "the header layout is part of the format");
+_Static_assert(sizeof(capture_file_thresholds_t) == 8, "the thresholds layout is part of the format");
+
+static void capture_put16(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static uint32_t capture_get16(const uint8_t *in)
+{
+    return in[0] | (uint32_t)in[1] << 8;
+}
+
+static void capture_put32(uint8_t *out, uint32_t value)
+{
+    capture_put16(out, value);
+    capture_put16(out + 2, value >> 16);
+}
+
+static uint32_t capture_get32(const uint8_t *in)
+{
+    return capture_get16(in) | capture_get16(in + 2) << 16;
+}
+
+void capture_file_header_init(capture_file_header_t *header, uint32_t sample_rate, uint32_t block_samples,
+                              uint32_t adc_vref_mv, const calibration_profile_t *calibration,
+                              weighting_curve_t weighting, unsigned spectrum_log2, const char *firmware)
+{
+    memset(header, 0, sizeof(*header));
+    header->magic = CAPTURE_FILE_MAGIC;
+    header->version = CAPTURE_FILE_VERSION;
+    header->header_size = sizeof(*header);
+    header->sample_rate = sample_rate;
+    header->block_samples = (uint16_t)block_samples;
+    header->adc_vref_mv = (uint16_t)adc_vref_mv;
+    header->calibration = *calibration;
+    header->weighting = (uint8_t)weighting;
+    header->spectrum_log2 = (uint8_t)spectrum_log2;
+    size_t length = strlen(firmware);
+    memcpy(header->firmware, firmware, length < sizeof(header->firmware) ? length : sizeof(header->firmware));
+    header->crc = crc16_update(CRC16_INIT, header, offsetof(capture_file_header_t, crc));
+}
+
+bool capture_file_header_check(const capture_file_header_t *header)
+{
+    return header->magic == CAPTURE_FILE_MAGIC && header->version == CAPTURE_FILE_VERSION &&
+           header->header_size == sizeof(*header) &&
+           header->crc == crc16_update(CRC16_INIT, header, offsetof(capture_file_header_t, crc));
+}
+
+// Header and CRC around a payload already at out + CAPTURE_CHUNK_HEADER
+static size_t capture_chunk_seal(uint8_t *out, capture_chunk_type_t type, uint32_t block, uint32_t length)
+{
+    out[0] = (uint8_t)type;
+    out[1] = 0;
+    capture_put16(out + 2, length);
+    capture_put32(out + 4, block);
+    capture_put16(out + CAPTURE_CHUNK_HEADER + length, crc16_update(CRC16_INIT, out, CAPTURE_CHUNK_HEADER + length));
+    return CAPTURE_CHUNK_BYTES(length);
+}
+
+size_t capture_file_write_block(uint8_t *out, uint32_t block, const uint16_t *samples, uint32_t count)
+{
+    uint8_t *packed = out + CAPTURE_CHUNK_HEADER;
+
+    for (uint32_t i = 0; i + 1 < count; i += 2)
+    {
+        uint32_t pair = (samples[i] & 0x0FFFu) | (samples[i + 1] & 0x0FFFu) << 12;
+        *packed++ = (uint8_t)pair;
+        *packed++ = (uint8_t)(pair >> 8);
+        *packed++ = (uint8_t)(pair >> 16);
+    }
+    if (count % 2)
+    {
+        capture_put16(packed, samples[count - 1] & 0x0FFFu);
+    }
+    return capture_chunk_seal(out, CAPTURE_CHUNK_BLOCK, block, CAPTURE_PACKED_BYTES(count));
+}
+
+size_t capture_file_write_thresholds(uint8_t *out, uint32_t block, const monitor_thresholds_t *thresholds)
+{
+    const capture_file_thresholds_t payload = {
+        .warning = (int16_t)thresholds->warning,
+        .danger = (int16_t)thresholds->danger,
+        .gap = (int16_t)thresholds->gap,
+        .metric = (uint8_t)thresholds->metric};
+
+    memcpy(out + CAPTURE_CHUNK_HEADER, &payload, sizeof(payload));
+    return capture_chunk_seal(out, CAPTURE_CHUNK_THRESHOLDS, block, sizeof(payload));
+}
+
+size_t capture_file_write_gap(uint8_t *out, uint32_t block, uint32_t lost)
+{
+    capture_put32(out + CAPTURE_CHUNK_HEADER, lost);
+    return capture_chunk_seal(out, CAPTURE_CHUNK_GAP, block, 4);
+}
+
+size_t capture_file_read_chunk(const uint8_t *bytes, size_t len, capture_chunk_t *chunk)
+{
+    if (len < CAPTURE_CHUNK_BYTES(0))
+    {
+        return 0;
+    }
+
+    uint32_t length = capture_get16(bytes + 2);
+    if (len < CAPTURE_CHUNK_BYTES(length) ||
+        capture_get16(bytes + CAPTURE_CHUNK_HEADER + length) !=
+            crc16_update(CRC16_INIT, bytes, CAPTURE_CHUNK_HEADER + length))
+    {
+        return 0;
+    }
+
+    chunk->type = (capture_chunk_type_t)bytes[0];
+    chunk->block = capture_get32(bytes + 4);
+    chunk->length = length;
+    chunk->payload = bytes + CAPTURE_CHUNK_HEADER;
+    return CAPTURE_CHUNK_BYTES(length);
+}
+
+uint32_t capture_file_unpack(const capture_chunk_t *chunk, uint16_t *samples, uint32_t max)
+{
+    const uint8_t *packed = chunk->payload;
+    uint32_t count = chunk->length / 3 * 2 + (chunk->length % 3 == 2 ? 1 : 0);
+
+    if (chunk->type != CAPTURE_CHUNK_BLOCK)
+    {
+        return 0;
+    }
+    if (count > max)
+    {
+        count = max;
+    }
+    for (uint32_t i = 0; i + 1 < count; i += 2, packed += 3)
+    {
+        uint32_t pair = packed[0] | (uint32_t)packed[1] << 8 | (uint32_t)packed[2] << 16;
+        samples[i] = (uint16_t)(pair & 0x0FFFu);
+        samples[i + 1] = (uint16_t)(pair >> 12);
+    }
+    if (count % 2)
+    {
+        samples[count - 1] = (uint16_t)(capture_get16(packed) & 0x0FFFu);
+    }
+    return count;
+}
+
+bool capture_file_thresholds(const capture_chunk_t *chunk, monitor_thresholds_t *thresholds)
+{
+    capture_file_thresholds_t payload;
+
+    if (chunk->type != CAPTURE_CHUNK_THRESHOLDS || chunk->length != sizeof(payload))
+    {
+        return false;
+    }
+    memcpy(&payload, chunk->payload, sizeof(payload));
+    thresholds->warning = payload.warning;
+    thresholds->danger = payload.danger;
+    thresholds->gap = payload.gap;
+    thresholds->metric = payload.metric < MONITOR_METRIC_COUNT ? (monitor_metric_t)payload.metric
+                                                               : MONITOR_METRIC_LEVEL;
+    return true;
+}
+
+bool capture_file_gap(const capture_chunk_t *chunk, uint32_t *lost)
+{
+    if (chunk->type != CAPTURE_CHUNK_GAP || chunk->length != 4)
+    {
+        return false;
+    }
+    *lost = capture_get32(chunk->payload);
+    return true;
+}
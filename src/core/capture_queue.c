@@ -0,0 +1,71 @@
+#include "capture_queue.h"
+
+void capture_queue_init(capture_queue_t *queue, uint16_t *buffer, uint32_t block_len)
+{
+    queue->halves[0] = buffer;
+    queue->halves[1] = buffer + block_len;
+    queue->block_len = block_len;
+    queue->produced = 0;
+    queue->consumed = 0;
+    queue->dropped = 0;
+    queue->overruns = 0;
+}
+
+void capture_queue_complete(capture_queue_t *queue, unsigned half)
+{
+    uint32_t produced = queue->produced;
+
+    // A half finishing out of turn means a whole block went by unseen
+    if ((produced & 1u) != half)
+    {
+        produced++;
+    }
+    queue->produced = produced + 1;
+}
+
+void capture_queue_on_irq(capture_queue_t *queue, unsigned pending_mask, unsigned filling_half)
+{
+    // The half being refilled finished before the other one, so it goes first
+    for (unsigned n = 0; n < 2; n++)
+    {
+        unsigned half = (filling_half + n) & 1u;
+        if (pending_mask & (1u << half))
+        {
+            capture_queue_complete(queue, half);
+        }
+    }
+}
+
+bool capture_queue_acquire(capture_queue_t *queue, capture_block_t *block)
+{
+    uint32_t produced = queue->produced;
+
+    if (produced == queue->consumed)
+    {
+        return false;
+    }
+
+    // Only the newest block is still intact, anything older is being rewritten
+    uint32_t skipped = produced - 1 - queue->consumed;
+    queue->dropped += skipped;
+    queue->consumed = produced - 1;
+
+    block->seq = queue->consumed;
+    block->samples = queue->halves[block->seq & 1u];
+    block->len = queue->block_len;
+    block->lost = skipped * queue->block_len;
+    return true;
+}
+
+bool capture_queue_release(capture_queue_t *queue, const capture_block_t *block)
+{
+    queue->consumed = block->seq + 1;
+
+    // Once block seq + 1 completes the DMA is back in this block's half
+    if (queue->produced - block->seq > 1)
+    {
+        queue->overruns++;
+        return false;
+    }
+    return true;
+}
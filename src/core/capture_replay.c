@@ -0,0 +1,109 @@
+#include "capture_replay.h"
+#include "capture_file.h"
+
+#include <string.h>
+
+#define CAPTURE_REPLAY_FNV_BASIS 0xCBF29CE484222325ull
+#define CAPTURE_REPLAY_FNV_PRIME 0x100000001B3ull
+
+// Values are hashed as 32-bit little endian, the same on any host
+static uint64_t capture_replay_hash(uint64_t hash, int32_t value)
+{
+    for (unsigned byte = 0; byte < 4; byte++)
+    {
+        hash = (hash ^ (uint8_t)((uint32_t)value >> (byte * 8))) * CAPTURE_REPLAY_FNV_PRIME;
+    }
+    return hash;
+}
+
+bool capture_replay(noise_pipeline_t *pipeline, const uint8_t *bytes, size_t len, capture_replay_fn trace,
+                    void *ctx, capture_replay_result_t *result)
+{
+    static uint16_t samples[CAPTURE_REPLAY_MAX_SAMPLES];
+    capture_file_header_t header;
+
+    memset(result, 0, sizeof(*result));
+    result->hash = CAPTURE_REPLAY_FNV_BASIS;
+    if (len < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if (!capture_file_header_check(&header) || header.block_samples > CAPTURE_REPLAY_MAX_SAMPLES ||
+        !noise_pipeline_init(pipeline, &header.calibration, header.adc_vref_mv,
+                             (weighting_curve_t)header.weighting, header.spectrum_log2, header.sample_rate))
+    {
+        return false;
+    }
+
+    monitor_thresholds_t thresholds = {
+        NOISE_THRESHOLD_WARNING, NOISE_THRESHOLD_DANGER, DEFAULT_GAP, MONITOR_METRIC_LEVEL};
+    bool started = false;
+    bool gap = false;
+    uint32_t next = 0;
+    size_t offset = sizeof(header);
+    capture_chunk_t chunk;
+    size_t used;
+
+    while ((used = capture_file_read_chunk(bytes + offset, len - offset, &chunk)) > 0)
+    {
+        offset += used;
+        if (capture_file_thresholds(&chunk, &thresholds))
+        {
+            result->thresholds++;
+            continue;
+        }
+        uint32_t lost;
+        if (capture_file_gap(&chunk, &lost))
+        {
+            gap = true;
+            continue;
+        }
+        if (chunk.type != CAPTURE_CHUNK_BLOCK)
+        {
+            result->unknown++;
+            continue;
+        }
+
+        // The spectrum takes a whole block whatever the chunk holds, so a
+        // short one counts as damage
+        uint32_t count = capture_file_unpack(&chunk, samples, CAPTURE_REPLAY_MAX_SAMPLES);
+        if (count != header.block_samples)
+        {
+            break;
+        }
+        if (started && chunk.block > next)
+        {
+            result->missing += chunk.block - next;
+        }
+        if (gap || (started && chunk.block != next))
+        {
+            noise_pipeline_restart(pipeline);
+            result->gaps++;
+            gap = false;
+        }
+        started = true;
+        next = chunk.block + 1;
+
+        capture_replay_trace_t record = {.block = chunk.block};
+        record.state = noise_pipeline_process(pipeline, samples, count, &thresholds, &record.metric_level);
+        record.level = pipeline->level.level;
+        record.fast = pipeline->level.fast;
+        record.slow = pipeline->level.slow;
+        record.leq = pipeline->level.leq;
+
+        const int32_t fields[] = {record.level, record.fast, record.slow, record.leq, record.metric_level,
+                                  (int32_t)record.state};
+        for (unsigned f = 0; f < sizeof(fields) / sizeof(fields[0]); f++)
+        {
+            result->hash = capture_replay_hash(result->hash, fields[f]);
+        }
+        result->blocks++;
+        if (trace)
+        {
+            trace(&record, ctx);
+        }
+    }
+    result->damaged = offset < len || used > 0;
+    return true;
+}
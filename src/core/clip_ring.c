@@ -0,0 +1,240 @@
+#include "clip_ring.h"
+#include "decimator.h"
+
+#include <string.h>
+
+#define CLIP_ULAW_BIAS 0x84
+#define CLIP_ULAW_MAX 32635
+
+static const int16_t clip_adpcm_steps[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,    25,    28,
+    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,
+    544,   598,   658,   724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,
+    9493,  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static const int8_t clip_adpcm_index_steps[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+static int32_t clip_clamp(int32_t value, int32_t low, int32_t high)
+{
+    return value < low ? low : value > high ? high : value;
+}
+
+static int32_t clip_pcm(uint16_t sample)
+{
+    return clip_clamp(((int32_t)sample - DECIMATOR_MIDSCALE) * 16, INT16_MIN, INT16_MAX);
+}
+
+static uint8_t clip_ulaw_encode(int32_t pcm)
+{
+    uint8_t sign = pcm < 0 ? 0x80 : 0;
+    int32_t magnitude = clip_clamp(pcm < 0 ? -pcm : pcm, 0, CLIP_ULAW_MAX) + CLIP_ULAW_BIAS;
+    int exponent = 7;
+
+    for (int32_t mask = 0x4000; exponent > 0 && !(magnitude & mask); mask >>= 1)
+    {
+        exponent--;
+    }
+    return (uint8_t)~(sign | exponent << 4 | ((magnitude >> (exponent + 3)) & 0x0F));
+}
+
+static int16_t clip_ulaw_decode(uint8_t code)
+{
+    code = (uint8_t)~code;
+    int32_t magnitude = ((((code & 0x0F) << 3) + CLIP_ULAW_BIAS) << ((code >> 4) & 0x07)) - CLIP_ULAW_BIAS;
+    return (int16_t)(code & 0x80 ? -magnitude : magnitude);
+}
+
+// Moves the predictor by what the nibble says and adapts the step; the
+// encoder and the decoder both go through here so they cannot drift apart
+static void clip_adpcm_apply(int32_t *predictor, int32_t *index, unsigned nibble)
+{
+    int32_t step = clip_adpcm_steps[*index];
+    int32_t delta = step >> 3;
+
+    if (nibble & 4)
+    {
+        delta += step;
+    }
+    if (nibble & 2)
+    {
+        delta += step >> 1;
+    }
+    if (nibble & 1)
+    {
+        delta += step >> 2;
+    }
+    *predictor = clip_clamp(*predictor + (nibble & 8 ? -delta : delta), INT16_MIN, INT16_MAX);
+    *index = clip_clamp(*index + clip_adpcm_index_steps[nibble & 7], 0, 88);
+}
+
+static unsigned clip_adpcm_encode(clip_encoder_t *encoder, int32_t pcm)
+{
+    int32_t diff = pcm - encoder->predictor;
+    int32_t step = clip_adpcm_steps[encoder->index];
+    unsigned nibble = 0;
+
+    if (diff < 0)
+    {
+        nibble = 8;
+        diff = -diff;
+    }
+    for (unsigned bit = 4; bit > 0; bit >>= 1)
+    {
+        if (diff >= step)
+        {
+            nibble |= bit;
+            diff -= step;
+        }
+        step >>= 1;
+    }
+    clip_adpcm_apply(&encoder->predictor, &encoder->index, nibble);
+    return nibble;
+}
+
+void clip_encoder_init(clip_encoder_t *encoder, clip_codec_t codec)
+{
+    encoder->codec = codec;
+    encoder->predictor = 0;
+    encoder->index = 0;
+}
+
+uint32_t clip_encode(clip_encoder_t *encoder, const uint16_t *samples, uint32_t count, uint8_t *out)
+{
+    if (encoder->codec == CLIP_CODEC_ULAW)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            out[i] = clip_ulaw_encode(clip_pcm(samples[i]));
+        }
+        return count;
+    }
+
+    out[0] = (uint8_t)encoder->predictor;
+    out[1] = (uint8_t)((uint32_t)encoder->predictor >> 8);
+    out[2] = (uint8_t)encoder->index;
+    out[3] = 0;
+    uint8_t *packed = out + CLIP_ADPCM_HEADER;
+    for (uint32_t i = 0; i < count; i += 2)
+    {
+        unsigned low = clip_adpcm_encode(encoder, clip_pcm(samples[i]));
+        unsigned high = clip_adpcm_encode(encoder, clip_pcm(samples[i + 1]));
+        *packed++ = (uint8_t)(low | high << 4);
+    }
+    return CLIP_ADPCM_HEADER + count / 2;
+}
+
+void clip_decode(clip_codec_t codec, const uint8_t *in, uint32_t count, int16_t *pcm)
+{
+    if (codec == CLIP_CODEC_ULAW)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            pcm[i] = clip_ulaw_decode(in[i]);
+        }
+        return;
+    }
+
+    int32_t predictor = (int16_t)(in[0] | in[1] << 8);
+    int32_t index = clip_clamp(in[2], 0, 88);
+    const uint8_t *packed = in + CLIP_ADPCM_HEADER;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        clip_adpcm_apply(&predictor, &index, i % 2 ? packed[i / 2] >> 4 : packed[i / 2] & 0x0F);
+        pcm[i] = (int16_t)predictor;
+    }
+}
+
+void clip_ring_init(clip_ring_t *ring, uint8_t *storage, uint32_t blocks, clip_codec_t codec,
+                    uint32_t block_samples, uint32_t pre_blocks, uint32_t post_blocks)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->storage = storage;
+    ring->blocks = blocks;
+    ring->block_samples = block_samples;
+    ring->block_bytes = CLIP_BLOCK_BYTES(codec, block_samples);
+    ring->pre_blocks = pre_blocks;
+    ring->post_blocks = post_blocks;
+    clip_encoder_init(&ring->encoder, codec);
+}
+
+bool clip_ring_record(clip_ring_t *ring, const uint16_t *samples)
+{
+    unsigned recorded = atomic_load_explicit(&ring->recorded, memory_order_relaxed);
+
+    if (atomic_load_explicit(&ring->held, memory_order_acquire) &&
+        recorded - atomic_load_explicit(&ring->read, memory_order_acquire) >= ring->blocks)
+    {
+        // The next block recorded does not follow on from the last one
+        ring->first = recorded;
+        ring->dropped++;
+        return false;
+    }
+
+    clip_encode(&ring->encoder, samples, ring->block_samples,
+                ring->storage + (recorded % ring->blocks) * ring->block_bytes);
+    atomic_store_explicit(&ring->recorded, recorded + 1, memory_order_release);
+    return true;
+}
+
+void clip_ring_gap(clip_ring_t *ring)
+{
+    ring->first = atomic_load_explicit(&ring->recorded, memory_order_relaxed);
+}
+
+bool clip_ring_trigger(clip_ring_t *ring)
+{
+    unsigned recorded = atomic_load_explicit(&ring->recorded, memory_order_relaxed);
+
+    if (atomic_load_explicit(&ring->held, memory_order_acquire))
+    {
+        ring->missed++;
+        return false;
+    }
+    if (recorded == ring->first)
+    {
+        return false;
+    }
+
+    ring->trigger = recorded - 1;
+    ring->start = recorded - ring->first > ring->pre_blocks ? recorded - ring->pre_blocks : ring->first;
+    ring->end = recorded + ring->post_blocks;
+    ring->clips++;
+    atomic_store_explicit(&ring->read, ring->start, memory_order_relaxed);
+    atomic_store_explicit(&ring->held, true, memory_order_release);
+    return true;
+}
+
+bool clip_ring_peek(const clip_ring_t *ring, clip_block_t *block)
+{
+    if (!atomic_load_explicit(&ring->held, memory_order_acquire))
+    {
+        return false;
+    }
+
+    unsigned read = atomic_load_explicit(&ring->read, memory_order_relaxed);
+    if (read == atomic_load_explicit(&ring->recorded, memory_order_acquire))
+    {
+        return false;
+    }
+
+    block->data = ring->storage + (read % ring->blocks) * ring->block_bytes;
+    block->bytes = ring->block_bytes;
+    block->clip = ring->clips - 1;
+    block->index = read - ring->start;
+    block->count = ring->end - ring->start;
+    block->trigger = ring->trigger - ring->start;
+    return true;
+}
+
+void clip_ring_release(clip_ring_t *ring)
+{
+    unsigned read = atomic_load_explicit(&ring->read, memory_order_relaxed) + 1;
+
+    atomic_store_explicit(&ring->read, read, memory_order_release);
+    if (read == ring->end)
+    {
+        atomic_store_explicit(&ring->held, false, memory_order_release);
+    }
+}
@@ -0,0 +1,16 @@
+#include "crc16.h"
+
+// A byte at a time without a table: the polynomial has only three taps,
+// so the feedback can be folded with shifts
+uint16_t crc16_update(uint16_t crc, const void *data, size_t len)
+{
+    const uint8_t *bytes = data;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t x = (uint8_t)(crc >> 8) ^ bytes[i];
+        x ^= x >> 4;
+        crc = (uint16_t)((crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x);
+    }
+    return crc;
+}
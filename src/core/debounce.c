@@ -0,0 +1,81 @@
+#include "debounce.h"
+
+static uint32_t debounce_remaining(uint32_t due_ms, uint32_t now_ms)
+{
+    int32_t left = (int32_t)(due_ms - now_ms);
+    return left > 0 ? (uint32_t)left : 0;
+}
+
+void debounce_init(debounce_t *button, const debounce_config_t *config, bool pressed)
+{
+    button->config = config;
+    button->pressed = pressed;
+    button->settling = false;
+    button->repeating = false;
+    button->edge_ms = 0;
+    button->repeat_at_ms = 0;
+    button->interval_ms = 0;
+    button->repeats = 0;
+}
+
+void debounce_edge(debounce_t *button, uint32_t now_ms)
+{
+    button->settling = true;
+    button->edge_ms = now_ms;
+}
+
+debounce_event_t debounce_update(debounce_t *button, bool level, uint32_t now_ms)
+{
+    const debounce_config_t *config = button->config;
+
+    // Repeats pause while a held button chatters
+    if (button->settling)
+    {
+        if (debounce_remaining(button->edge_ms + config->settle_ms, now_ms) > 0)
+        {
+            return DEBOUNCE_NONE;
+        }
+        button->settling = false;
+        if (level != button->pressed)
+        {
+            button->pressed = level;
+            button->repeating = level && config->hold_ms > 0;
+            if (!level)
+            {
+                // repeats stays, so a release can tell a long press from a tap
+                return DEBOUNCE_RELEASE;
+            }
+            button->repeat_at_ms = now_ms + config->hold_ms;
+            button->interval_ms = config->repeat_ms;
+            button->repeats = 0;
+            return DEBOUNCE_PRESS;
+        }
+    }
+
+    if (button->repeating && debounce_remaining(button->repeat_at_ms, now_ms) == 0)
+    {
+        button->repeats++;
+        button->repeating = button->interval_ms > 0;
+
+        // From now rather than from when it was due, so a late caller gets
+        // one repeat instead of a burst
+        button->repeat_at_ms = now_ms + button->interval_ms;
+        uint32_t next = button->interval_ms - button->interval_ms / 4;
+        button->interval_ms = next > config->repeat_min_ms ? next : config->repeat_min_ms;
+        return DEBOUNCE_REPEAT;
+    }
+    return DEBOUNCE_NONE;
+}
+
+uint32_t debounce_wait_ms(const debounce_t *button, uint32_t now_ms)
+{
+    if (button->settling)
+    {
+        return debounce_remaining(button->edge_ms + button->config->settle_ms, now_ms);
+    }
+    if (button->repeating)
+    {
+        return debounce_remaining(button->repeat_at_ms, now_ms);
+    }
+    return DEBOUNCE_IDLE;
+}
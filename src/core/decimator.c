@@ -0,0 +1,114 @@
+#include "decimator.h"
+
+#include <string.h>
+
+bool decimator_init(decimator_t *decimator, uint32_t audio_rate, unsigned decimation)
+{
+    memset(decimator, 0, sizeof(*decimator));
+
+    for (unsigned i = 0; i < DSP_DECIMATOR_CONFIGS; i++)
+    {
+        if (dsp_decimator_configs[i].audio_rate == audio_rate)
+        {
+            decimator->config = &dsp_decimator_configs[i];
+        }
+    }
+    if (decimator->config == NULL || decimator_ratio(decimator) != decimation)
+    {
+        decimator->config = NULL;
+        return false;
+    }
+
+    // The CIC gains ratio^order; keep 4 of those bits as fraction
+    decimator->cic_shift = DSP_CIC_ORDER * __builtin_ctz(decimator->config->cic_ratio) - 4;
+    return true;
+}
+
+unsigned decimator_ratio(const decimator_t *decimator)
+{
+    return decimator->config->cic_ratio * 2u;
+}
+
+void decimator_reset(decimator_t *decimator)
+{
+    const dsp_decimator_config_t *config = decimator->config;
+    unsigned cic_shift = decimator->cic_shift;
+
+    memset(decimator, 0, sizeof(*decimator));
+    decimator->config = config;
+    decimator->cic_shift = cic_shift;
+}
+
+static uint16_t decimator_fir(const decimator_t *decimator)
+{
+    const int16_t *taps = decimator->config->fir_q14;
+    const int16_t *window = decimator->history + decimator->head;
+    int32_t acc = 0;
+
+    for (unsigned k = 0; k < DSP_DECIMATOR_TAPS; k++)
+    {
+        acc += (int32_t)taps[k] * window[k];
+    }
+
+    // Q14 taps on Q4 counts, rounded back to counts
+    int32_t sample = ((acc + (1 << 17)) >> 18) + DECIMATOR_MIDSCALE;
+    return (uint16_t)(sample < 0 ? 0 : sample > 4095 ? 4095 : sample);
+}
+
+uint32_t decimator_process(decimator_t *decimator, const uint16_t *raw, uint32_t count, uint16_t *audio)
+{
+    const unsigned ratio = decimator->config->cic_ratio;
+    uint32_t i0 = decimator->integrators[0];
+    uint32_t i1 = decimator->integrators[1];
+    uint32_t i2 = decimator->integrators[2];
+    uint32_t i3 = decimator->integrators[3];
+    uint32_t i4 = decimator->integrators[4];
+    uint32_t written = 0;
+
+    _Static_assert(DSP_CIC_ORDER == 5, "integrators are unrolled for order 5");
+
+    for (uint32_t n = 0; n < count; n++)
+    {
+        i0 += (uint32_t)((int32_t)raw[n] - DECIMATOR_MIDSCALE);
+        i1 += i0;
+        i2 += i1;
+        i3 += i2;
+        i4 += i3;
+
+        if (++decimator->cic_phase < ratio)
+        {
+            continue;
+        }
+        decimator->cic_phase = 0;
+
+        uint32_t value = i4;
+        for (unsigned k = 0; k < DSP_CIC_ORDER; k++)
+        {
+            uint32_t delayed = decimator->combs[k];
+            decimator->combs[k] = value;
+            value -= delayed;
+        }
+
+        // Newest CIC output last in the window
+        int16_t cic_q4 = (int16_t)((int32_t)value >> decimator->cic_shift);
+        decimator->head = decimator->head == DSP_DECIMATOR_TAPS - 1 ? 0 : decimator->head + 1;
+        decimator->history[decimator->head + DSP_DECIMATOR_TAPS - 1] = cic_q4;
+        if (decimator->head > 0)
+        {
+            decimator->history[decimator->head - 1] = cic_q4;
+        }
+
+        if (++decimator->fir_phase == 2)
+        {
+            decimator->fir_phase = 0;
+            audio[written++] = decimator_fir(decimator);
+        }
+    }
+
+    decimator->integrators[0] = i0;
+    decimator->integrators[1] = i1;
+    decimator->integrators[2] = i2;
+    decimator->integrators[3] = i3;
+    decimator->integrators[4] = i4;
+    return written;
+}
@@ -0,0 +1,239 @@
+#include "event_log.h"
+#include "crc16.h"
+
+#include <stddef.h>
+#include <string.h>
+
+_Static_assert(sizeof(event_record_t) == EVENT_LOG_RECORD_SIZE, "records must fill their slot");
+_Static_assert(sizeof(event_sector_header_t) == EVENT_LOG_RECORD_SIZE, "the header takes slot 0");
+_Static_assert((EVENT_LOG_QUEUE & (EVENT_LOG_QUEUE - 1)) == 0, "queue indices wrap");
+
+static const uint8_t *event_log_slot(const event_log_t *log, uint32_t sector, uint32_t slot)
+{
+    return log->flash.base + sector * EVENT_LOG_SECTOR_SIZE + slot * EVENT_LOG_RECORD_SIZE;
+}
+
+static bool event_log_erased(const uint8_t *bytes)
+{
+    for (unsigned i = 0; i < EVENT_LOG_RECORD_SIZE; i++)
+    {
+        if (bytes[i] != 0xFF)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool event_log_header(const event_log_t *log, uint32_t sector, event_sector_header_t *header)
+{
+    memcpy(header, event_log_slot(log, sector, 0), sizeof(*header));
+    return header->magic == EVENT_LOG_MAGIC && header->version == EVENT_LOG_VERSION &&
+           header->crc == crc16_update(CRC16_INIT, header, offsetof(event_sector_header_t, crc));
+}
+
+uint32_t event_log_next_seq(const event_log_t *log)
+{
+    return log->first_seq + log->slot - 1;
+}
+
+uint32_t event_log_oldest_seq(const event_log_t *log)
+{
+    uint32_t next = event_log_next_seq(log);
+    uint32_t kept = (log->flash.sectors - 1 - log->spare) * EVENT_LOG_RECORDS_PER_SECTOR + log->slot - 1;
+    return next > kept ? next - kept : 0;
+}
+
+uint32_t event_log_pending(const event_log_t *log)
+{
+    return atomic_load_explicit(&log->queued, memory_order_acquire) -
+           atomic_load_explicit(&log->flushed, memory_order_acquire);
+}
+
+bool event_log_read(const event_log_t *log, uint32_t seq, event_record_t *record)
+{
+    if (seq >= event_log_next_seq(log) || seq < event_log_oldest_seq(log))
+    {
+        return false;
+    }
+
+    // Sectors before the active one hold whole runs of records
+    uint32_t back = seq >= log->first_seq ? 0 : (log->first_seq - 1 - seq) / EVENT_LOG_RECORDS_PER_SECTOR + 1;
+    uint32_t sector = (log->active + log->flash.sectors - back) % log->flash.sectors;
+    uint32_t first_seq = log->first_seq - back * EVENT_LOG_RECORDS_PER_SECTOR;
+
+    event_sector_header_t header;
+    if (!event_log_header(log, sector, &header) || header.first_seq != first_seq)
+    {
+        return false;
+    }
+
+    memcpy(record, event_log_slot(log, sector, seq - first_seq + 1), sizeof(*record));
+    return record->crc == crc16_update(CRC16_INIT, record, offsetof(event_record_t, crc));
+}
+
+void event_log_mount(event_log_t *log, const event_log_flash_t *flash)
+{
+    memset(log, 0, sizeof(*log));
+    log->flash = *flash;
+    memset(log->page, 0xFF, sizeof(log->page));
+
+    // The newest sector has the highest first_seq. With none, the log
+    // starts as if the last sector had just filled so sector 0 opens first.
+    bool found = false;
+    for (uint32_t sector = 0; sector < flash->sectors; sector++)
+    {
+        event_sector_header_t header;
+        if (event_log_header(log, sector, &header) && (!found || (int32_t)(header.first_seq - log->first_seq) > 0))
+        {
+            found = true;
+            log->active = sector;
+            log->first_seq = header.first_seq;
+        }
+    }
+    if (!found)
+    {
+        log->active = flash->sectors - 1;
+        log->first_seq = 0u - EVENT_LOG_RECORDS_PER_SECTOR;
+        log->slot = EVENT_LOG_SLOTS;
+        return;
+    }
+
+    // Slots fill in order, so the used ones (torn ones included) come
+    // before the erased ones
+    uint32_t low = 1;
+    uint32_t high = EVENT_LOG_SLOTS;
+    while (low < high)
+    {
+        uint32_t mid = (low + high) / 2;
+        if (event_log_erased(event_log_slot(log, log->active, mid)))
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+    log->slot = low;
+
+    // Reprogramming the page keeps whatever is already in it, torn or not
+    if (log->slot < EVENT_LOG_SLOTS)
+    {
+        uint32_t page_slot = log->slot & ~(uint32_t)(EVENT_LOG_SLOTS_PER_PAGE - 1);
+        memcpy(log->page, event_log_slot(log, log->active, page_slot), sizeof(log->page));
+    }
+
+    // Past a torn record to the last one written whole. A power cut tears
+    // at most the slot being programmed, so this stays within a page.
+    uint32_t next = event_log_next_seq(log);
+    uint32_t oldest = event_log_oldest_seq(log);
+    for (uint32_t seq = next; seq-- > oldest && next - seq <= EVENT_LOG_SLOTS_PER_PAGE;)
+    {
+        event_record_t record;
+        if (event_log_read(log, seq, &record))
+        {
+            log->boot = record.boot + 1;
+            break;
+        }
+    }
+}
+
+bool event_log_append(event_log_t *log, const event_record_t *record)
+{
+    unsigned queued = atomic_load_explicit(&log->queued, memory_order_relaxed);
+    unsigned flushed = atomic_load_explicit(&log->flushed, memory_order_acquire);
+
+    if (queued - flushed >= EVENT_LOG_QUEUE)
+    {
+        log->dropped++;
+        return false;
+    }
+
+    event_record_t *entry = &log->queue[queued % EVENT_LOG_QUEUE];
+    *entry = *record;
+    entry->boot = log->boot;
+    entry->crc = crc16_update(CRC16_INIT, entry, offsetof(event_record_t, crc));
+    atomic_store_explicit(&log->queued, queued + 1, memory_order_release);
+    return true;
+}
+
+// The erase count comes from the old header, which the erase clears
+static uint32_t event_log_erase(event_log_t *log, uint32_t sector)
+{
+    event_sector_header_t header;
+    uint32_t erase_count = event_log_header(log, sector, &header) ? header.erase_count : 0;
+
+    log->flash.erase(log->flash.ctx, sector * EVENT_LOG_SECTOR_SIZE);
+    return erase_count;
+}
+
+bool event_log_prepare(event_log_t *log)
+{
+    if (log->spare || EVENT_LOG_SLOTS - log->slot > EVENT_LOG_PREPARE_SLOTS)
+    {
+        return false;
+    }
+    log->spare_erase_count = event_log_erase(log, (log->active + 1) % log->flash.sectors);
+    log->spare = true;
+    return true;
+}
+
+// Erases the sector after the active one unless that was done ahead,
+// dropping the oldest records, and claims it with a header before any
+// record goes in
+static void event_log_open(event_log_t *log)
+{
+    uint32_t sector = (log->active + 1) % log->flash.sectors;
+    uint32_t erase_count = log->spare ? log->spare_erase_count : event_log_erase(log, sector);
+    event_sector_header_t header = {
+        .magic = EVENT_LOG_MAGIC,
+        .first_seq = event_log_next_seq(log),
+        .erase_count = erase_count + 1,
+        .version = EVENT_LOG_VERSION};
+    header.crc = crc16_update(CRC16_INIT, &header, offsetof(event_sector_header_t, crc));
+
+    memset(log->page, 0xFF, sizeof(log->page));
+    memcpy(log->page, &header, sizeof(header));
+    log->flash.program(log->flash.ctx, sector * EVENT_LOG_SECTOR_SIZE, log->page);
+
+    log->active = sector;
+    log->first_seq = header.first_seq;
+    log->slot = 1;
+    log->spare = false;
+}
+
+uint32_t event_log_flush(event_log_t *log)
+{
+    unsigned flushed = atomic_load_explicit(&log->flushed, memory_order_relaxed);
+    unsigned queued = atomic_load_explicit(&log->queued, memory_order_acquire);
+    uint32_t written = 0;
+
+    while (flushed != queued)
+    {
+        if (log->slot == EVENT_LOG_SLOTS)
+        {
+            event_log_open(log);
+        }
+
+        // As many records as fit in the current page, then one program
+        uint32_t page_slot = log->slot & ~(uint32_t)(EVENT_LOG_SLOTS_PER_PAGE - 1);
+        while (flushed != queued && log->slot < page_slot + EVENT_LOG_SLOTS_PER_PAGE)
+        {
+            memcpy(log->page + (log->slot - page_slot) * EVENT_LOG_RECORD_SIZE, &log->queue[flushed % EVENT_LOG_QUEUE],
+                   EVENT_LOG_RECORD_SIZE);
+            log->slot++;
+            flushed++;
+            written++;
+        }
+        log->flash.program(log->flash.ctx, log->active * EVENT_LOG_SECTOR_SIZE + page_slot * EVENT_LOG_RECORD_SIZE,
+                           log->page);
+        atomic_store_explicit(&log->flushed, flushed, memory_order_release);
+
+        if (log->slot % EVENT_LOG_SLOTS_PER_PAGE == 0)
+        {
+            memset(log->page, 0xFF, sizeof(log->page));
+        }
+    }
+    return written;
+}
@@ -0,0 +1,75 @@
+#include "fft_q15.h"
+
+// Stage inputs stay below this so b * w + b * w fits 32 bits and a stage
+// can grow a component by at most 1 + sqrt(2) without overflowing
+#define FFT_Q15_SCALE_LIMIT 0x2000
+
+unsigned fft_q15(int16_t *data, unsigned log2n)
+{
+    unsigned n = 1u << log2n;
+    unsigned scaled = 0;
+    uint32_t bits = 0;
+
+    // The loader cannot see the peak after windowing, so the first stage
+    // decides from the inputs
+    for (unsigned i = 0; i < 2 * n; i++)
+    {
+        bits |= (uint32_t)(data[i] < 0 ? -data[i] : data[i]);
+    }
+
+    for (unsigned half = 1, stride = DSP_FFT_MAX_SIZE / 2; half < n; half <<= 1, stride >>= 1)
+    {
+        unsigned shift = bits >= FFT_Q15_SCALE_LIMIT ? 1 : 0;
+        scaled += shift;
+        bits = 0;
+
+        for (unsigned k = 0; k < half; k++)
+        {
+            int32_t wr = dsp_fft_cos_q15[k * stride];
+            int32_t wi = dsp_fft_sin_q15[k * stride];
+
+            for (unsigned i = k; i < n; i += 2 * half)
+            {
+                int16_t *a = data + 2 * i;
+                int16_t *b = a + 2 * half;
+
+                int32_t tr = (b[0] * wr - b[1] * wi) >> 15;
+                int32_t ti = (b[0] * wi + b[1] * wr) >> 15;
+                int32_t ar = a[0];
+                int32_t ai = a[1];
+
+                int32_t r0 = (ar + tr) >> shift;
+                int32_t i0 = (ai + ti) >> shift;
+                int32_t r1 = (ar - tr) >> shift;
+                int32_t i1 = (ai - ti) >> shift;
+
+                a[0] = (int16_t)r0;
+                a[1] = (int16_t)i0;
+                b[0] = (int16_t)r1;
+                b[1] = (int16_t)i1;
+
+                bits |= (uint32_t)((r0 < 0 ? -r0 : r0) | (i0 < 0 ? -i0 : i0) |
+                                   (r1 < 0 ? -r1 : r1) | (i1 < 0 ? -i1 : i1));
+            }
+        }
+    }
+
+    return scaled;
+}
+
+void fft_q15_load_real(int16_t *data, const uint16_t *samples, unsigned log2n,
+                       uint16_t mean, unsigned shift)
+{
+    unsigned n = 1u << log2n;
+    unsigned window_stride = DSP_FFT_MAX_SIZE >> log2n;
+    unsigned reverse_shift = DSP_FFT_MAX_LOG2 - log2n;
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        int32_t x = ((int32_t)samples[i] - mean) << shift;
+        unsigned j = dsp_bit_reverse[i] >> reverse_shift;
+
+        data[2 * j] = (int16_t)((x * dsp_hann_q15[i * window_stride]) >> 15);
+        data[2 * j + 1] = 0;
+    }
+}
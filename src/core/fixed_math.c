@@ -0,0 +1,49 @@
+#include "fixed_math.h"
+#include "dsp_tables.h"
+
+// Bit-by-bit square root, floor(sqrt(value)), no multiplies or divides
+uint32_t isqrt64(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ull << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+uint32_t log2_q16(uint32_t value)
+{
+    if (value == 0)
+    {
+        return 0;
+    }
+
+    // Mantissa as Q31 in [1, 2): the top bits pick the table entry, the
+    // next ones interpolate towards the following entry
+    unsigned exponent = 31 - __builtin_clz(value);
+    uint32_t mantissa = value << (31 - exponent);
+    unsigned index = (mantissa >> (31 - DSP_LOG2_TABLE_BITS)) & ((1u << DSP_LOG2_TABLE_BITS) - 1);
+    uint32_t fraction = (mantissa >> (31 - DSP_LOG2_TABLE_BITS - 10)) & 1023;
+
+    uint32_t low = dsp_log2_q16[index];
+    uint32_t high = dsp_log2_q16[index + 1];
+    return (exponent << 16) + low + (((high - low) * fraction + 512) >> 10);
+}
@@ -0,0 +1,203 @@
+#include "history.h"
+#include "fixed_math.h"
+
+#include <string.h>
+
+_Static_assert(sizeof(history_t) <= HISTORY_RAM_BUDGET, "history over its RAM budget");
+
+// Seconds per minute and minutes per hour
+#define HISTORY_ROLLUP 60
+
+static void history_accumulator_reset(history_accumulator_t *acc)
+{
+    memset(acc, 0, sizeof(*acc));
+    acc->min = INT16_MAX;
+    acc->max = INT16_MIN;
+}
+
+static unsigned history_bucket(int32_t level)
+{
+    int32_t bucket = (level - HISTORY_BUCKET_FLOOR_DECIDB) / HISTORY_BUCKET_DECIDB;
+    if (bucket < 0)
+    {
+        return 0;
+    }
+    return bucket < HISTORY_BUCKETS ? (unsigned)bucket : HISTORY_BUCKETS - 1;
+}
+
+void history_init(history_t *history, const calibration_t *calibration, uint32_t block_samples,
+                  uint32_t sample_rate)
+{
+    memset(history, 0, sizeof(*history));
+    history->calibration = calibration;
+    history->sample_rate = sample_rate;
+    history->block_samples = block_samples;
+
+    for (unsigned r = 0; r < HISTORY_RESOLUTION_COUNT; r++)
+    {
+        history_accumulator_reset(&history->pending[r]);
+    }
+
+    history->rings[HISTORY_SECOND] = (history_ring_t){history->seconds, HISTORY_SECONDS + 1};
+    history->rings[HISTORY_MINUTE] = (history_ring_t){history->minutes, HISTORY_MINUTES + 1};
+    history->rings[HISTORY_HOUR] = (history_ring_t){history->hours, HISTORY_HOURS + 1};
+}
+
+int16_t history_percentile(const uint32_t *buckets, uint32_t total, unsigned percent)
+{
+    // Walk down from the loudest bucket until `percent` of the counts are
+    // above, in hundredths of a count to keep the target exact
+    uint64_t target = (uint64_t)total * percent;
+    uint64_t above = 0;
+
+    for (int b = HISTORY_BUCKETS - 1; b >= 0; b--)
+    {
+        uint64_t count = (uint64_t)buckets[b] * 100;
+        if (count > 0 && above + count >= target)
+        {
+            uint64_t inside = target - above;
+            int32_t top = HISTORY_BUCKET_FLOOR_DECIDB + (b + 1) * HISTORY_BUCKET_DECIDB;
+            return (int16_t)(top - (int32_t)((inside * HISTORY_BUCKET_DECIDB + count / 2) / count));
+        }
+        above += count;
+    }
+    return HISTORY_BUCKET_FLOOR_DECIDB;
+}
+
+static void history_summarise(const history_t *history, const history_accumulator_t *acc,
+                              history_record_t *record)
+{
+    uint64_t mean_square = acc->energy / acc->blocks;
+
+    record->min = acc->min;
+    record->max = acc->max;
+    record->leq = (int16_t)calibration_spl_decidb(history->calibration, isqrt64(mean_square));
+    record->l10 = history_percentile(acc->buckets, acc->blocks, 10);
+    record->l90 = history_percentile(acc->buckets, acc->blocks, 90);
+    record->gaps = (uint16_t)(acc->gaps < UINT16_MAX ? acc->gaps : UINT16_MAX);
+}
+
+// The record is complete before head moves past it
+static void history_push(history_ring_t *ring, const history_record_t *record)
+{
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    ring->records[head % ring->capacity] = *record;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+static void history_fold(history_accumulator_t *into, const history_accumulator_t *from)
+{
+    into->energy += from->energy;
+    into->blocks += from->blocks;
+    into->periods++;
+    into->gaps += from->gaps;
+    into->min = from->min < into->min ? from->min : into->min;
+    into->max = from->max > into->max ? from->max : into->max;
+    for (unsigned b = 0; b < HISTORY_BUCKETS; b++)
+    {
+        into->buckets[b] += from->buckets[b];
+    }
+}
+
+// Closes the period of `resolution` and rolls it into the next coarser one,
+// which closes in turn once it holds HISTORY_ROLLUP periods
+static void history_close(history_t *history, history_resolution_t resolution)
+{
+    history_accumulator_t *acc = &history->pending[resolution];
+    history_record_t record;
+
+    history_summarise(history, acc, &record);
+    history_push(&history->rings[resolution], &record);
+
+    if (resolution + 1 < HISTORY_RESOLUTION_COUNT)
+    {
+        history_accumulator_t *next = &history->pending[resolution + 1];
+        history_fold(next, acc);
+        if (next->periods == HISTORY_ROLLUP)
+        {
+            history_close(history, resolution + 1);
+        }
+    }
+    history_accumulator_reset(acc);
+}
+
+void history_add(history_t *history, uint32_t fast_q8, uint32_t block_q8)
+{
+    history_accumulator_t *acc = &history->pending[HISTORY_SECOND];
+    int16_t level = (int16_t)calibration_spl_decidb(history->calibration, fast_q8);
+
+    acc->energy += (uint64_t)block_q8 * block_q8;
+    acc->blocks++;
+    acc->min = level < acc->min ? level : acc->min;
+    acc->max = level > acc->max ? level : acc->max;
+    acc->buckets[history_bucket(level)]++;
+
+    // A block that crosses the second boundary counts in the second it ends
+    // in; the remainder carries over so seconds stay exact in the long run
+    history->samples += history->block_samples;
+    if (history->samples >= history->sample_rate)
+    {
+        history->samples -= history->sample_rate;
+        history_close(history, HISTORY_SECOND);
+    }
+}
+
+void history_gap(history_t *history, uint32_t lost)
+{
+    uint32_t left = history->sample_rate - history->samples;
+
+    history->pending[HISTORY_SECOND].gaps++;
+    // Short of the boundary, so the second still closes on the next block
+    history->samples += lost < left ? lost : left - 1;
+}
+
+uint32_t history_closed(const history_t *history, history_resolution_t resolution)
+{
+    return atomic_load_explicit(&history->rings[resolution].head, memory_order_acquire);
+}
+
+uint32_t history_available(const history_t *history, history_resolution_t resolution)
+{
+    uint32_t closed = history_closed(history, resolution);
+    uint32_t depth = history->rings[resolution].capacity - 1;
+    return closed < depth ? closed : depth;
+}
+
+bool history_get(const history_t *history, history_resolution_t resolution, uint32_t age,
+                 history_record_t *record)
+{
+    const history_ring_t *ring = &history->rings[resolution];
+    unsigned head;
+
+    // Published slots are only rewritten after at least one more push, so a
+    // copy made while head stayed put is whole
+    do
+    {
+        head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (age >= head || age >= ring->capacity - 1)
+        {
+            return false;
+        }
+        *record = ring->records[(head - 1 - age) % ring->capacity];
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&ring->head, memory_order_relaxed) != head);
+
+    return true;
+}
+
+bool history_get_period(const history_t *history, history_resolution_t resolution, uint32_t period,
+                        history_record_t *record)
+{
+    const history_ring_t *ring = &history->rings[resolution];
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (period >= head || head - period >= ring->capacity)
+    {
+        return false;
+    }
+    *record = ring->records[period % ring->capacity];
+
+    // The slot is only written again once head reaches period + capacity
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&ring->head, memory_order_relaxed) - period < ring->capacity;
+}
@@ -0,0 +1,79 @@
+#include "level_graph.h"
+
+#include <stddef.h>
+
+_Static_assert(LEVEL_GRAPH_HEIGHT <= 64, "a column is built in one 64 bit word");
+
+const struct render_area level_graph_area = {
+    .start_column = LEVEL_GRAPH_LEFT,
+    .end_column = ssd1306_width - 1,
+    .start_page = LEVEL_GRAPH_FIRST_PAGE,
+    .end_page = ssd1306_n_pages - 1,
+    .buffer_length = LEVEL_GRAPH_COLUMNS * (ssd1306_n_pages - LEVEL_GRAPH_FIRST_PAGE)};
+
+// Pixels above the floor, clamped to the graph
+static int level_graph_pixels(int decidb)
+{
+    int pixels = (decidb - LEVEL_GRAPH_FLOOR_DECIDB) / LEVEL_GRAPH_DECIDB_PER_PIXEL;
+    return pixels < 0 ? 0 : pixels > LEVEL_GRAPH_HEIGHT ? LEVEL_GRAPH_HEIGHT : pixels;
+}
+
+// Bit 0 is the top row of the graph, as in a page byte
+static uint64_t level_graph_row(int decidb)
+{
+    int pixels = level_graph_pixels(decidb);
+    return pixels > 0 ? 1ull << (LEVEL_GRAPH_HEIGHT - pixels) : 0;
+}
+
+void level_graph_column(uint8_t *ssd, int x, uint32_t second, const history_record_t *record, int warning,
+                        int danger)
+{
+    uint64_t column = 0;
+
+    if (record)
+    {
+        int pixels = level_graph_pixels(record->leq);
+        column = ((1ull << pixels) - 1) << (LEVEL_GRAPH_HEIGHT - pixels);
+    }
+    if (second % 2 == 0)
+    {
+        column ^= level_graph_row(warning);
+    }
+    if (second % 4 != 3)
+    {
+        column ^= level_graph_row(danger);
+    }
+
+    uint8_t *out = ssd + LEVEL_GRAPH_FIRST_PAGE * ssd1306_width + x;
+    for (int page = 0; page < LEVEL_GRAPH_HEIGHT / ssd1306_page_height; page++)
+    {
+        out[page * ssd1306_width] = (uint8_t)(column >> (page * ssd1306_page_height));
+    }
+}
+
+// Looked up by number rather than by age, so a second closing while the
+// graph is drawn does not shift it
+static void level_graph_second(uint8_t *ssd, int x, const history_t *history, uint32_t second, int warning,
+                               int danger)
+{
+    history_record_t record;
+    uint32_t closed = history_closed(history, HISTORY_SECOND);
+    bool known = second < closed && history_get(history, HISTORY_SECOND, closed - 1 - second, &record);
+
+    level_graph_column(ssd, x, second, known ? &record : NULL, warning, danger);
+}
+
+void level_graph_draw(uint8_t *ssd, const history_t *history, uint32_t closed, int warning, int danger)
+{
+    // Seconds before boot are numbered on backwards and only get their dots
+    for (uint32_t age = 0; age < LEVEL_GRAPH_COLUMNS; age++)
+    {
+        level_graph_second(ssd, ssd1306_width - 1 - (int)age, history, closed - 1 - age, warning, danger);
+    }
+}
+
+void level_graph_scroll(uint8_t *ssd, const history_t *history, uint32_t closed, int warning, int danger)
+{
+    ssd1306_scroll_left(ssd, &level_graph_area);
+    level_graph_second(ssd, ssd1306_width - 1, history, closed - 1, warning, danger);
+}
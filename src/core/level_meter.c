@@ -0,0 +1,169 @@
+#include "level_meter.h"
+#include "fixed_math.h"
+
+#include <math.h>
+#include <string.h>
+
+#define LEVEL_METER_INPUT_SHIFT 12
+// Q12 filter output down to Q3 before squaring, so squares fit 32 bits
+#define LEVEL_METER_SQUARE_SHIFT 9
+
+bool level_meter_init(level_meter_t *meter, weighting_curve_t curve, uint32_t sample_rate)
+{
+    memset(meter, 0, sizeof(*meter));
+    meter->curve = curve;
+    meter->sample_rate = sample_rate;
+
+    for (unsigned i = 0; i < DSP_WEIGHTING_RATES; i++)
+    {
+        if (dsp_weighting_rate_hz[i] == sample_rate)
+        {
+            meter->section_count = curve == WEIGHTING_C ? DSP_C_WEIGHTING_SECTIONS : DSP_A_WEIGHTING_SECTIONS;
+            meter->coefficients = curve == WEIGHTING_C ? dsp_c_weighting_q30[i] : dsp_a_weighting_q30[i];
+        }
+    }
+    if (meter->coefficients == NULL)
+    {
+        return false;
+    }
+
+    // 1 - exp(-1 / (tau * fs)) is 1 / (tau * fs) to well within a part per
+    // thousand at these rates
+    meter->fast_alpha_q32 = (uint32_t)((1000ull << 32) / ((uint64_t)LEVEL_METER_FAST_MS * sample_rate));
+    meter->slow_alpha_q32 = (uint32_t)((1000ull << 32) / ((uint64_t)LEVEL_METER_SLOW_MS * sample_rate));
+    meter->leq_slot_samples = (uint32_t)((uint64_t)sample_rate * LEVEL_METER_LEQ_S / LEVEL_METER_LEQ_SLOTS);
+    return true;
+}
+
+static uint64_t level_meter_add_sat(uint64_t a, uint64_t b)
+{
+    return a > UINT64_MAX - b ? UINT64_MAX : a + b;
+}
+
+static inline int32_t level_meter_biquad(level_meter_section_t *state, const dsp_biquad_q30_t *c, int32_t x)
+{
+    int64_t acc = (int64_t)c->b0 * x + (int64_t)c->b1 * state->x1 + (int64_t)c->b2 * state->x2 -
+                  (int64_t)c->a1 * state->y1 - (int64_t)c->a2 * state->y2;
+
+    // Second order error feedback: the rounding noise sees (1 - z^-1)^2,
+    // which cancels the near-DC poles of the high-pass sections
+    acc += 2 * (int64_t)state->error1 - state->error2;
+
+    int32_t y = (int32_t)(acc >> 30);
+    state->error2 = state->error1;
+    state->error1 = (int32_t)(acc - ((int64_t)y << 30));
+
+    state->x2 = state->x1;
+    state->x1 = x;
+    state->y2 = state->y1;
+    state->y1 = y;
+    return y;
+}
+
+void level_meter_process(level_meter_t *meter, const uint16_t *samples, uint32_t count)
+{
+    const dsp_biquad_q30_t *coefficients = meter->coefficients;
+    unsigned section_count = meter->section_count;
+    int64_t fast = meter->fast_q38;
+    int64_t slow = meter->slow_q38;
+    uint64_t leq = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        int32_t y = ((int32_t)samples[i] - LEVEL_METER_MIDSCALE) << LEVEL_METER_INPUT_SHIFT;
+        for (unsigned s = 0; s < section_count; s++)
+        {
+            y = level_meter_biquad(&meter->sections[s], &coefficients[s], y);
+        }
+
+        int32_t y_q3 = y >> LEVEL_METER_SQUARE_SHIFT;
+        int64_t square_q6 = (int64_t)(uint32_t)(y_q3 * y_q3);
+
+        fast += (square_q6 - (fast >> 32)) * meter->fast_alpha_q32;
+        slow += (square_q6 - (slow >> 32)) * meter->slow_alpha_q32;
+        leq += (uint64_t)square_q6;
+    }
+
+    meter->fast_q38 = fast;
+    meter->slow_q38 = slow;
+    meter->block_sum_q6 = leq;
+    meter->block_samples = count;
+
+    // Slots close at block ends, so each one holds whole blocks
+    level_meter_leq_slot_t *slot = &meter->leq_slots[meter->leq_slot];
+    slot->sum_q6 = level_meter_add_sat(slot->sum_q6, leq);
+    slot->samples += count;
+    if (slot->samples >= meter->leq_slot_samples)
+    {
+        meter->leq_slot = (meter->leq_slot + 1) % LEVEL_METER_LEQ_SLOTS;
+        meter->leq_slots[meter->leq_slot] = (level_meter_leq_slot_t){0};
+    }
+}
+
+void level_meter_reset_leq(level_meter_t *meter)
+{
+    memset(meter->leq_slots, 0, sizeof(meter->leq_slots));
+    meter->leq_slot = 0;
+}
+
+void level_meter_restart(level_meter_t *meter)
+{
+    memset(meter->sections, 0, sizeof(meter->sections));
+}
+
+// Q6 mean square with 32 fraction bits to Q8 RMS
+static uint32_t level_meter_rms_q8(int64_t mean_square_q38)
+{
+    return mean_square_q38 > 0 ? isqrt64((uint64_t)mean_square_q38 >> 22) : 0;
+}
+
+uint32_t level_meter_fast_q8(const level_meter_t *meter)
+{
+    return level_meter_rms_q8(meter->fast_q38);
+}
+
+uint32_t level_meter_slow_q8(const level_meter_t *meter)
+{
+    return level_meter_rms_q8(meter->slow_q38);
+}
+
+uint32_t level_meter_leq_q8(const level_meter_t *meter)
+{
+    uint64_t sum_q6 = 0;
+    uint64_t samples = 0;
+
+    for (unsigned s = 0; s < LEVEL_METER_LEQ_SLOTS; s++)
+    {
+        sum_q6 = level_meter_add_sat(sum_q6, meter->leq_slots[s].sum_q6);
+        samples += meter->leq_slots[s].samples;
+    }
+    if (samples == 0)
+    {
+        return 0;
+    }
+    return isqrt64((sum_q6 / samples) << 10);
+}
+
+uint32_t level_meter_block_q8(const level_meter_t *meter)
+{
+    if (meter->block_samples == 0)
+    {
+        return 0;
+    }
+    return isqrt64((meter->block_sum_q6 / meter->block_samples) << 10);
+}
+
+double level_meter_response_ref(weighting_curve_t curve, double frequency)
+{
+    const double f1 = 20.598997, f2 = 107.65265, f3 = 737.86223, f4 = 12194.217;
+    double f_2 = frequency * frequency;
+
+    double c = f4 * f4 * f_2 / ((f_2 + f1 * f1) * (f_2 + f4 * f4));
+    if (curve == WEIGHTING_C)
+    {
+        return 20.0 * log10(c) + 0.062;
+    }
+
+    double a = c * f_2 / sqrt((f_2 + f2 * f2) * (f_2 + f3 * f3));
+    return 20.0 * log10(a) + 2.000;
+}
@@ -0,0 +1,91 @@
+#include "monitor_state.h"
+#include "history.h"
+#include "seqlatch.h"
+
+_Static_assert(MIN_THRESHOLD == HISTORY_BUCKET_FLOOR_DECIDB &&
+                   MAX_THRESHOLD == HISTORY_BUCKET_FLOOR_DECIDB + HISTORY_BUCKETS * HISTORY_BUCKET_DECIDB,
+               "thresholds stay where the history can tell levels apart");
+
+static seqlatch_t level_latch;
+static monitor_level_t level_copies[2];
+
+static seqlatch_t thresholds_latch;
+static monitor_thresholds_t thresholds_copies[2];
+
+void monitor_state_init(void)
+{
+    const monitor_level_t level = {0};
+    const monitor_thresholds_t thresholds = {
+        .warning = NOISE_THRESHOLD_WARNING,
+        .danger = NOISE_THRESHOLD_DANGER,
+        .gap = DEFAULT_GAP,
+        .metric = MONITOR_METRIC_LEVEL};
+
+    seqlatch_init(&level_latch, level_copies, &level, sizeof(level));
+    seqlatch_init(&thresholds_latch, thresholds_copies, &thresholds, sizeof(thresholds));
+}
+
+void monitor_state_publish_level(const monitor_level_t *level)
+{
+    seqlatch_publish(&level_latch, level_copies, level, sizeof(*level));
+}
+
+void monitor_state_publish_thresholds(const monitor_thresholds_t *thresholds)
+{
+    seqlatch_publish(&thresholds_latch, thresholds_copies, thresholds, sizeof(*thresholds));
+}
+
+uint32_t monitor_state_level(monitor_level_t *level)
+{
+    return seqlatch_read(&level_latch, level_copies, level, sizeof(*level));
+}
+
+uint32_t monitor_state_thresholds(monitor_thresholds_t *thresholds)
+{
+    return seqlatch_read(&thresholds_latch, thresholds_copies, thresholds, sizeof(*thresholds));
+}
+
+void monitor_state_snapshot(monitor_snapshot_t *snapshot)
+{
+    snapshot->level_version = monitor_state_level(&snapshot->level);
+    snapshot->thresholds_version = monitor_state_thresholds(&snapshot->thresholds);
+}
+
+static int monitor_clamp(int value, int low, int high)
+{
+    return value < low ? low : value > high ? high : value;
+}
+
+void monitor_thresholds_shift(monitor_thresholds_t *thresholds, int step)
+{
+    thresholds->warning = monitor_clamp(thresholds->warning + step, MIN_THRESHOLD, MAX_THRESHOLD - thresholds->gap);
+    thresholds->danger = thresholds->warning + thresholds->gap;
+}
+
+void monitor_thresholds_widen(monitor_thresholds_t *thresholds, int step)
+{
+    int widest = MAX_THRESHOLD - thresholds->warning;
+    thresholds->gap = monitor_clamp(thresholds->gap + step, MIN_GAP, widest < MAX_GAP ? widest : MAX_GAP);
+    thresholds->danger = thresholds->warning + thresholds->gap;
+}
+
+int monitor_level_metric(const monitor_level_t *level, monitor_metric_t metric)
+{
+    switch (metric)
+    {
+    case MONITOR_METRIC_FAST:
+        return level->fast;
+    case MONITOR_METRIC_SLOW:
+        return level->slow;
+    case MONITOR_METRIC_LEQ:
+        return level->leq;
+    default:
+        return level->level;
+    }
+}
+
+const char *monitor_metric_name(monitor_metric_t metric)
+{
+    static const char *const names[MONITOR_METRIC_COUNT] = {"Level", "Fast", "Slow", "Leq"};
+    return metric < MONITOR_METRIC_COUNT ? names[metric] : "?";
+}
@@ -0,0 +1,65 @@
+#include "noise_pipeline.h"
+
+bool noise_pipeline_init(noise_pipeline_t *pipeline, const calibration_profile_t *profile, uint32_t adc_vref_mv,
+                         weighting_curve_t weighting, unsigned spectrum_log2, uint32_t sample_rate)
+{
+    spectrum_init(&pipeline->spectrum, SPECTRUM_THIRD_OCTAVE, spectrum_log2, sample_rate);
+    pipeline->profile = *profile;
+    calibration_init(&pipeline->calibration, &pipeline->profile, adc_vref_mv);
+    return level_meter_init(&pipeline->meter, weighting, sample_rate);
+}
+
+// Filter and integrator state carry over from block to block
+void noise_pipeline_meter(noise_pipeline_t *pipeline, const uint16_t *samples, uint32_t count)
+{
+    level_meter_process(&pipeline->meter, samples, count);
+}
+
+void noise_pipeline_stats(noise_pipeline_t *pipeline, const uint16_t *samples, uint32_t count)
+{
+    block_stats_compute(samples, count, &pipeline->stats);
+}
+
+// Needs the block's statistics
+void noise_pipeline_spectrum(noise_pipeline_t *pipeline, const uint16_t *samples)
+{
+    spectrum_compute(&pipeline->spectrum, samples, &pipeline->stats, pipeline->thirds_q8);
+    spectrum_octaves_from_thirds(pipeline->thirds_q8, pipeline->octaves_q8);
+}
+
+alarm_state_t noise_pipeline_levels(noise_pipeline_t *pipeline, const monitor_thresholds_t *thresholds,
+                                    int *metric_level)
+{
+    const calibration_t *calibration = &pipeline->calibration;
+    monitor_level_t *level = &pipeline->level;
+
+    level->level = calibration_spl_decidb(calibration, pipeline->stats.rms_q8);
+    level->fast = calibration_spl_decidb(calibration, level_meter_fast_q8(&pipeline->meter));
+    level->slow = calibration_spl_decidb(calibration, level_meter_slow_q8(&pipeline->meter));
+    level->leq = calibration_spl_decidb(calibration, level_meter_leq_q8(&pipeline->meter));
+    for (unsigned band = 0; band < DSP_THIRD_OCTAVE_BANDS; band++)
+    {
+        level->third_octave_db[band] = (int16_t)calibration_spl_decidb(calibration, pipeline->thirds_q8[band]);
+    }
+    for (unsigned band = 0; band < DSP_OCTAVE_BANDS; band++)
+    {
+        level->octave_db[band] = (int16_t)calibration_spl_decidb(calibration, pipeline->octaves_q8[band]);
+    }
+
+    *metric_level = monitor_level_metric(level, thresholds->metric);
+    return alarm_classify(*metric_level, thresholds->warning, thresholds->danger);
+}
+
+void noise_pipeline_restart(noise_pipeline_t *pipeline)
+{
+    level_meter_restart(&pipeline->meter);
+}
+
+alarm_state_t noise_pipeline_process(noise_pipeline_t *pipeline, const uint16_t *samples, uint32_t count,
+                                     const monitor_thresholds_t *thresholds, int *metric_level)
+{
+    noise_pipeline_meter(pipeline, samples, count);
+    noise_pipeline_stats(pipeline, samples, count);
+    noise_pipeline_spectrum(pipeline, samples);
+    return noise_pipeline_levels(pipeline, thresholds, metric_level);
+}
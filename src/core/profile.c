@@ -0,0 +1,60 @@
+#include "profile.h"
+
+#include <string.h>
+
+static unsigned profile_bin(uint32_t us)
+{
+    unsigned bin = 0;
+    while (us > 1 && bin < PROFILE_BINS - 1)
+    {
+        us >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+void profile_stage_init(profile_stage_t *stage)
+{
+    memset(&stage->working, 0, sizeof(stage->working));
+    stage->working.min_us = UINT32_MAX;
+    seqlatch_init(&stage->latch, stage->copies, &stage->working, sizeof(stage->working));
+}
+
+void profile_stage_record(profile_stage_t *stage, uint32_t us)
+{
+    profile_stats_t *stats = &stage->working;
+
+    stats->count++;
+    stats->total_us += us;
+    stats->min_us = us < stats->min_us ? us : stats->min_us;
+    stats->max_us = us > stats->max_us ? us : stats->max_us;
+    stats->bins[profile_bin(us)]++;
+    seqlatch_publish(&stage->latch, stage->copies, stats, sizeof(*stats));
+}
+
+void profile_stage_read(const profile_stage_t *stage, profile_stats_t *stats)
+{
+    seqlatch_read(&stage->latch, stage->copies, stats, sizeof(*stats));
+}
+
+uint32_t profile_mean_us(const profile_stats_t *stats)
+{
+    return stats->count ? (uint32_t)((stats->total_us + stats->count / 2) / stats->count) : 0;
+}
+
+uint32_t profile_percentile_us(const profile_stats_t *stats, unsigned percent)
+{
+    // Smallest bin with at least `percent` of the samples at or below it
+    uint64_t target = (uint64_t)stats->count * percent;
+    uint64_t below = 0;
+
+    for (unsigned bin = 0; bin < PROFILE_BINS; bin++)
+    {
+        below += (uint64_t)stats->bins[bin] * 100;
+        if (stats->bins[bin] > 0 && below >= target)
+        {
+            return bin == PROFILE_BINS - 1 ? stats->max_us : (2u << bin) - 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include "seqlatch.h"
+
+#include <string.h>
+
+void seqlatch_init(seqlatch_t *latch, void *copies, const void *value, size_t size)
+{
+    memcpy(copies, value, size);
+    memcpy((uint8_t *)copies + size, value, size);
+    atomic_store_explicit(&latch->seq, 0, memory_order_release);
+}
+
+void seqlatch_publish(seqlatch_t *latch, void *copies, const void *value, size_t size)
+{
+    uint8_t *copy = copies;
+    unsigned seq = atomic_load_explicit(&latch->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&latch->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(copy, value, size);
+
+    atomic_store_explicit(&latch->seq, seq + 2, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    memcpy(copy + size, value, size);
+}
+
+uint32_t seqlatch_read(const seqlatch_t *latch, const void *copies, void *value, size_t size)
+{
+    const uint8_t *copy = copies;
+    unsigned seq;
+
+    do
+    {
+        seq = atomic_load_explicit(&latch->seq, memory_order_acquire);
+        memcpy(value, copy + (seq & 1) * size, size);
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&latch->seq, memory_order_relaxed) != seq);
+
+    return seq >> 1;
+}
@@ -0,0 +1,179 @@
+#include "spectrum.h"
+#include "fft_q15.h"
+#include "fixed_math.h"
+
+#include <math.h>
+#include <string.h>
+
+// Windowed samples are scaled up to this many bits before the FFT
+#define SPECTRUM_INPUT_BITS 14
+
+void spectrum_init(spectrum_t *spectrum, spectrum_resolution_t resolution, unsigned log2n,
+                   uint32_t sample_rate)
+{
+    memset(spectrum, 0, sizeof(*spectrum));
+    spectrum->resolution = resolution;
+    spectrum->log2n = log2n;
+    spectrum->sample_rate = sample_rate;
+
+    const uint16_t *lower = dsp_octave_lower_hz;
+    const uint16_t *upper = dsp_octave_upper_hz;
+    spectrum->band_count = DSP_OCTAVE_BANDS;
+    if (resolution == SPECTRUM_THIRD_OCTAVE)
+    {
+        lower = dsp_third_octave_lower_hz;
+        upper = dsp_third_octave_upper_hz;
+        spectrum->band_count = DSP_THIRD_OCTAVE_BANDS;
+    }
+
+    // Bin k sits at k * fs / N: it belongs to a band when lower * N <= k * fs < upper * N
+    uint64_t n = 1u << log2n;
+    for (unsigned band = 0; band < spectrum->band_count; band++)
+    {
+        uint64_t first = (lower[band] * n + sample_rate - 1) / sample_rate;
+        uint64_t end = (upper[band] * n + sample_rate - 1) / sample_rate;
+
+        // DC and Nyquist are left out
+        first = first < 1 ? 1 : first;
+        end = end > n / 2 ? n / 2 : end;
+
+        spectrum->first_bin[band] = (uint16_t)first;
+        spectrum->bin_count[band] = end > first ? (uint16_t)(end - first) : 0;
+    }
+}
+
+const uint16_t *spectrum_band_centres_hz(const spectrum_t *spectrum)
+{
+    return spectrum->resolution == SPECTRUM_THIRD_OCTAVE ? dsp_third_octave_centre_hz : dsp_octave_centre_hz;
+}
+
+// sqrt(value * 2^exponent) for an even exponent, shifting the radicand up
+// first so small bands keep their precision
+static uint32_t scaled_sqrt(uint64_t value, int exponent)
+{
+    if (value == 0)
+    {
+        return 0;
+    }
+
+    int headroom = (__builtin_clzll(value) - 2) & ~1;
+    int shift = (exponent - headroom) / 2;
+    uint32_t root = isqrt64(value << headroom);
+
+    return shift >= 0 ? root << shift : root >> -shift;
+}
+
+void spectrum_compute(spectrum_t *spectrum, const uint16_t *samples, const block_stats_t *stats,
+                      uint32_t *band_rms_q8)
+{
+    unsigned log2n = spectrum->log2n;
+
+    // Scale the block up to the input headroom the FFT expects
+    unsigned shift = 0;
+    while (shift < SPECTRUM_INPUT_BITS && ((uint32_t)stats->peak << (shift + 1)) < (1u << SPECTRUM_INPUT_BITS))
+    {
+        shift++;
+    }
+
+    fft_q15_load_real(spectrum->data, samples, log2n, stats->mean, shift);
+    unsigned scaled = fft_q15(spectrum->data, log2n);
+
+    // Parseval with the one sided spectrum (x2) and the Hann power loss
+    // (x8/3): ms = 16/3 * sum |X|^2 / N^2, in counts^2 once the input shift
+    // and the scaled stages are undone. Q8 RMS takes another 2^16.
+    int exponent = 2 * (int)scaled - 2 * (int)shift - 2 * (int)log2n + 16;
+
+    for (unsigned band = 0; band < spectrum->band_count; band++)
+    {
+        const int16_t *bin = spectrum->data + 2 * spectrum->first_bin[band];
+        uint64_t energy = 0;
+
+        for (unsigned k = 0; k < spectrum->bin_count[band]; k++, bin += 2)
+        {
+            energy += (uint64_t)((int32_t)bin[0] * bin[0]) + (uint64_t)((int32_t)bin[1] * bin[1]);
+        }
+
+        band_rms_q8[band] = scaled_sqrt(energy * 16 / 3, exponent);
+    }
+}
+
+_Static_assert(DSP_THIRD_OCTAVE_BANDS == 3 * DSP_OCTAVE_BANDS, "thirds must tile the octaves");
+
+void spectrum_octaves_from_thirds(const uint32_t *third_rms_q8, uint32_t *octave_rms_q8)
+{
+    for (unsigned band = 0; band < DSP_OCTAVE_BANDS; band++)
+    {
+        const uint32_t *third = third_rms_q8 + 3 * band;
+        uint64_t energy = (uint64_t)third[0] * third[0] + (uint64_t)third[1] * third[1] +
+                          (uint64_t)third[2] * third[2];
+        octave_rms_q8[band] = isqrt64(energy);
+    }
+}
+
+// Double precision version, kept to check the Q15 path against
+void spectrum_compute_ref(const spectrum_t *spectrum, const uint16_t *samples, double *band_rms)
+{
+    unsigned n = 1u << spectrum->log2n;
+    double re[DSP_FFT_MAX_SIZE];
+    double im[DSP_FFT_MAX_SIZE];
+
+    double mean = 0.0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        mean += samples[i];
+    }
+    mean /= n;
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        double window = 0.5 - 0.5 * cos(2.0 * M_PI * i / n);
+        re[i] = (samples[i] - mean) * window;
+        im[i] = 0.0;
+    }
+
+    for (unsigned i = 1, j = 0; i < n; i++)
+    {
+        unsigned bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            double t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+        }
+    }
+
+    for (unsigned half = 1; half < n; half <<= 1)
+    {
+        for (unsigned k = 0; k < half; k++)
+        {
+            double wr = cos(M_PI * k / half);
+            double wi = -sin(M_PI * k / half);
+            for (unsigned i = k; i < n; i += 2 * half)
+            {
+                unsigned j = i + half;
+                double tr = re[j] * wr - im[j] * wi;
+                double ti = re[j] * wi + im[j] * wr;
+                re[j] = re[i] - tr;
+                im[j] = im[i] - ti;
+                re[i] += tr;
+                im[i] += ti;
+            }
+        }
+    }
+
+    for (unsigned band = 0; band < spectrum->band_count; band++)
+    {
+        double energy = 0.0;
+        for (unsigned k = 0; k < spectrum->bin_count[band]; k++)
+        {
+            unsigned bin = spectrum->first_bin[band] + k;
+            energy += re[bin] * re[bin] + im[bin] * im[bin];
+        }
+        band_rms[band] = sqrt(energy * 16.0 / 3.0) / n;
+    }
+}
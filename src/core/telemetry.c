@@ -0,0 +1,115 @@
+#include "telemetry.h"
+#include "crc16.h"
+
+#include <string.h>
+
+_Static_assert(sizeof(telemetry_packet_t) == TELEMETRY_PACKET_SIZE, "packets are one USB packet");
+_Static_assert(sizeof(telemetry_levels_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_bands_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_state_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_stats_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_raw_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_profile_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_load_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_trace_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_memory_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_clip_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_info_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+_Static_assert(sizeof(telemetry_history_t) <= TELEMETRY_PAYLOAD_SIZE, "payload too big");
+
+void telemetry_pack(telemetry_packet_t *packet, telemetry_type_t type, const void *payload, size_t length)
+{
+    memset(packet, 0, sizeof(*packet));
+    packet->sync[0] = TELEMETRY_SYNC0;
+    packet->sync[1] = TELEMETRY_SYNC1;
+    packet->type = (uint8_t)type;
+    packet->length = (uint8_t)length;
+    memcpy(packet->payload, payload, length);
+}
+
+void telemetry_seal(telemetry_packet_t *packet, uint16_t seq)
+{
+    packet->seq = seq;
+    packet->crc = crc16_update(CRC16_INIT, packet, offsetof(telemetry_packet_t, crc));
+}
+
+bool telemetry_unpack(const telemetry_packet_t *packet, telemetry_type_t type, void *payload, size_t size)
+{
+    if (packet->type != type)
+    {
+        return false;
+    }
+    size_t length = packet->length < size ? packet->length : size;
+    memset(payload, 0, size);
+    memcpy(payload, packet->payload, length);
+    return true;
+}
+
+static bool telemetry_valid(const telemetry_packet_t *packet)
+{
+    return packet->type > 0 && packet->type < TELEMETRY_TYPE_COUNT && packet->length <= TELEMETRY_PAYLOAD_SIZE &&
+           packet->crc == crc16_update(CRC16_INIT, packet, offsetof(telemetry_packet_t, crc));
+}
+
+void telemetry_decoder_init(telemetry_decoder_t *decoder)
+{
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+// Drops the first byte of what is buffered and everything after it up to
+// the next place a packet could start
+static void telemetry_decoder_skip(telemetry_decoder_t *decoder)
+{
+    const uint8_t *buffer = (const uint8_t *)&decoder->packet;
+    uint32_t start = 1;
+
+    while (start < decoder->fill &&
+           !(buffer[start] == TELEMETRY_SYNC0 && (start + 1 == decoder->fill || buffer[start + 1] == TELEMETRY_SYNC1)))
+    {
+        start++;
+    }
+    memmove(&decoder->packet, buffer + start, decoder->fill - start);
+    decoder->fill -= start;
+    decoder->skipped += start;
+}
+
+void telemetry_decode(telemetry_decoder_t *decoder, const uint8_t *bytes, size_t len, telemetry_packet_fn packet,
+                      void *ctx)
+{
+    uint8_t *buffer = (uint8_t *)&decoder->packet;
+
+    decoder->bytes += len;
+    for (size_t i = 0; i < len; i++)
+    {
+        buffer[decoder->fill++] = bytes[i];
+
+        if ((decoder->fill == 1 && buffer[0] != TELEMETRY_SYNC0) ||
+            (decoder->fill == 2 && buffer[1] != TELEMETRY_SYNC1))
+        {
+            telemetry_decoder_skip(decoder);
+            continue;
+        }
+        if (decoder->fill < TELEMETRY_PACKET_SIZE)
+        {
+            continue;
+        }
+
+        if (!telemetry_valid(&decoder->packet))
+        {
+            decoder->crc_errors++;
+            telemetry_decoder_skip(decoder);
+            continue;
+        }
+
+        if (decoder->synced)
+        {
+            decoder->lost += (uint16_t)(decoder->packet.seq - decoder->next_seq);
+        }
+        decoder->synced = true;
+        decoder->next_seq = decoder->packet.seq + 1;
+        decoder->packets++;
+        decoder->by_type[decoder->packet.type]++;
+        decoder->fill = 0;
+        packet(&decoder->packet, ctx);
+    }
+}
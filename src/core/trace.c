@@ -0,0 +1,57 @@
+#include "trace.h"
+
+#include <string.h>
+
+_Static_assert((TRACE_RING_LENGTH & (TRACE_RING_LENGTH - 1)) == 0, "ring length must be a power of two");
+
+void trace_ring_init(trace_ring_t *ring)
+{
+    memset(ring->entries, 0, sizeof(ring->entries));
+    atomic_init(&ring->head, 0);
+}
+
+// The entry is complete before head moves past it
+void trace_ring_put(trace_ring_t *ring, trace_point_t point, uint32_t block, uint32_t time_us)
+{
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    ring->entries[head % TRACE_RING_LENGTH] = (trace_entry_t){time_us, block, (uint8_t)point};
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+uint32_t trace_ring_head(const trace_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire);
+}
+
+unsigned trace_ring_read(const trace_ring_t *ring, uint32_t *cursor, trace_entry_t *entries, unsigned max,
+                         uint32_t *lost)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t first = *cursor;
+
+    if (head - first > TRACE_RING_LENGTH - 1)
+    {
+        first = head - (TRACE_RING_LENGTH - 1);
+    }
+    uint32_t count = head - first < max ? head - first : max;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        entries[i] = ring->entries[(first + i) % TRACE_RING_LENGTH];
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    // Writing entry `now` overwrites entry now - TRACE_RING_LENGTH, so the
+    // copies of anything that old may be torn
+    uint32_t now = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t torn = 0;
+    if (now - first > TRACE_RING_LENGTH - 1)
+    {
+        torn = now - (TRACE_RING_LENGTH - 1) - first;
+        torn = torn < count ? torn : count;
+        memmove(entries, entries + torn, (count - torn) * sizeof(entries[0]));
+    }
+
+    *lost += first + torn - *cursor;
+    *cursor = first + count;
+    return count - torn;
+}
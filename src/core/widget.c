@@ -0,0 +1,151 @@
+#include "widget.h"
+
+#include <string.h>
+
+widget_t *widget_add(widget_screen_t *screen, widget_kind_t kind, int x, int y, int chars, const char *text)
+{
+    if (screen->count == WIDGET_MAX)
+    {
+        return NULL;
+    }
+
+    widget_t *widget = &screen->widgets[screen->count++];
+    widget->kind = kind;
+    widget->x = (uint8_t)x;
+    widget->y = (uint8_t)y;
+    widget->chars = (uint8_t)chars;
+    widget->text = text;
+    widget->value = 0;
+    widget->dirty = true;
+    return widget;
+}
+
+void widget_set_text(widget_t *widget, const char *text)
+{
+    if (widget->text != text)
+    {
+        widget->text = text;
+        widget->dirty = true;
+    }
+}
+
+void widget_set_value(widget_t *widget, int32_t value)
+{
+    if (widget->value != value)
+    {
+        widget->value = value;
+        widget->dirty = true;
+    }
+}
+
+int widget_format(char *text, int32_t value, int decimals)
+{
+    char digits[10];
+    int count = 0;
+    int length = 0;
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+
+    // Ten digits hold any magnitude, and with the leading 0 of a fraction
+    // any number of decimals up to nine
+    decimals = decimals < 0 ? 0 : decimals > WIDGET_FORMAT_MAX_DECIMALS ? WIDGET_FORMAT_MAX_DECIMALS : decimals;
+
+    do
+    {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0 || count <= decimals);
+
+    if (value < 0)
+    {
+        text[length++] = '-';
+    }
+    while (count > 0)
+    {
+        if (count == decimals)
+        {
+            text[length++] = '.';
+        }
+        text[length++] = digits[--count];
+    }
+    text[length] = '\0';
+    return length;
+}
+
+static void widget_draw(const widget_t *widget, uint8_t *ssd)
+{
+    char text[WIDGET_FORMAT_BYTES];
+    int length;
+
+    switch (widget->kind)
+    {
+    case WIDGET_DECIDB:
+        length = widget_format(text, widget->value, 1);
+        break;
+    case WIDGET_NUMBER:
+        if (widget->value < 0)
+        {
+            memcpy(text, "-", 2);
+            length = 1;
+            break;
+        }
+        length = widget_format(text, widget->value, 0);
+        break;
+    default:
+        length = 0;
+        break;
+    }
+
+    ssd1306_fill_rect(ssd, widget->x, widget->y, widget->chars * WIDGET_CHAR_WIDTH, ssd1306_page_height, false);
+    if (widget->kind == WIDGET_LABEL)
+    {
+        if (widget->text)
+        {
+            ssd1306_draw_string(ssd, widget->x, widget->y, widget->text);
+        }
+        return;
+    }
+
+    // Right aligned, and cut from the left if it does not fit
+    int skip = length > widget->chars ? length - widget->chars : 0;
+    int pad = length < widget->chars ? widget->chars - length : 0;
+    ssd1306_draw_string(ssd, widget->x + pad * WIDGET_CHAR_WIDTH, widget->y, text + skip);
+}
+
+static struct render_area widget_area(const widget_t *widget)
+{
+    struct render_area area = {
+        .start_column = widget->x,
+        .end_column = (uint8_t)(widget->x + widget->chars * WIDGET_CHAR_WIDTH - 1),
+        .start_page = (uint8_t)(widget->y / ssd1306_page_height),
+        .end_page = (uint8_t)((widget->y + ssd1306_page_height - 1) / ssd1306_page_height)};
+    calculate_render_area_buffer_length(&area);
+    return area;
+}
+
+void widget_screen_show(widget_screen_t *screen, uint8_t *ssd)
+{
+    memset(ssd, 0, ssd1306_buffer_length);
+    for (unsigned i = 0; i < screen->count; i++)
+    {
+        widget_draw(&screen->widgets[i], ssd);
+        screen->widgets[i].dirty = false;
+    }
+}
+
+int widget_screen_draw(widget_screen_t *screen, uint8_t *ssd, struct render_area *areas)
+{
+    int count = 0;
+
+    for (unsigned i = 0; i < screen->count; i++)
+    {
+        widget_t *widget = &screen->widgets[i];
+        if (!widget->dirty)
+        {
+            continue;
+        }
+        widget_draw(widget, ssd);
+        widget->dirty = false;
+        areas[count++] = widget_area(widget);
+    }
+    return count;
+}
@@ -0,0 +1,60 @@
+#include "diagnostics.h"
+
+#ifdef NOISEGUARD_PROFILE
+
+profile_stage_t profile_stages[PROFILE_STAGE_COUNT];
+
+// Short enough for the diagnostics page
+const char *const profile_stage_names[PROFILE_STAGE_COUNT] = {
+    "capt", "meter", "rms", "fft", "levels", "draw", "i2c"};
+
+unsigned diagnostics_update_load(diagnostics_load_t *load)
+{
+    uint32_t total;
+    unsigned count = (unsigned)uxTaskGetSystemState(load->status, DIAGNOSTICS_MAX_TASKS, &total);
+    uint32_t elapsed = total - load->total;
+    uint32_t run_time[DIAGNOSTICS_MAX_TASKS];
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        const TaskStatus_t *status = &load->status[i];
+        uint32_t previous = 0;
+
+        // Tasks come back in no particular order; a new one counts from 0
+        for (unsigned j = 0; j < load->count; j++)
+        {
+            if (load->handles[j] == status->xHandle)
+            {
+                previous = load->run_time[j];
+            }
+        }
+        run_time[i] = (uint32_t)status->ulRunTimeCounter;
+        load->names[i] = status->pcTaskName;
+        load->permille[i] = elapsed ? (uint16_t)((uint64_t)(run_time[i] - previous) * 1000 / elapsed) : 0;
+    }
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        load->handles[i] = load->status[i].xHandle;
+        load->run_time[i] = run_time[i];
+    }
+    load->count = count;
+    load->total = total;
+    return count;
+}
+
+void diagnostics_init(void)
+{
+    for (unsigned stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+    {
+        profile_stage_init(&profile_stages[stage]);
+    }
+}
+
+#else
+
+void diagnostics_init(void)
+{
+}
+
+#endif
@@ -1,43 +1,481 @@
 #include "display.h"
+#include "display_bus.h"
+#include "diagnostics.h"
+#include "latency.h"
 #include "ssd1306.h"
 #include "noise_monitor.h"
+#include "dsp_tables.h"
+#include "level_graph.h"
+#include "widget.h"
+
+#include <string.h>
 
 SemaphoreHandle_t displayMutex;
 uint8_t display_buffer[ssd1306_buffer_length];
+uint32_t display_frame_bytes;
+uint32_t display_frames;
+TaskHandle_t display_task;
 
-void vTaskUpdateDisplay(void *pvParameters)
+_Static_assert(WIDGET_MAX + 1 <= DISPLAY_MAX_AREAS, "a screen's dirty widgets and a graph column must fit a flush");
+
+// Last frame pushed to the panel, used to send only what changed
+static uint8_t display_shadow[ssd1306_buffer_length];
+static bool display_shadow_valid;
+
+// Only changed by the display task itself
+static display_page_t display_page;
+static monitor_snapshot_t display_state;
+
+// One stream is on the bus while the next frame is packed into the other
+static ssd1306_stream_t display_streams[2];
+static int display_back_stream;
+static ssd1306_bus_t *display_bus;
+
+// Copies what is about to be sent into the shadow, so the next diff
+// starts from what the panel shows
+static void display_shadow_update(const struct render_area *area)
 {
-    struct render_area area = {
-        .start_column = 0,
-        .end_column = ssd1306_width - 1,
-        .start_page = 0,
-        .end_page = ssd1306_n_pages - 1};
-    calculate_render_area_buffer_length(&area);
+    int width = area->end_column - area->start_column + 1;
+    for (int page = area->start_page; page <= area->end_page; page++)
+    {
+        int offset = page * ssd1306_width + area->start_column;
+        memcpy(display_shadow + offset, display_buffer + offset, width);
+    }
+}
 
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+// Sends the given areas, or what differs from the shadow when areas is NULL.
+// scroll first moves the graph on the panel one column left, as
+// level_graph_scroll did in the frame.
+static void display_flush(const struct render_area *dirty, int dirty_count, bool scroll)
+{
+    struct render_area areas[DISPLAY_MAX_AREAS];
+    int count;
+    bool scrolled = false;
 
-    while (1)
+    if (!display_shadow_valid)
+    {
+        areas[0] = (struct render_area){
+            .start_column = 0,
+            .end_column = ssd1306_width - 1,
+            .start_page = 0,
+            .end_page = ssd1306_n_pages - 1};
+        calculate_render_area_buffer_length(&areas[0]);
+        memcpy(display_shadow, display_buffer, sizeof(display_shadow));
+        display_shadow_valid = true;
+        count = 1;
+    }
+    else if (dirty)
+    {
+        if (scroll)
+        {
+            ssd1306_scroll_left(display_shadow, &level_graph_area);
+            scrolled = true;
+        }
+        for (count = 0; count < dirty_count; count++)
+        {
+            areas[count] = dirty[count];
+            display_shadow_update(&areas[count]);
+        }
+    }
+    else
     {
-        if (xSemaphoreTake(displayMutex, pdMS_TO_TICKS(100)) == pdTRUE)
+        count = ssd1306_diff_areas(display_buffer, display_shadow, areas, DISPLAY_MAX_AREAS);
+    }
+
+    ssd1306_stream_t *stream = &display_streams[display_back_stream];
+    ssd1306_stream_reset(stream);
+    if (scrolled)
+    {
+        ssd1306_stream_scroll_left(stream, &level_graph_area);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (!ssd1306_stream_area(stream, display_buffer, &areas[i]))
         {
-            memset(display_buffer, 0, sizeof(display_buffer));
+            struct render_area full = {
+                .start_column = 0,
+                .end_column = ssd1306_width - 1,
+                .start_page = 0,
+                .end_page = ssd1306_n_pages - 1};
+            ssd1306_stream_reset(stream);
+            ssd1306_stream_area(stream, display_buffer, &full);
+            break;
+        }
+    }
 
-            ssd1306_draw_string(display_buffer, 0, 0, "Noise Guard");
+    // The previous frame has to be off the bus before this one is timed
+    if (stream->count > 0)
+    {
+        ssd1306_bus_wait(display_bus);
+        latency_frame_submit();
+    }
+
+    uint32_t bytes_before = ssd1306_bytes_sent;
+    ssd1306_bus_submit(display_bus, stream);
+    display_frame_bytes = ssd1306_bytes_sent - bytes_before;
+    display_back_stream ^= 1;
+}
 
-            char levelStr[32];
-            snprintf(levelStr, sizeof(levelStr), "Level: %d", noise_level);
-            ssd1306_draw_string(display_buffer, 0, 16, levelStr);
+// Wakes the display task, redrawn at most DISPLAY_MAX_FPS times a second
+void display_notify(uint32_t events)
+{
+    if (display_task != NULL)
+    {
+        xTaskNotify(display_task, events, eSetBits);
+    }
+}
 
-            snprintf(levelStr, sizeof(levelStr), "Warn: %d", warning_threshold);
-            ssd1306_draw_string(display_buffer, 0, 32, levelStr);
-            snprintf(levelStr, sizeof(levelStr), "Dang: %d", danger_threshold);
-            ssd1306_draw_string(display_buffer, 0, 48, levelStr);
+// "Level:" for the block level, "Fast A:" for the weighted ones
+static char display_metric_labels[MONITOR_METRIC_COUNT][12];
 
-            render_on_display(display_buffer, &area);
+// Text pages are retained: their widgets are laid out once and only the
+// ones whose value changed are drawn again
+typedef struct
+{
+    widget_screen_t screen;
+    widget_t *metric_label;
+    widget_t *metric;
+    widget_t *warning;
+    widget_t *danger;
+} display_level_page_t;
 
-            xSemaphoreGive(displayMutex);
+typedef struct
+{
+    widget_screen_t screen;
+    widget_t *values[MONITOR_METRIC_COUNT];
+} display_meters_page_t;
+
+typedef struct
+{
+    widget_screen_t screen;
+    widget_t *peak;
+    widget_t *unit;
+} display_bands_page_t;
+
+typedef struct
+{
+    widget_screen_t screen;
+    widget_t *last;
+} display_history_page_t;
+
+static display_level_page_t display_level_page;
+static display_history_page_t display_history_page;
+static display_meters_page_t display_meters_page;
+static display_bands_page_t display_band_pages[2];
+
+// Page drawn in display_buffer, DISPLAY_PAGE_COUNT before the first frame
+static display_page_t display_shown_page = DISPLAY_PAGE_COUNT;
+
+static void display_pages_init(void)
+{
+    for (monitor_metric_t metric = 0; metric < MONITOR_METRIC_COUNT; metric++)
+    {
+        char *label = display_metric_labels[metric];
+        strcpy(label, monitor_metric_name(metric));
+        if (metric != MONITOR_METRIC_LEVEL)
+        {
+            strcat(label, NOISE_WEIGHTING == WEIGHTING_C ? " C" : " A");
+        }
+        strcat(label, ":");
+    }
+
+    // Labels in the first 8 columns, values right aligned after them
+    const int value_x = 8 * WIDGET_CHAR_WIDTH;
+    widget_screen_t *screen = &display_level_page.screen;
+    widget_add(screen, WIDGET_LABEL, 0, 0, 11, "Noise Guard");
+    display_level_page.metric_label = widget_add(screen, WIDGET_LABEL, 0, 16, 8, display_metric_labels[0]);
+    display_level_page.metric = widget_add(screen, WIDGET_DECIDB, value_x, 16, 5, NULL);
+    widget_add(screen, WIDGET_LABEL, 0, 32, 8, "Warn:");
+    display_level_page.warning = widget_add(screen, WIDGET_DECIDB, value_x, 32, 5, NULL);
+    widget_add(screen, WIDGET_LABEL, 0, 48, 8, "Dang:");
+    display_level_page.danger = widget_add(screen, WIDGET_DECIDB, value_x, 48, 5, NULL);
+
+    screen = &display_history_page.screen;
+    widget_add(screen, WIDGET_LABEL, 0, 0, 10, "Last 2 min");
+    display_history_page.last = widget_add(screen, WIDGET_DECIDB, 11 * WIDGET_CHAR_WIDTH, 0, 5, NULL);
+
+    screen = &display_meters_page.screen;
+    for (monitor_metric_t metric = 0; metric < MONITOR_METRIC_COUNT; metric++)
+    {
+        widget_add(screen, WIDGET_LABEL, 0, 16 * metric, 8, display_metric_labels[metric]);
+        display_meters_page.values[metric] = widget_add(screen, WIDGET_DECIDB, value_x, 16 * metric, 5, NULL);
+    }
+
+    static const char *const band_titles[2] = {"Oct peak", "1/3 peak"};
+    for (int i = 0; i < 2; i++)
+    {
+        screen = &display_band_pages[i].screen;
+        widget_add(screen, WIDGET_LABEL, 0, 0, 9, band_titles[i]);
+        display_band_pages[i].peak = widget_add(screen, WIDGET_NUMBER, 9 * WIDGET_CHAR_WIDTH, 0, 5, NULL);
+        display_band_pages[i].unit = widget_add(screen, WIDGET_LABEL, 14 * WIDGET_CHAR_WIDTH, 0, 2, NULL);
+    }
+}
+
+static widget_screen_t *display_page_screen(display_page_t page)
+{
+    switch (page)
+    {
+    case DISPLAY_PAGE_LEVEL:
+        return &display_level_page.screen;
+    case DISPLAY_PAGE_HISTORY:
+        return &display_history_page.screen;
+    case DISPLAY_PAGE_METERS:
+        return &display_meters_page.screen;
+    case DISPLAY_PAGE_OCTAVES:
+        return &display_band_pages[0].screen;
+    case DISPLAY_PAGE_THIRD_OCTAVES:
+        return &display_band_pages[1].screen;
+    default:
+        return NULL;
+    }
+}
+
+static int display_render_level(const monitor_snapshot_t *state, struct render_area *areas)
+{
+    // The level the LED is following
+    monitor_metric_t metric = state->thresholds.metric;
+    widget_set_text(display_level_page.metric_label, display_metric_labels[metric]);
+    widget_set_value(display_level_page.metric, monitor_level_metric(&state->level, metric));
+    widget_set_value(display_level_page.warning, state->thresholds.warning);
+    widget_set_value(display_level_page.danger, state->thresholds.danger);
+    return widget_screen_draw(&display_level_page.screen, display_buffer, areas);
+}
+
+// Seconds and thresholds the history graph in display_buffer was drawn for
+static uint32_t display_graph_closed;
+static int display_graph_warning;
+static int display_graph_danger;
+
+// Leq of each of the last 120 seconds, newest on the right. When one more
+// second has closed since the last frame the graph moves one column, and
+// with DISPLAY_HW_SCROLL the panel does the moving, so only the new column
+// is sent. Anything else (entering the page, new thresholds, missed
+// seconds) redraws the whole graph and sends what differs.
+static int display_render_history(const monitor_snapshot_t *state, struct render_area *areas, bool entered,
+                                  bool *scroll)
+{
+    int warning = state->thresholds.warning;
+    int danger = state->thresholds.danger;
+    uint32_t closed = history_closed(&noise_history, HISTORY_SECOND);
+    history_record_t last;
+
+    if (history_get(&noise_history, HISTORY_SECOND, 0, &last))
+    {
+        widget_set_value(display_history_page.last, last.leq);
+    }
+    int count = widget_screen_draw(&display_history_page.screen, display_buffer, areas);
+
+    if (entered || warning != display_graph_warning || danger != display_graph_danger ||
+        closed - display_graph_closed > 1)
+    {
+        level_graph_draw(display_buffer, &noise_history, closed, warning, danger);
+        count = -1;
+    }
+    else if (closed != display_graph_closed)
+    {
+        level_graph_scroll(display_buffer, &noise_history, closed, warning, danger);
+        if (DISPLAY_HW_SCROLL)
+        {
+            areas[count] = level_graph_area;
+            areas[count].start_column = ssd1306_width - 1;
+            calculate_render_area_buffer_length(&areas[count]);
+            count++;
+            *scroll = true;
+        }
+        else
+        {
+            count = -1;
+        }
+    }
+
+    display_graph_closed = closed;
+    display_graph_warning = warning;
+    display_graph_danger = danger;
+    return count;
+}
+
+static int display_render_meters(const monitor_snapshot_t *state, struct render_area *areas)
+{
+    for (monitor_metric_t metric = 0; metric < MONITOR_METRIC_COUNT; metric++)
+    {
+        widget_set_value(display_meters_page.values[metric], monitor_level_metric(&state->level, metric));
+    }
+    return widget_screen_draw(&display_meters_page.screen, display_buffer, areas);
+}
+
+// One bar per band, lowest band on the left, with the loudest band's
+// centre frequency in the title. The bars change every frame, so this page
+// is diffed against the shadow rather than sent by widget.
+static void display_render_bands(display_bands_page_t *page, const int16_t *bands_db, const uint16_t *centres_hz,
+                                 int count)
+{
+    struct render_area title[WIDGET_MAX];
+    int loudest = 0;
+    for (int band = 1; band < count; band++)
+    {
+        if (bands_db[band] > bands_db[loudest])
+        {
+            loudest = band;
         }
+    }
+
+    bool heard = bands_db[loudest] > DISPLAY_BAR_FLOOR_DECIDB;
+    widget_set_value(page->peak, heard ? centres_hz[loudest] : -1);
+    widget_set_text(page->unit, heard ? "Hz" : NULL);
+    widget_screen_draw(&page->screen, display_buffer, title);
+
+    ssd1306_fill_rect(display_buffer, 0, ssd1306_height - DISPLAY_BAR_HEIGHT, ssd1306_width, DISPLAY_BAR_HEIGHT,
+                      false);
+    int pitch = ssd1306_width / count;
+    int left = (ssd1306_width - pitch * count) / 2;
+    for (int band = 0; band < count; band++)
+    {
+        int height = (bands_db[band] - DISPLAY_BAR_FLOOR_DECIDB) / DISPLAY_BAR_DECIDB_PER_PIXEL;
+        if (height <= 0)
+        {
+            continue;
+        }
+        if (height > DISPLAY_BAR_HEIGHT)
+        {
+            height = DISPLAY_BAR_HEIGHT;
+        }
+        ssd1306_fill_rect(display_buffer, left + band * pitch, ssd1306_height - height,
+                          pitch > 1 ? pitch - 1 : 1, height, true);
+    }
+}
 
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(DISPLAY_UPDATE_MS));
+#ifdef NOISEGUARD_PROFILE
+// Mean and worst time of each stage since boot
+static void display_render_profile(void)
+{
+    char text[32];
+
+    ssd1306_draw_string(display_buffer, 0, 0, "us      avg  max");
+    for (unsigned stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+    {
+        profile_stats_t stats;
+        profile_stage_read(&profile_stages[stage], &stats);
+        snprintf(text, sizeof(text), "%-6s%5lu%5lu", profile_stage_names[stage],
+                 (unsigned long)profile_mean_us(&stats), (unsigned long)stats.max_us);
+        ssd1306_draw_string(display_buffer, 0, 8 + 8 * stage, text);
+    }
+}
+
+// CPU share of each task since the previous frame of this page
+static void display_render_load(void)
+{
+    static diagnostics_load_t load;
+    char text[32];
+
+    unsigned count = diagnostics_update_load(&load);
+    ssd1306_draw_string(display_buffer, 0, 0, "CPU %");
+    for (unsigned i = 0; i < count && i < 7; i++)
+    {
+        snprintf(text, sizeof(text), "%-11.11s%3u.%u", load.names[i], load.permille[i] / 10,
+                 load.permille[i] % 10);
+        ssd1306_draw_string(display_buffer, 0, 8 + 8 * i, text);
+    }
+}
+#endif
+
+static void display_render(void)
+{
+    struct render_area areas[WIDGET_MAX + 1];
+    int count = -1;
+    bool scroll = false;
+
+    latency_frame_begin();
+    monitor_state_snapshot(&display_state);
+
+    // A new page starts from a blank frame and is diffed as a whole
+    bool entered = display_page != display_shown_page;
+    if (entered)
+    {
+        widget_screen_t *screen = display_page_screen(display_page);
+        if (screen)
+        {
+            widget_screen_show(screen, display_buffer);
+        }
+        display_shown_page = display_page;
+    }
+
+    switch (display_page)
+    {
+    case DISPLAY_PAGE_HISTORY:
+        count = display_render_history(&display_state, areas, entered, &scroll);
+        break;
+    case DISPLAY_PAGE_METERS:
+        count = display_render_meters(&display_state, areas);
+        break;
+    case DISPLAY_PAGE_OCTAVES:
+        display_render_bands(&display_band_pages[0], display_state.level.octave_db, dsp_octave_centre_hz,
+                             DSP_OCTAVE_BANDS);
+        break;
+    case DISPLAY_PAGE_THIRD_OCTAVES:
+        display_render_bands(&display_band_pages[1], display_state.level.third_octave_db,
+                             dsp_third_octave_centre_hz, DSP_THIRD_OCTAVE_BANDS);
+        break;
+#ifdef NOISEGUARD_PROFILE
+    case DISPLAY_PAGE_PROFILE:
+        memset(display_buffer, 0, ssd1306_buffer_length);
+        display_render_profile();
+        break;
+    case DISPLAY_PAGE_LOAD:
+        memset(display_buffer, 0, ssd1306_buffer_length);
+        display_render_load();
+        break;
+#endif
+    default:
+        count = display_render_level(&display_state, areas);
+        break;
+    }
+
+    display_flush(entered || count < 0 ? NULL : areas, count, scroll);
+    display_frames++;
+}
+
+void vTaskUpdateDisplay(void *pvParameters)
+{
+    display_pages_init();
+    display_bus = display_bus_init();
+    ssd1306_set_bus(display_bus);
+
+    const TickType_t frame_ticks = pdMS_TO_TICKS(DISPLAY_MIN_FRAME_MS);
+    TickType_t last_frame = xTaskGetTickCount() - frame_ticks;
+    uint32_t events;
+    uint32_t more_events;
+
+    // First frame
+    xTaskNotify(xTaskGetCurrentTaskHandle(), DISPLAY_EVENT_ALL, eSetBits);
+
+    while (1)
+    {
+        // Idle until the monitor or the input task changes something visible
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+
+        // Rate cap: changes arriving while we hold back go into this frame
+        TickType_t elapsed = xTaskGetTickCount() - last_frame;
+        if (elapsed < frame_ticks)
+        {
+            vTaskDelay(frame_ticks - elapsed);
+        }
+        if (xTaskNotifyWait(0, UINT32_MAX, &more_events, 0) == pdTRUE)
+        {
+            events |= more_events;
+        }
+        last_frame = xTaskGetTickCount();
+
+        if (events & DISPLAY_EVENT_NEXT_PAGE)
+        {
+            display_page = (display_page + 1) % DISPLAY_PAGE_COUNT;
+        }
+
+        if (xSemaphoreTake(displayMutex, portMAX_DELAY) == pdTRUE)
+        {
+            PROFILE_START(draw_start);
+            display_render();
+            PROFILE_STOP(PROFILE_DRAW, draw_start);
+            xSemaphoreGive(displayMutex);
+        }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,121 @@
+#include "display_bus.h"
+#include "diagnostics.h"
+#include "latency.h"
+#include "ssd1306.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "hardware/dma.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+
+#include <assert.h>
+
+static_assert(ssd1306_stream_stop == I2C_IC_DATA_CMD_STOP_BITS,
+              "stream words must match the IC_DATA_CMD layout");
+
+// Pushes a prepared stream from RAM to the I2C TX FIFO by DMA. The caller
+// gets the CPU back immediately and is notified when the DMA has finished.
+typedef struct
+{
+    ssd1306_bus_t bus;
+    uint channel;
+    volatile bool busy;
+    TaskHandle_t waiter;
+} display_dma_bus_t;
+
+static display_dma_bus_t display_dma_bus;
+
+#ifdef NOISEGUARD_PROFILE
+static uint32_t display_bus_start_us;
+#endif
+
+static void display_bus_irq_handler(void)
+{
+    if (!dma_channel_get_irq1_status(display_dma_bus.channel))
+    {
+        return;
+    }
+    dma_channel_acknowledge_irq1(display_dma_bus.channel);
+#ifdef NOISEGUARD_PROFILE
+    profile_stage_record(&profile_stages[PROFILE_BUS], PROFILE_CLOCK_US() - display_bus_start_us);
+#endif
+    latency_frame_sent();
+
+    display_dma_bus.busy = false;
+
+    BaseType_t woken = pdFALSE;
+    if (display_dma_bus.waiter)
+    {
+        vTaskNotifyGiveIndexedFromISR(display_dma_bus.waiter, DISPLAY_BUS_NOTIFY_INDEX, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void display_bus_wait(ssd1306_bus_t *bus)
+{
+    display_dma_bus_t *dma_bus = (display_dma_bus_t *)bus;
+    i2c_hw_t *hw = i2c_get_hw(i2c1);
+
+    while (dma_bus->busy)
+    {
+        ulTaskNotifyTakeIndexed(DISPLAY_BUS_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(10));
+    }
+
+    // The DMA is done once the FIFO has the last word, the bus needs a bit longer
+    while (!(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS))
+    {
+        tight_loop_contents();
+    }
+
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+    {
+        (void)hw->clr_tx_abrt;
+    }
+}
+
+static void display_bus_submit(ssd1306_bus_t *bus, const uint16_t *words, size_t count)
+{
+    display_dma_bus_t *dma_bus = (display_dma_bus_t *)bus;
+    i2c_hw_t *hw = i2c_get_hw(i2c1);
+
+    display_bus_wait(bus);
+
+    hw->enable = 0;
+    hw->tar = ssd1306_i2c_address;
+    hw->enable = 1;
+
+    dma_bus->waiter = xTaskGetCurrentTaskHandle();
+    dma_bus->busy = true;
+#ifdef NOISEGUARD_PROFILE
+    display_bus_start_us = PROFILE_CLOCK_US();
+#endif
+    dma_channel_transfer_from_buffer_now(dma_bus->channel, words, count);
+}
+
+ssd1306_bus_t *display_bus_init(void)
+{
+    display_dma_bus.bus.submit = display_bus_submit;
+    display_dma_bus.bus.wait = display_bus_wait;
+    display_dma_bus.channel = dma_claim_unused_channel(true);
+
+    dma_channel_config cfg = dma_channel_get_default_config(display_dma_bus.channel);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, i2c_get_dreq(i2c1, true));
+
+    dma_channel_configure(display_dma_bus.channel, &cfg,
+                          &i2c_get_hw(i2c1)->data_cmd,
+                          NULL,
+                          0,
+                          false);
+
+    dma_channel_set_irq1_enabled(display_dma_bus.channel, true);
+    irq_add_shared_handler(DMA_IRQ_1, display_bus_irq_handler,
+                           PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    return &display_dma_bus.bus;
+}
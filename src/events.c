@@ -0,0 +1,82 @@
+#include "events.h"
+#include "capture.h"
+#include "noise_monitor.h"
+#include "peripherals.h"
+#include "hardware/sync.h"
+
+#include <assert.h>
+
+static_assert(EVENT_LOG_SECTOR_SIZE == FLASH_SECTOR_SIZE, "log sectors are flash sectors");
+static_assert(EVENT_LOG_PAGE_SIZE == FLASH_PAGE_SIZE, "log pages are flash pages");
+
+event_log_t event_log;
+TaskHandle_t events_task;
+
+// Flash cannot be read while it is erased or programmed, and all code runs
+// from it, so nothing else runs meanwhile: not the scheduler, not the
+// capture interrupt. The DMA keeps going round the two capture halves, so
+// audio is lost for as long as that lasts, about 1.3 ms per half at
+// 48 kHz. A page program fits in a half; a sector erase takes 45 ms and
+// up to 400 ms, which is why the store task erases ahead while nothing is
+// loud. Whatever the stall cost is passed to capture, which marks the gap.
+static void events_flash_erase(void *ctx, uint32_t offset)
+{
+    uint32_t interrupts = save_and_disable_interrupts();
+    uint32_t start_us = time_us_32();
+    flash_range_erase(EVENT_LOG_FLASH_OFFSET + offset, FLASH_SECTOR_SIZE);
+    capture_stalled(time_us_32() - start_us);
+    restore_interrupts(interrupts);
+}
+
+static void events_flash_program(void *ctx, uint32_t offset, const uint8_t *page)
+{
+    uint32_t interrupts = save_and_disable_interrupts();
+    uint32_t start_us = time_us_32();
+    flash_range_program(EVENT_LOG_FLASH_OFFSET + offset, page, FLASH_PAGE_SIZE);
+    capture_stalled(time_us_32() - start_us);
+    restore_interrupts(interrupts);
+}
+
+void events_init(void)
+{
+    const event_log_flash_t flash = {
+        .base = (const uint8_t *)(XIP_BASE + EVENT_LOG_FLASH_OFFSET),
+        .sectors = EVENT_LOG_SECTORS,
+        .erase = events_flash_erase,
+        .program = events_flash_program};
+
+    event_log_mount(&event_log, &flash);
+}
+
+bool events_record(const event_record_t *record)
+{
+    bool queued = event_log_append(&event_log, record);
+    if (queued && events_task != NULL)
+    {
+        xTaskNotifyGive(events_task);
+    }
+    return queued;
+}
+
+void vTaskStoreEvents(void *pvParameters)
+{
+    while (1)
+    {
+        // The next sector is erased ahead only while no stretch above the
+        // warning threshold is going on, so the audio a stall loses is not
+        // the audio that matters
+        if (!noise_monitor_episode_open())
+        {
+            event_log_prepare(&event_log);
+        }
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(EVENTS_PREPARE_MS)) == 0)
+        {
+            continue;
+        }
+
+        // Let a burst of crossings gather so they go out in one page
+        vTaskDelay(pdMS_TO_TICKS(EVENTS_BATCH_MS));
+        ulTaskNotifyTake(pdTRUE, 0);
+        event_log_flush(&event_log);
+    }
+}
@@ -1,43 +1,231 @@
 #include "input.h"
 #include "peripherals.h"
 #include "noise_monitor.h"
+#include "display.h"
+#include "latency.h"
+#include "memory_plan.h"
 
-void vTaskHandleInput(void *pvParameters)
+#include "queue.h"
+
+typedef struct
 {
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    const int joystick_center = 2048;
-    const int deadzone = 500;
+    uint32_t time_ms;
+    uint8_t button;
+} input_edge_t;
 
-    while (1)
+static const debounce_config_t input_repeat_config = {
+    .settle_ms = INPUT_SETTLE_MS,
+    .hold_ms = INPUT_REPEAT_HOLD_MS,
+    .repeat_ms = INPUT_REPEAT_MS,
+    .repeat_min_ms = INPUT_REPEAT_MIN_MS,
+};
+
+// One repeat and no more: the long press
+static const debounce_config_t input_long_press_config = {
+    .settle_ms = INPUT_SETTLE_MS,
+    .hold_ms = INPUT_LONG_PRESS_MS,
+};
+
+static QueueHandle_t input_queue;
+static StaticQueue_t input_queue_buffer;
+static uint8_t input_queue_storage[MEMORY_INPUT_QUEUE * sizeof(input_edge_t)];
+
+// Joystick side seen last by input_joystick_moved: -1, 0 or 1
+static int input_joystick_zone;
+
+// Edges the queue had no room for, each count kept by its one writer: the
+// GPIO interrupt and the monitor task, which reports the joystick. The
+// input task adds them to its misses.
+static volatile uint32_t input_irq_dropped;
+static volatile uint32_t input_joystick_dropped;
+
+static uint32_t input_now_ms(void)
+{
+    return (uint32_t)(time_us_64() / 1000);
+}
+
+static int input_zone(uint16_t x)
+{
+    int offset = (int)x - INPUT_JOYSTICK_CENTER;
+    return offset > INPUT_JOYSTICK_DEADZONE ? 1 : offset < -INPUT_JOYSTICK_DEADZONE ? -1 : 0;
+}
+
+static bool input_level(input_button_t button)
+{
+    switch (button)
+    {
+    case INPUT_BUTTON_A:
+        return !gpio_get(BTN_A);
+    case INPUT_BUTTON_B:
+        return !gpio_get(BTN_B);
+    case INPUT_BUTTON_SW:
+        return !gpio_get(JOYSTICK_SW);
+    case INPUT_JOYSTICK_LEFT:
+        return input_zone(read_joystick_x()) < 0;
+    case INPUT_JOYSTICK_RIGHT:
+        return input_zone(read_joystick_x()) > 0;
+    default:
+        return false;
+    }
+}
+
+static void input_gpio_irq(uint gpio, uint32_t events)
+{
+    (void)events;
+    input_edge_t edge = {
+        .time_ms = input_now_ms(),
+        .button = gpio == BTN_A ? INPUT_BUTTON_A : gpio == BTN_B ? INPUT_BUTTON_B : INPUT_BUTTON_SW,
+    };
+    BaseType_t woken = pdFALSE;
+
+    // A lost edge only matters if it was the last of a press; the level is
+    // read again when the line settles
+    if (xQueueSendFromISR(input_queue, &edge, &woken) != pdPASS)
     {
-        if (!gpio_get(BTN_A))
+        input_irq_dropped++;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+void input_init(void)
+{
+    input_queue = xQueueCreateStatic(MEMORY_INPUT_QUEUE, sizeof(input_edge_t), input_queue_storage,
+                                     &input_queue_buffer);
+}
+
+void input_joystick_moved(uint16_t x)
+{
+    int zone = input_zone(x);
+    if (zone == input_joystick_zone)
+    {
+        return;
+    }
+
+    // Leaving one side ends that press, reaching one starts a press there
+    input_edge_t edge = {.time_ms = input_now_ms()};
+    if (input_joystick_zone != 0)
+    {
+        edge.button = input_joystick_zone < 0 ? INPUT_JOYSTICK_LEFT : INPUT_JOYSTICK_RIGHT;
+        input_joystick_dropped += xQueueSend(input_queue, &edge, 0) != pdPASS;
+    }
+    if (zone != 0)
+    {
+        edge.button = zone < 0 ? INPUT_JOYSTICK_LEFT : INPUT_JOYSTICK_RIGHT;
+        input_joystick_dropped += xQueueSend(input_queue, &edge, 0) != pdPASS;
+    }
+    input_joystick_zone = zone;
+}
+
+// Drops counted since the last call, dropped_seen being what was counted then
+static uint32_t input_drops(uint32_t *dropped_seen)
+{
+    uint32_t dropped = input_irq_dropped + input_joystick_dropped;
+    uint32_t since = dropped - *dropped_seen;
+    *dropped_seen = dropped;
+    return since;
+}
+
+// Rounded up, so a wait never ends before its deadline and spins
+static TickType_t input_ticks(uint32_t ms)
+{
+    if (ms == DEBOUNCE_IDLE)
+    {
+        return portMAX_DELAY;
+    }
+    return (TickType_t)(((uint64_t)ms * configTICK_RATE_HZ + 999) / 1000);
+}
+
+static void input_handle(input_button_t button, debounce_event_t event, const debounce_t *state,
+                         monitor_thresholds_t *thresholds)
+{
+    bool step = event == DEBOUNCE_PRESS || event == DEBOUNCE_REPEAT;
+
+    switch (button)
+    {
+    case INPUT_BUTTON_A:
+    case INPUT_BUTTON_B:
+        if (!step)
+        {
+            return;
+        }
+        monitor_thresholds_shift(thresholds, button == INPUT_BUTTON_A ? -THRESHOLD_STEP : THRESHOLD_STEP);
+        break;
+    case INPUT_BUTTON_SW:
+        if (event == DEBOUNCE_RELEASE && state->repeats == 0)
         {
-            warning_threshold -= 100;
-            danger_threshold -= 100;
-            vTaskDelay(pdMS_TO_TICKS(200));
+            display_notify(DISPLAY_EVENT_NEXT_PAGE);
+            return;
         }
+        if (event != DEBOUNCE_REPEAT)
+        {
+            return;
+        }
+        thresholds->metric = (thresholds->metric + 1) % MONITOR_METRIC_COUNT;
+        break;
+    case INPUT_JOYSTICK_LEFT:
+    case INPUT_JOYSTICK_RIGHT:
+        if (!step)
+        {
+            return;
+        }
+        monitor_thresholds_widen(thresholds, button == INPUT_JOYSTICK_RIGHT ? GAP_STEP : -GAP_STEP);
+        break;
+    default:
+        return;
+    }
+    monitor_state_publish_thresholds(thresholds);
+    display_notify(DISPLAY_EVENT_THRESHOLDS);
+}
+
+void vTaskHandleInput(void *pvParameters)
+{
+    const uint32_t edges = GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE;
+    debounce_t buttons[INPUT_BUTTON_COUNT];
+    monitor_thresholds_t thresholds;
+    uint32_t dropped_seen = 0;
+
+    // Only writer of the thresholds, so the local copy is always current
+    monitor_state_thresholds(&thresholds);
+
+    for (int i = 0; i < INPUT_BUTTON_COUNT; i++)
+    {
+        debounce_init(&buttons[i], i == INPUT_BUTTON_SW ? &input_long_press_config : &input_repeat_config,
+                      input_level((input_button_t)i));
+    }
+    gpio_set_irq_enabled_with_callback(BTN_A, edges, true, input_gpio_irq);
+    gpio_set_irq_enabled(BTN_B, edges, true);
+    gpio_set_irq_enabled(JOYSTICK_SW, edges, true);
 
-        if (!gpio_get(BTN_B))
+    while (1)
+    {
+        uint32_t now_ms = input_now_ms();
+        uint32_t wait_ms = DEBOUNCE_IDLE;
+        for (int i = 0; i < INPUT_BUTTON_COUNT; i++)
         {
-            warning_threshold += 100;
-            danger_threshold += 100;
-            vTaskDelay(pdMS_TO_TICKS(200));
+            uint32_t button_ms = debounce_wait_ms(&buttons[i], now_ms);
+            wait_ms = button_ms < wait_ms ? button_ms : wait_ms;
         }
 
-        int joystick_value = read_joystick_x();
-        if (abs(joystick_value - joystick_center) > deadzone)
+        input_edge_t edge;
+        if (xQueueReceive(input_queue, &edge, input_ticks(wait_ms)) == pdPASS)
         {
-            if (joystick_value > joystick_center)
+            now_ms = input_now_ms();
+            if (now_ms - edge.time_ms >= INPUT_DEADLINE_MS)
             {
-                threshold_gap = threshold_gap < MAX_GAP ? threshold_gap + 50 : MAX_GAP;
+                latency_misses[LATENCY_TASK_INPUT]++;
             }
-            else
+            debounce_edge(&buttons[edge.button], edge.time_ms);
+        }
+        latency_misses[LATENCY_TASK_INPUT] += input_drops(&dropped_seen);
+
+        now_ms = input_now_ms();
+        for (int i = 0; i < INPUT_BUTTON_COUNT; i++)
+        {
+            debounce_event_t event = debounce_update(&buttons[i], input_level((input_button_t)i), now_ms);
+            if (event != DEBOUNCE_NONE)
             {
-                threshold_gap = threshold_gap > MIN_GAP ? threshold_gap - 50 : MIN_GAP;
+                input_handle((input_button_t)i, event, &buttons[i], &thresholds);
             }
-            danger_threshold = warning_threshold + threshold_gap;
-            vTaskDelay(pdMS_TO_TICKS(100));
         }
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(50));
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,114 @@
+#include "latency.h"
+#include "display.h"
+#include "peripherals.h"
+#include "seqlatch.h"
+
+#include "hardware/timer.h"
+
+// The next block is complete by then, so a later LED update means the
+// monitor is falling behind
+#define LATENCY_BLOCK_US ((uint32_t)((uint64_t)SAMPLES * 1000000 / AUDIO_SAMPLE_RATE))
+#define LATENCY_FRAME_US (DISPLAY_MIN_FRAME_MS * 1000u)
+
+// No block published yet
+#define LATENCY_NO_BLOCK UINT32_MAX
+
+typedef struct
+{
+    uint32_t block;
+    uint32_t time_us;
+} latency_block_t;
+
+typedef struct
+{
+    latency_block_t shown;
+    uint32_t start_us;
+} latency_frame_t;
+
+trace_ring_t latency_pipeline_trace;
+trace_ring_t latency_frame_trace;
+profile_stage_t latency_paths[LATENCY_PATH_COUNT];
+volatile uint32_t latency_misses[LATENCY_TASK_COUNT];
+
+// Newest block whose level the display can pick up, written by the monitor
+static seqlatch_t published;
+static latency_block_t published_copies[2];
+
+// Display task side: the frame being drawn, and the last block shown
+static latency_frame_t drawing;
+static uint32_t last_shown = LATENCY_NO_BLOCK;
+
+// Frame on the bus, set by the display task while the bus is idle and read
+// by the interrupt
+static latency_frame_t in_flight;
+static volatile bool in_flight_new;
+
+void latency_init(void)
+{
+    const latency_block_t none = {LATENCY_NO_BLOCK, 0};
+
+    trace_ring_init(&latency_pipeline_trace);
+    trace_ring_init(&latency_frame_trace);
+    for (unsigned path = 0; path < LATENCY_PATH_COUNT; path++)
+    {
+        profile_stage_init(&latency_paths[path]);
+    }
+    seqlatch_init(&published, published_copies, &none, sizeof(none));
+}
+
+void latency_block_point(trace_point_t point, const capture_block_t *block)
+{
+    uint32_t now_us = point == TRACE_CAPTURE ? block->time_us : time_us_32();
+    uint32_t elapsed_us = now_us - block->time_us;
+
+    trace_ring_put(&latency_pipeline_trace, point, block->seq, now_us);
+    if (point == TRACE_DSP)
+    {
+        profile_stage_record(&latency_paths[LATENCY_DSP], elapsed_us);
+    }
+    else if (point == TRACE_LED)
+    {
+        profile_stage_record(&latency_paths[LATENCY_LED], elapsed_us);
+        if (elapsed_us > LATENCY_BLOCK_US)
+        {
+            latency_misses[LATENCY_TASK_MONITOR]++;
+        }
+    }
+}
+
+void latency_block_published(const capture_block_t *block)
+{
+    const latency_block_t latest = {block->seq, block->time_us};
+    seqlatch_publish(&published, published_copies, &latest, sizeof(latest));
+}
+
+// Read before the level snapshot, so a frame never claims a block newer
+// than the level it shows: at worst it is timed from the block before
+void latency_frame_begin(void)
+{
+    drawing.start_us = time_us_32();
+    seqlatch_read(&published, published_copies, &drawing.shown, sizeof(drawing.shown));
+}
+
+void latency_frame_submit(void)
+{
+    in_flight = drawing;
+    in_flight_new = drawing.shown.block != LATENCY_NO_BLOCK && drawing.shown.block != last_shown;
+    last_shown = drawing.shown.block;
+}
+
+void latency_frame_sent(void)
+{
+    uint32_t now_us = time_us_32();
+
+    if (now_us - in_flight.start_us > LATENCY_FRAME_US)
+    {
+        latency_misses[LATENCY_TASK_DISPLAY]++;
+    }
+    if (in_flight_new)
+    {
+        in_flight_new = false;
+        trace_ring_put(&latency_frame_trace, TRACE_FRAME, in_flight.shown.block, now_us);
+        profile_stage_record(&latency_paths[LATENCY_FRAME], now_us - in_flight.shown.time_us);
+    }
+}
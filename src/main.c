@@ -6,19 +6,34 @@
 
 #include "peripherals.h"
 #include "noise_monitor.h"
+#include "diagnostics.h"
 #include "display.h"
+#include "events.h"
 #include "input.h"
+#include "latency.h"
+#include "memory_plan.h"
+#include "telemetry_usb.h"
 
 int main()
 {
     stdio_init_all();
+    diagnostics_init();
+    latency_init();
     init_peripherals();
-
-    displayMutex = xSemaphoreCreateMutex();
-
-    xTaskCreate(vTaskMonitorNoise, "NoiseMonitorTask", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
-    xTaskCreate(vTaskUpdateDisplay, "DisplayUpdateTask", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
-    xTaskCreate(vTaskHandleInput, "InputHandlerTask", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
+    monitor_state_init();
+    events_init();
+    telemetry_init();
+    input_init();
+
+    static StaticSemaphore_t display_mutex_buffer;
+    displayMutex = xSemaphoreCreateMutexStatic(&display_mutex_buffer);
+
+    memory_task_create(MEMORY_TASK_MONITOR, vTaskMonitorNoise, 2);
+    display_task = memory_task_create(MEMORY_TASK_DISPLAY, vTaskUpdateDisplay, 1);
+    memory_task_create(MEMORY_TASK_INPUT, vTaskHandleInput, 1);
+    events_task = memory_task_create(MEMORY_TASK_EVENTS, vTaskStoreEvents, 1);
+    // Below everything else: a slow host may keep it waiting on the USB stack
+    telemetry_task = memory_task_create(MEMORY_TASK_TELEMETRY, vTaskSendTelemetry, tskIDLE_PRIORITY);
 
     vTaskStartScheduler();
 
@@ -0,0 +1,87 @@
+#include "memory_plan.h"
+
+#include <assert.h>
+#include <malloc.h>
+
+typedef struct
+{
+    const char *name;
+    StackType_t *stack;
+    uint32_t words;
+} memory_task_plan_t;
+
+static StackType_t memory_stack_monitor[MEMORY_STACK_WORDS(MEMORY_STACK_MONITOR)];
+static StackType_t memory_stack_display[MEMORY_STACK_WORDS(MEMORY_STACK_DISPLAY)];
+static StackType_t memory_stack_input[MEMORY_STACK_WORDS(MEMORY_STACK_INPUT)];
+static StackType_t memory_stack_events[MEMORY_STACK_WORDS(MEMORY_STACK_EVENTS)];
+static StackType_t memory_stack_telemetry[MEMORY_STACK_WORDS(MEMORY_STACK_TELEMETRY)];
+
+#define MEMORY_TASK_PLAN(name, stack) {name, stack, sizeof(stack) / sizeof(stack[0])}
+
+static const memory_task_plan_t memory_plan[MEMORY_TASK_COUNT] = {
+    MEMORY_TASK_PLAN("NoiseMonitorTask", memory_stack_monitor),
+    MEMORY_TASK_PLAN("DisplayUpdateTask", memory_stack_display),
+    MEMORY_TASK_PLAN("InputHandlerTask", memory_stack_input),
+    MEMORY_TASK_PLAN("EventStoreTask", memory_stack_events),
+    MEMORY_TASK_PLAN("TelemetryTask", memory_stack_telemetry)};
+
+static StaticTask_t memory_tcbs[MEMORY_TASK_COUNT];
+
+// The kernel's own tasks
+static StaticTask_t memory_idle_tcb;
+static StackType_t memory_idle_stack[configMINIMAL_STACK_SIZE];
+static StaticTask_t memory_timer_tcb;
+static StackType_t memory_timer_stack[configTIMER_TASK_STACK_DEPTH];
+
+TaskHandle_t memory_tasks[MEMORY_TASK_COUNT];
+
+// Name of the task that overflowed, for the debugger
+const char *volatile memory_overflow_task;
+
+TaskHandle_t memory_task_create(memory_task_t task, TaskFunction_t code, UBaseType_t priority)
+{
+    const memory_task_plan_t *plan = &memory_plan[task];
+
+    configASSERT(memory_tasks[task] == NULL);
+    memory_tasks[task] = xTaskCreateStatic(code, plan->name, plan->words, NULL, priority, plan->stack,
+                                           &memory_tcbs[task]);
+    return memory_tasks[task];
+}
+
+uint32_t memory_stack_words(memory_task_t task)
+{
+    return memory_plan[task].words;
+}
+
+uint32_t memory_heap_used(void)
+{
+#ifdef __GLIBC__
+    // The simulator runs on glibc, where mallinfo is deprecated
+    return (uint32_t)mallinfo2().uordblks;
+#else
+    return (uint32_t)mallinfo().uordblks;
+#endif
+}
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **stack, configSTACK_DEPTH_TYPE *words)
+{
+    *tcb = &memory_idle_tcb;
+    *stack = memory_idle_stack;
+    *words = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **tcb, StackType_t **stack, configSTACK_DEPTH_TYPE *words)
+{
+    *tcb = &memory_timer_tcb;
+    *stack = memory_timer_stack;
+    *words = configTIMER_TASK_STACK_DEPTH;
+}
+
+// The kernel checks the end of the stack of the task it switches out;
+// past that point the task has already written over something else
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name)
+{
+    taskDISABLE_INTERRUPTS();
+    memory_overflow_task = name;
+    configASSERT(!"stack overflow");
+}
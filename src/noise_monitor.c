@@ -1,62 +1,156 @@
 #include "noise_monitor.h"
+#include "alarm.h"
+#include "capture.h"
+#include "diagnostics.h"
+#include "display.h"
+#include "events.h"
+#include "latency.h"
 #include "peripherals.h"
+#include "telemetry_usb.h"
 
 #include <stdlib.h>
+#include <string.h>
 
-int noise_level = 0;
-int warning_threshold = NOISE_THRESHOLD_WARNING;
-int danger_threshold = NOISE_THRESHOLD_DANGER;
-int threshold_gap = DEFAULT_GAP;
+_Static_assert((1u << NOISE_SPECTRUM_LOG2) <= SAMPLES, "spectrum longer than a block");
+_Static_assert(NOISE_CLIP_BLOCKS(NOISE_CLIP_PRE_MS) + NOISE_CLIP_BLOCKS(NOISE_CLIP_POST_MS) <=
+                   NOISE_CLIP_BLOCKS(NOISE_CLIP_RING_MS),
+               "a clip must fit in the ring");
+
+// Kept off the task stack
+static monitor_level_t published;
+static alarm_episode_t episode;
+static alarm_state_t last_state;
+static uint8_t clip_storage[NOISE_CLIP_BLOCKS(NOISE_CLIP_RING_MS) * CLIP_BLOCK_BYTES(NOISE_CLIP_CODEC, SAMPLES)];
+
+noise_pipeline_t noise_pipeline;
+history_t noise_history;
+clip_ring_t noise_clips;
+
+// Logs each stretch above the warning threshold once it is over
+static void monitor_track_episode(alarm_state_t state, int level, const monitor_thresholds_t *thresholds)
+{
+    uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+    int threshold = state == ALARM_DANGER ? thresholds->danger : thresholds->warning;
+
+    if (alarm_episode_update(&episode, state, level, threshold, now_ms))
+    {
+        uint32_t duration_s = (episode.duration_ms + 500) / 1000;
+        const event_record_t record = {
+            .start_s = episode.start_ms / 1000,
+            .duration_s = (uint16_t)(duration_s < UINT16_MAX ? duration_s : UINT16_MAX),
+            .peak_decidb = (int16_t)episode.peak,
+            .threshold_decidb = (int16_t)episode.threshold,
+            .state = (uint8_t)episode.worst,
+            .metric = (uint8_t)thresholds->metric};
+        events_record(&record);
+    }
+}
+
+bool noise_monitor_episode_open(void)
+{
+    return episode.active;
+}
 
 void vTaskMonitorNoise(void *pvParameters)
 {
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+    capture_block_t block;
+    const monitor_level_t *level = &noise_pipeline.level;
+
+    // Written to the last flash sector when the device is calibrated; a blank
+    // or damaged sector falls back to the nominal profile
+    const calibration_profile_t *stored = (const calibration_profile_t *)(XIP_BASE + CALIBRATION_FLASH_OFFSET);
+    bool pipeline_ok = noise_pipeline_init(&noise_pipeline, calibration_profile_select(stored), ADC_VREF_MV,
+                                           NOISE_WEIGHTING, NOISE_SPECTRUM_LOG2, AUDIO_SAMPLE_RATE);
+    configASSERT(pipeline_ok);
+    history_init(&noise_history, &noise_pipeline.calibration, SAMPLES, AUDIO_SAMPLE_RATE);
+    clip_ring_init(&noise_clips, clip_storage, NOISE_CLIP_BLOCKS(NOISE_CLIP_RING_MS), NOISE_CLIP_CODEC, SAMPLES,
+                   NOISE_CLIP_BLOCKS(NOISE_CLIP_PRE_MS), NOISE_CLIP_BLOCKS(NOISE_CLIP_POST_MS));
+    capture_start(xTaskGetCurrentTaskHandle());
 
     while (1)
     {
-        adc_select_input(2);
-        adc_fifo_drain();
-        adc_run(false);
+        if (!capture_wait_block(&block, portMAX_DELAY))
+        {
+            continue;
+        }
+        latency_block_point(TRACE_CAPTURE, &block);
+
+        // Samples were lost before this block: nothing downstream joins the
+        // two sides up as if they followed on
+        if (block.lost)
+        {
+            noise_pipeline_restart(&noise_pipeline);
+            history_gap(&noise_history, block.lost);
+            clip_ring_gap(&noise_clips);
+        }
+
+        PROFILE_START(meter_start);
+        noise_pipeline_meter(&noise_pipeline, block.samples, block.len);
+        PROFILE_STOP(PROFILE_METER, meter_start);
+
+        PROFILE_START(rms_start);
+        noise_pipeline_stats(&noise_pipeline, block.samples, block.len);
+        PROFILE_STOP(PROFILE_RMS, rms_start);
 
-        dma_channel_configure(dma_channel, &dma_cfg,
-                              adc_buffer,
-                              &adc_hw->fifo,
-                              SAMPLES,
-                              true);
+        PROFILE_START(spectrum_start);
+        noise_pipeline_spectrum(&noise_pipeline, block.samples);
+        PROFILE_STOP(PROFILE_SPECTRUM, spectrum_start);
 
-        adc_run(true);
-        dma_channel_wait_for_finish_blocking(dma_channel);
-        adc_run(false);
+        PROFILE_START(levels_start);
+        monitor_thresholds_t thresholds;
+        monitor_state_thresholds(&thresholds);
+        int metric_level;
+        alarm_state_t state = noise_pipeline_levels(&noise_pipeline, &thresholds, &metric_level);
+        history_add(&noise_history, level_meter_fast_q8(&noise_pipeline.meter),
+                    level_meter_block_q8(&noise_pipeline.meter));
+        latency_block_point(TRACE_DSP, &block);
 
-        float rms = calculate_rms(adc_buffer, SAMPLES);
-        noise_level = (int)(rms * 1000);
+        update_led_status(state);
+        latency_block_point(TRACE_LED, &block);
 
-        update_led_status(noise_level);
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(SAMPLE_RATE_MS));
+        // Encoded from the block in place, after the LED so it adds nothing
+        // to the time it takes to light
+        clip_ring_record(&noise_clips, block.samples);
+        if (state == ALARM_DANGER && last_state != ALARM_DANGER)
+        {
+            clip_ring_trigger(&noise_clips);
+        }
+        last_state = state;
+
+        monitor_track_episode(state, metric_level, &thresholds);
+        telemetry_publish_block(level, &thresholds, state, metric_level, &block);
+        if (memcmp(level, &published, sizeof(*level)) != 0)
+        {
+            published = *level;
+            monitor_state_publish_level(&published);
+            latency_block_published(&block);
+            display_notify(DISPLAY_EVENT_LEVEL);
+        }
+        PROFILE_STOP(PROFILE_LEVELS, levels_start);
     }
 }
 
-void update_led_status(int level)
+void update_led_status(alarm_state_t state)
 {
-    if (level < warning_threshold)
+    switch (state)
     {
+    case ALARM_OK:
         // Green - OK
         gpio_put(LED_RED, 0);
         gpio_put(LED_GREEN, 1);
         gpio_put(LED_BLUE, 0);
-    }
-    else if (level < danger_threshold)
-    {
+        break;
+    case ALARM_WARNING:
         // Yellow - Warning
         gpio_put(LED_RED, 1);
         gpio_put(LED_GREEN, 1);
         gpio_put(LED_BLUE, 0);
-    }
-    else
-    {
+        break;
+    case ALARM_DANGER:
         // Red - Danger
         gpio_put(LED_RED, 1);
         gpio_put(LED_GREEN, 0);
         gpio_put(LED_BLUE, 0);
+        break;
     }
 }
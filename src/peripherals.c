@@ -1,12 +1,7 @@
 #include "peripherals.h"
+#include "capture.h"
 #include "ssd1306.h"
 
-#include <math.h>
-
-uint16_t adc_buffer[SAMPLES];
-uint dma_channel;
-dma_channel_config dma_cfg;
-
 void init_peripherals(void)
 {
     gpio_init(LED_RED);
@@ -23,6 +18,10 @@ void init_peripherals(void)
     gpio_pull_up(BTN_A);
     gpio_pull_up(BTN_B);
 
+    gpio_init(JOYSTICK_SW);
+    gpio_set_dir(JOYSTICK_SW, GPIO_IN);
+    gpio_pull_up(JOYSTICK_SW);
+
     adc_init();
     adc_gpio_init(MIC_IN);
     adc_gpio_init(JOYSTICK_X);
@@ -36,29 +35,14 @@ void init_peripherals(void)
     ssd1306_init();
 
     adc_fifo_setup(true, true, 1, false, false);
-    adc_set_clkdiv(96.0f);
+    adc_set_clkdiv(ADC_CLKDIV);
 
-    dma_channel = dma_claim_unused_channel(true);
-    dma_cfg = dma_channel_get_default_config(dma_channel);
-    channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_16);
-    channel_config_set_read_increment(&dma_cfg, false);
-    channel_config_set_write_increment(&dma_cfg, true);
-    channel_config_set_dreq(&dma_cfg, DREQ_ADC);
+    capture_init();
 }
 
+// Sampled alongside the microphone by the capture DMA, no ADC access here
 int read_joystick_x(void)
 {
-    adc_select_input(1);
-    return adc_read();
+    return capture_joystick_x();
 }
 
-float calculate_rms(uint16_t *buffer, int samples)
-{
-    float sum = 0.0f;
-    for (int i = 0; i < samples; i++)
-    {
-        float voltage = buffer[i] * 3.3f / (1 << 12);
-        sum += voltage * voltage;
-    }
-    return sqrt(sum / samples);
-}
\ No newline at end of file
@@ -0,0 +1,488 @@
+#include "telemetry_usb.h"
+#include "capture.h"
+#include "diagnostics.h"
+#include "display.h"
+#include "events.h"
+#include "latency.h"
+#include "noise_monitor.h"
+#include "peripherals.h"
+#include "pico/stdio_usb.h"
+#include "queue.h"
+
+#include <assert.h>
+#include <string.h>
+
+static_assert((SAMPLES + TELEMETRY_RAW_SAMPLES - 1) / TELEMETRY_RAW_SAMPLES < MEMORY_TELEMETRY_QUEUE,
+              "a raw block must fit in the queue");
+
+// Stack high water marks in the stats packet, idle task last
+static_assert(MEMORY_TASK_COUNT == TELEMETRY_STATS_TASKS - 1, "one stack per task in the stats");
+
+TaskHandle_t telemetry_task;
+telemetry_usb_stats_t telemetry_usb_stats;
+
+static QueueHandle_t telemetry_queue;
+static StaticQueue_t telemetry_queue_buffer;
+static uint8_t telemetry_queue_storage[MEMORY_TELEMETRY_QUEUE * sizeof(telemetry_packet_t)];
+
+// Written by the telemetry task, read by the monitor
+static volatile bool listening;
+static volatile bool raw_mode;
+
+// Monitor side, only touched by the monitor task
+static telemetry_levels_t levels;
+static telemetry_state_t last_state;
+static bool informed;
+static uint32_t blocks;
+static telemetry_packet_t outgoing;
+
+// Telemetry task side
+static uint16_t telemetry_seq;
+static const trace_ring_t *const telemetry_traces[] = {&latency_pipeline_trace, &latency_frame_trace};
+static uint32_t telemetry_trace_cursors[sizeof(telemetry_traces) / sizeof(telemetry_traces[0])];
+static uint32_t telemetry_history_cursors[HISTORY_RESOLUTION_COUNT];
+
+static void telemetry_queue_packet(telemetry_type_t type, const void *payload, size_t length)
+{
+    telemetry_pack(&outgoing, type, payload, length);
+    if (xQueueSend(telemetry_queue, &outgoing, 0) != pdPASS)
+    {
+        telemetry_usb_stats.packets_dropped++;
+    }
+}
+
+static void telemetry_queue_bands(uint32_t now_ms, uint8_t resolution, const int16_t *bands, unsigned count)
+{
+    for (unsigned first = 0; first < count; first += TELEMETRY_BANDS_PER_PACKET)
+    {
+        unsigned left = count - first;
+        telemetry_bands_t packet = {
+            .time_ms = now_ms,
+            .resolution = resolution,
+            .first = (uint8_t)first,
+            .count = (uint8_t)(left < TELEMETRY_BANDS_PER_PACKET ? left : TELEMETRY_BANDS_PER_PACKET)};
+        memcpy(packet.bands, bands + first, packet.count * sizeof(bands[0]));
+        telemetry_queue_packet(TELEMETRY_BANDS, &packet, sizeof(packet));
+    }
+}
+
+static void telemetry_queue_raw(const capture_block_t *block)
+{
+    for (uint32_t offset = 0; offset < block->len; offset += TELEMETRY_RAW_SAMPLES)
+    {
+        uint32_t left = block->len - offset;
+        telemetry_raw_t packet = {
+            .block = block->seq,
+            .offset = (uint16_t)offset,
+            .count = (uint16_t)(left < TELEMETRY_RAW_SAMPLES ? left : TELEMETRY_RAW_SAMPLES),
+            .lost = offset == 0 ? block->lost : 0};
+        memcpy(packet.samples, block->samples + offset, packet.count * sizeof(packet.samples[0]));
+        telemetry_queue_packet(TELEMETRY_RAW, &packet, sizeof(packet));
+    }
+}
+
+static void telemetry_queue_info(void)
+{
+    const calibration_profile_t *profile = noise_pipeline.calibration.profile;
+    telemetry_info_t info = {
+        .sample_rate = AUDIO_SAMPLE_RATE,
+        .block_samples = SAMPLES,
+        .adc_vref_mv = ADC_VREF_MV,
+        .sensitivity_decidbv = profile->sensitivity_decidbv,
+        .offset_decidb = profile->offset_decidb,
+        .weighting = (uint8_t)noise_pipeline.meter.curve,
+        .spectrum_log2 = NOISE_SPECTRUM_LOG2};
+
+    strncpy(info.firmware, NOISEGUARD_VERSION, sizeof(info.firmware));
+    telemetry_queue_packet(TELEMETRY_INFO, &info, sizeof(info));
+}
+
+// The level alone moves all the time and goes out with the next state anyway
+static bool telemetry_state_changed(const telemetry_state_t *a, const telemetry_state_t *b)
+{
+    return a->warning != b->warning || a->danger != b->danger || a->gap != b->gap || a->metric != b->metric ||
+           a->alarm != b->alarm || a->raw != b->raw;
+}
+
+void telemetry_init(void)
+{
+    telemetry_queue = xQueueCreateStatic(MEMORY_TELEMETRY_QUEUE, sizeof(telemetry_packet_t),
+                                         telemetry_queue_storage, &telemetry_queue_buffer);
+}
+
+void telemetry_publish_block(const monitor_level_t *level, const monitor_thresholds_t *thresholds,
+                             alarm_state_t state, int metric_level, const capture_block_t *block)
+{
+    if (!listening)
+    {
+        levels.count = 0;
+        informed = false;
+        return;
+    }
+
+    uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+    bool raw = raw_mode;
+
+    if (!informed || (raw && !last_state.raw))
+    {
+        telemetry_queue_info();
+        informed = true;
+    }
+
+    if (levels.count == 0)
+    {
+        levels.time_ms = now_ms;
+        levels.block_us = (uint16_t)((uint64_t)SAMPLES * 1000000 / AUDIO_SAMPLE_RATE);
+    }
+    levels.levels[levels.count++] = (telemetry_level_t){
+        (int16_t)level->level, (int16_t)level->fast, (int16_t)level->slow, (int16_t)level->leq};
+    if (levels.count == TELEMETRY_LEVELS_PER_PACKET)
+    {
+        telemetry_queue_packet(TELEMETRY_LEVELS, &levels, sizeof(levels));
+        levels.count = 0;
+    }
+
+    if (blocks++ % TELEMETRY_BANDS_EVERY == 0)
+    {
+        telemetry_queue_bands(now_ms, 1, level->octave_db, DSP_OCTAVE_BANDS);
+        telemetry_queue_bands(now_ms, 3, level->third_octave_db, DSP_THIRD_OCTAVE_BANDS);
+    }
+
+    const telemetry_state_t current = {
+        .time_ms = now_ms,
+        .warning = (int16_t)thresholds->warning,
+        .danger = (int16_t)thresholds->danger,
+        .gap = (int16_t)thresholds->gap,
+        .metric = (uint8_t)thresholds->metric,
+        .alarm = (uint8_t)state,
+        .metric_level = (int16_t)metric_level,
+        .raw = raw};
+    if (telemetry_state_changed(&current, &last_state) || now_ms - last_state.time_ms >= TELEMETRY_STATE_MS)
+    {
+        telemetry_queue_packet(TELEMETRY_STATE, &current, sizeof(current));
+        last_state = current;
+    }
+
+    if (raw)
+    {
+        telemetry_queue_raw(block);
+    }
+}
+
+static void telemetry_read_commands(void)
+{
+    char commands[16];
+    int count;
+
+    while ((count = stdio_usb.in_chars(commands, sizeof(commands))) > 0)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (commands[i] == TELEMETRY_COMMAND_RAW_ON || commands[i] == TELEMETRY_COMMAND_RAW_OFF)
+            {
+                raw_mode = commands[i] == TELEMETRY_COMMAND_RAW_ON;
+            }
+        }
+    }
+}
+
+// Stack high water marks in words, idle task last
+static void telemetry_stack_free(uint16_t *stack_free)
+{
+    for (unsigned t = 0; t < MEMORY_TASK_COUNT; t++)
+    {
+        stack_free[t] = memory_tasks[t] ? (uint16_t)uxTaskGetStackHighWaterMark(memory_tasks[t]) : 0;
+    }
+    stack_free[MEMORY_TASK_COUNT] = (uint16_t)uxTaskGetStackHighWaterMark(xTaskGetIdleTaskHandle());
+}
+
+static void telemetry_stats(telemetry_packet_t *packet, uint32_t now_ms)
+{
+    telemetry_stats_t stats = {
+        .time_ms = now_ms,
+        .capture_blocks = capture_queue.consumed,
+        .capture_dropped = capture_queue.dropped,
+        .capture_overruns = capture_queue.overruns,
+        .display_frames = display_frames,
+        .packets_sent = telemetry_usb_stats.packets_sent,
+        .packets_dropped = telemetry_usb_stats.packets_dropped,
+        .bytes_sent = telemetry_usb_stats.bytes_sent,
+        .events_pending = (uint16_t)event_log_pending(&event_log),
+        .events_dropped = (uint16_t)event_log.dropped};
+
+    telemetry_stack_free(stats.stack_free);
+    for (unsigned t = 0; t < TELEMETRY_DEADLINE_TASKS; t++)
+    {
+        stats.deadline_misses[t] = (uint16_t)latency_misses[t];
+    }
+    telemetry_pack(packet, TELEMETRY_STATS, &stats, sizeof(stats));
+}
+
+static void telemetry_memory(telemetry_packet_t *packet, uint32_t now_ms)
+{
+    telemetry_memory_t memory = {.time_ms = now_ms, .heap_used = memory_heap_used()};
+
+    for (unsigned t = 0; t < MEMORY_TASK_COUNT; t++)
+    {
+        memory.stack_words[t] = (uint16_t)memory_stack_words(t);
+    }
+    memory.stack_words[MEMORY_TASK_COUNT] = configMINIMAL_STACK_SIZE;
+    telemetry_stack_free(memory.stack_free);
+    telemetry_pack(packet, TELEMETRY_MEMORY, &memory, sizeof(memory));
+}
+
+// Numbered as they go out, so the host only sees gaps for packets lost on
+// the wire
+static void telemetry_write(telemetry_packet_t *packets, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++)
+    {
+        telemetry_seal(&packets[i], telemetry_seq++);
+    }
+    stdio_usb.out_chars((const char *)packets, (int)(count * sizeof(packets[0])));
+    telemetry_usb_stats.packets_sent += count;
+    telemetry_usb_stats.bytes_sent += count * sizeof(packets[0]);
+}
+
+// One packet per stage of a set of timings
+static void telemetry_write_timings(telemetry_type_t type, const profile_stage_t *stages, unsigned count,
+                                    uint32_t now_ms)
+{
+    static telemetry_packet_t packet;
+
+    for (unsigned stage = 0; stage < count; stage++)
+    {
+        profile_stats_t stats;
+        profile_stage_read(&stages[stage], &stats);
+
+        telemetry_profile_t profile = {
+            .time_ms = now_ms,
+            .stage = (uint8_t)stage,
+            .count = stats.count,
+            .min_us = stats.count ? stats.min_us : 0,
+            .max_us = stats.max_us,
+            .mean_us = profile_mean_us(&stats)};
+        for (unsigned bin = 0; bin < PROFILE_BINS && stats.count; bin++)
+        {
+            profile.bins[bin] = (uint16_t)((uint64_t)stats.bins[bin] * 1000 / stats.count);
+        }
+        telemetry_pack(&packet, type, &profile, sizeof(profile));
+        telemetry_write(&packet, 1);
+    }
+}
+
+// Trace entries are only sent from when the host connects
+static void telemetry_trace_start(void)
+{
+    for (unsigned r = 0; r < sizeof(telemetry_traces) / sizeof(telemetry_traces[0]); r++)
+    {
+        telemetry_trace_cursors[r] = trace_ring_head(telemetry_traces[r]);
+    }
+}
+
+// Everything traced since the last call, a ring at a time
+static void telemetry_write_traces(telemetry_packet_t *packets)
+{
+    unsigned count = 0;
+
+    for (unsigned r = 0; r < sizeof(telemetry_traces) / sizeof(telemetry_traces[0]); r++)
+    {
+        trace_entry_t entries[TELEMETRY_TRACE_ENTRIES];
+        uint32_t lost = 0;
+        unsigned read;
+
+        while ((read = trace_ring_read(telemetry_traces[r], &telemetry_trace_cursors[r], entries,
+                                       TELEMETRY_TRACE_ENTRIES, &lost)) > 0)
+        {
+            telemetry_trace_t trace = {.lost = lost, .count = (uint8_t)read};
+            for (unsigned i = 0; i < read; i++)
+            {
+                trace.entries[i] = (telemetry_trace_entry_t){
+                    entries[i].time_us, (uint16_t)entries[i].block, entries[i].point};
+            }
+            telemetry_pack(&packets[count++], TELEMETRY_TRACE, &trace, sizeof(trace));
+            lost = 0;
+
+            if (count == TELEMETRY_WRITE_BATCH)
+            {
+                telemetry_write(packets, count);
+                count = 0;
+            }
+        }
+    }
+    if (count > 0)
+    {
+        telemetry_write(packets, count);
+    }
+}
+
+// Minutes and hours are sent from the oldest still kept when the host
+// connects
+static void telemetry_history_start(void)
+{
+    for (history_resolution_t r = HISTORY_MINUTE; r < HISTORY_RESOLUTION_COUNT; r++)
+    {
+        telemetry_history_cursors[r] = history_closed(&noise_history, r) - history_available(&noise_history, r);
+    }
+}
+
+// Every minute and hour closed since the last call. One the monitor has
+// already overwritten is skipped.
+static void telemetry_write_history(telemetry_packet_t *packets)
+{
+    unsigned count = 0;
+
+    for (history_resolution_t r = HISTORY_MINUTE; r < HISTORY_RESOLUTION_COUNT; r++)
+    {
+        uint32_t *cursor = &telemetry_history_cursors[r];
+        history_record_t record;
+
+        while (*cursor != history_closed(&noise_history, r))
+        {
+            telemetry_history_t history = {.first = *cursor, .resolution = (uint8_t)r};
+            while (history.count < TELEMETRY_HISTORY_RECORDS &&
+                   history_get_period(&noise_history, r, *cursor, &record))
+            {
+                history.records[history.count++] = (telemetry_history_record_t){
+                    record.min, record.max, record.leq, record.l10, record.l90, record.gaps};
+                (*cursor)++;
+            }
+            if (history.count == 0)
+            {
+                *cursor = history_closed(&noise_history, r) - history_available(&noise_history, r);
+                continue;
+            }
+            telemetry_pack(&packets[count++], TELEMETRY_HISTORY, &history, sizeof(history));
+
+            if (count == TELEMETRY_WRITE_BATCH)
+            {
+                telemetry_write(packets, count);
+                count = 0;
+            }
+        }
+    }
+    if (count > 0)
+    {
+        telemetry_write(packets, count);
+    }
+}
+
+// Blocks of the held clip, cut into packets. A clip waits in RAM until a
+// host is there to take it.
+static void telemetry_write_clip(telemetry_packet_t *packets)
+{
+    clip_block_t block;
+    unsigned count = 0;
+
+    for (unsigned sent = 0; sent < TELEMETRY_CLIP_BLOCKS && clip_ring_peek(&noise_clips, &block); sent++)
+    {
+        for (uint32_t offset = 0; offset < block.bytes; offset += TELEMETRY_CLIP_DATA)
+        {
+            uint32_t left = block.bytes - offset;
+            telemetry_clip_t clip = {
+                .clip = (uint16_t)block.clip,
+                .block = (uint16_t)block.index,
+                .count = (uint16_t)block.count,
+                .trigger = (uint16_t)block.trigger,
+                .bytes = (uint16_t)block.bytes,
+                .offset = (uint16_t)offset,
+                .codec = (uint8_t)NOISE_CLIP_CODEC,
+                .length = (uint8_t)(left < TELEMETRY_CLIP_DATA ? left : TELEMETRY_CLIP_DATA)};
+            memcpy(clip.data, block.data + offset, clip.length);
+            telemetry_pack(&packets[count++], TELEMETRY_CLIP, &clip, sizeof(clip));
+
+            if (count == TELEMETRY_WRITE_BATCH)
+            {
+                telemetry_write(packets, count);
+                count = 0;
+            }
+        }
+        clip_ring_release(&noise_clips);
+    }
+    if (count > 0)
+    {
+        telemetry_write(packets, count);
+    }
+}
+
+#ifdef NOISEGUARD_PROFILE
+// Stage timings since boot and task CPU shares since the last report
+static void telemetry_write_profile(uint32_t now_ms)
+{
+    static diagnostics_load_t load;
+    static telemetry_packet_t packet;
+
+    telemetry_write_timings(TELEMETRY_PROFILE, profile_stages, PROFILE_STAGE_COUNT, now_ms);
+
+    unsigned count = diagnostics_update_load(&load);
+    for (unsigned first = 0; first < count; first += TELEMETRY_LOAD_TASKS)
+    {
+        telemetry_load_t shares = {.time_ms = now_ms, .first = (uint8_t)first, .total = (uint8_t)count};
+        for (unsigned i = first; i < count && shares.count < TELEMETRY_LOAD_TASKS; i++, shares.count++)
+        {
+            strncpy(shares.tasks[shares.count].name, load.names[i], TELEMETRY_LOAD_NAME);
+            shares.tasks[shares.count].permille = load.permille[i];
+        }
+        telemetry_pack(&packet, TELEMETRY_LOAD, &shares, sizeof(shares));
+        telemetry_write(&packet, 1);
+    }
+}
+#endif
+
+void vTaskSendTelemetry(void *pvParameters)
+{
+    static telemetry_packet_t batch[TELEMETRY_WRITE_BATCH];
+    uint32_t last_stats_ms = 0;
+    clip_block_t clip;
+
+    while (1)
+    {
+        unsigned count = 0;
+        bool draining = listening && clip_ring_peek(&noise_clips, &clip);
+
+        // Wait for the first packet, then take what else is there
+        if (xQueueReceive(telemetry_queue, &batch[count], draining ? 0 : pdMS_TO_TICKS(TELEMETRY_POLL_MS)) ==
+            pdPASS)
+        {
+            count++;
+            while (count < TELEMETRY_WRITE_BATCH && xQueueReceive(telemetry_queue, &batch[count], 0) == pdPASS)
+            {
+                count++;
+            }
+        }
+
+        bool connected = stdio_usb_connected();
+        if (connected && !listening)
+        {
+            telemetry_trace_start();
+            telemetry_history_start();
+        }
+        listening = connected;
+        telemetry_read_commands();
+        if (!listening)
+        {
+            continue;
+        }
+
+        if (count > 0)
+        {
+            telemetry_write(batch, count);
+        }
+        telemetry_write_traces(batch);
+        telemetry_write_history(batch);
+        telemetry_write_clip(batch);
+
+        uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+        if (now_ms - last_stats_ms >= TELEMETRY_STATS_MS)
+        {
+            last_stats_ms = now_ms;
+            telemetry_stats(&batch[0], now_ms);
+            telemetry_memory(&batch[1], now_ms);
+            telemetry_write(batch, 2);
+            telemetry_write_timings(TELEMETRY_LATENCY, latency_paths, LATENCY_PATH_COUNT, now_ms);
+#ifdef NOISEGUARD_PROFILE
+            telemetry_write_profile(now_ms);
+#endif
+        }
+    }
+}
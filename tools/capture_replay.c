@@ -0,0 +1,181 @@
+// Runs a capture file written by noiseguard_decode --record through the
+// firmware's level and alarm processing, as fast as the host goes. The
+// trace hash is the same for every run of the same file and code, so it
+// can be kept as the expected result of a regression run.
+#include "capture_file.h"
+#include "capture_replay.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *const replay_alarm_names[] = {"ok", "warning", "danger"};
+
+static void replay_trace(const capture_replay_trace_t *trace, void *ctx)
+{
+    FILE *out = ctx;
+
+    fprintf(out, "%u %d %d %d %d %d %s\n", trace->block, trace->level, trace->fast, trace->slow, trace->leq,
+            trace->metric_level, trace->state < 3 ? replay_alarm_names[trace->state] : "?");
+}
+
+static double replay_now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint8_t *replay_load(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    size_t size = 0;
+    size_t capacity = 1 << 20;
+    uint8_t *bytes = malloc(capacity);
+    size_t read;
+    while (bytes && (read = fread(bytes + size, 1, capacity - size, f)) > 0)
+    {
+        size += read;
+        if (size == capacity)
+        {
+            uint8_t *grown = realloc(bytes, capacity *= 2);
+            if (!grown)
+            {
+                free(bytes);
+            }
+            bytes = grown;
+        }
+    }
+    fclose(f);
+    *len = size;
+    return bytes;
+}
+
+static void replay_usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--trace file] [--repeat n] [--expect hash] capture\n"
+            "  --trace writes block, level, fast, slow, leq, metric level (deci-dB) and alarm state a line a block\n"
+            "  --repeat replays n times, checks every run gives the same trace and times them all\n"
+            "  --expect fails unless the trace hash is hash\n",
+            argv0);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    const char *capture_path = NULL;
+    const char *expect = NULL;
+    FILE *trace = NULL;
+    unsigned repeat = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            trace = fopen(argv[++i], "w");
+            if (!trace)
+            {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (repeat == 0)
+            {
+                replay_usage(argv[0]);
+            }
+        }
+        else if (strcmp(argv[i], "--expect") == 0 && i + 1 < argc)
+        {
+            expect = argv[++i];
+        }
+        else if (!capture_path && argv[i][0] != '-')
+        {
+            capture_path = argv[i];
+        }
+        else
+        {
+            replay_usage(argv[0]);
+        }
+    }
+    if (!capture_path)
+    {
+        replay_usage(argv[0]);
+    }
+
+    size_t len;
+    uint8_t *bytes = replay_load(capture_path, &len);
+    if (!bytes)
+    {
+        return EXIT_FAILURE;
+    }
+
+    capture_file_header_t header = {0};
+    if (len >= sizeof(header))
+    {
+        memcpy(&header, bytes, sizeof(header));
+    }
+    if (!capture_file_header_check(&header))
+    {
+        fprintf(stderr, "%s: not a capture file this version reads\n", capture_path);
+        return EXIT_FAILURE;
+    }
+    printf("capture  firmware %.*s  %u Hz  %u samples a block  sensitivity %.1f dBV  offset %.1f dB\n",
+           CAPTURE_FILE_FIRMWARE, header.firmware, header.sample_rate, header.block_samples,
+           header.calibration.sensitivity_decidbv / 10.0, header.calibration.offset_decidb / 10.0);
+
+    static noise_pipeline_t pipeline;
+    capture_replay_result_t first;
+    capture_replay_result_t result;
+    unsigned differing = 0;
+    double start = replay_now_s();
+    for (unsigned run = 0; run < repeat; run++)
+    {
+        // Only the first run writes the trace, which is timed with the rest
+        if (!capture_replay(&pipeline, bytes, len, run == 0 && trace ? replay_trace : NULL, trace,
+                            run == 0 ? &first : &result))
+        {
+            fprintf(stderr, "%s: no filters for %u Hz\n", capture_path, header.sample_rate);
+            return EXIT_FAILURE;
+        }
+        differing += run > 0 && (result.hash != first.hash || result.blocks != first.blocks);
+    }
+    double elapsed = replay_now_s() - start;
+    free(bytes);
+    if (trace && fclose(trace) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    double audio_s = (double)first.blocks * header.block_samples / header.sample_rate;
+    printf("replay   %u blocks (%.1f s of audio), %u missing, %u gaps, %u threshold changes%s\n", first.blocks,
+           audio_s, first.missing, first.gaps, first.thresholds, first.damaged ? ", stopped at a damaged chunk" : "");
+    if (first.blocks > 0 && elapsed > 0.0)
+    {
+        printf("speed    %u runs in %.3f s, %.0f blocks/s, %.0fx real time\n", repeat, elapsed,
+               first.blocks * (double)repeat / elapsed, audio_s * repeat / elapsed);
+    }
+    printf("trace    %016" PRIx64 "%s\n", first.hash, differing ? "  differs between runs" : "");
+
+    if (differing)
+    {
+        return EXIT_FAILURE;
+    }
+    if (expect && strtoull(expect, NULL, 16) != first.hash)
+    {
+        fprintf(stderr, "trace hash %016" PRIx64 ", expected %s\n", first.hash, expect);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
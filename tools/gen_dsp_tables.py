@@ -0,0 +1,404 @@
+#!/usr/bin/env python3
+"""Generates dsp_tables.h and dsp_tables.c, the constant tables of the DSP
+stages in src/core, so no trigonometry or logarithms run on the device.
+"""
+
+import math
+import sys
+
+FFT_MAX_LOG2 = 9
+FFT_MAX_SIZE = 1 << FFT_MAX_LOG2
+
+# Base-2 bands around 1 kHz: octaves 31.25 Hz..16 kHz, third octaves 25 Hz..20 kHz
+OCTAVES = range(-5, 5)
+THIRD_OCTAVES = range(-16, 14)
+
+# Rates the weighting filters are designed for, the decimator's outputs
+WEIGHTING_RATES = (16000, 24000, 48000)
+
+# Audio rates of the decimator and the CIC ratio for each; the FIR after
+# the CIC always decimates by 2
+DECIMATOR_CONFIGS = ((16000, 4), (24000, 4), (48000, 2))
+CIC_ORDER = 5
+FIR_TAPS = 48
+# FIR band edges as fractions of the audio rate: flat (CIC droop included)
+# up to 0.375, at least ~50 dB down from Nyquist of the audio rate
+FIR_PASSBAND = 0.375
+FIR_STOPBAND = 0.5
+FIR_STOPBAND_WEIGHT = 10.0
+
+# log2 of the mantissa between table entries is interpolated linearly
+LOG2_TABLE_BITS = 6
+
+# IEC 61672 A and C weighting pole frequencies
+POLE_F1 = 20.598997
+POLE_F2 = 107.65265
+POLE_F3 = 737.86223
+POLE_F4 = 12194.217
+
+# The bilinear low-pass pole F4 is near or past Nyquist at 16 and 24 kHz,
+# so that section is refitted to the analog curve, on a sixth octave grid
+# from 31.25 Hz up to this fraction of Nyquist
+WEIGHTING_FIT_TOP = 0.9
+
+
+def q15(value):
+    return max(-32768, min(32767, int(round(value * 32768.0))))
+
+
+def c_array(ctype, name, values, per_line=8):
+    lines = [f"const {ctype} {name}[{len(values)}] = {{"]
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(str(v) for v in values[i:i + per_line]) + ",")
+    lines.append("};")
+    return lines
+
+
+def bit_reverse(value, bits):
+    result = 0
+    for _ in range(bits):
+        result = (result << 1) | (value & 1)
+        value >>= 1
+    return result
+
+
+def band_edges(exponents, fraction):
+    centres, lower, upper = [], [], []
+    for k in exponents:
+        fc = 1000.0 * 2.0 ** (k / fraction)
+        centres.append(int(round(fc)))
+        lower.append(int(round(fc * 2.0 ** (-0.5 / fraction))))
+        upper.append(int(round(fc * 2.0 ** (0.5 / fraction))))
+    return centres, lower, upper
+
+
+def q30(value):
+    scaled = int(round(value * (1 << 30)))
+    assert -(1 << 31) <= scaled < (1 << 31), value
+    return scaled
+
+
+def bilinear_pole(f, fs):
+    """(s + w) through the bilinear transform, times (1 + z^-1): c0 + c1 z^-1"""
+    w = 2.0 * math.pi * f
+    return (2.0 * fs + w, -(2.0 * fs - w))
+
+
+def poly_mul(a, b):
+    result = [0.0] * (len(a) + len(b) - 1)
+    for i, x in enumerate(a):
+        for j, y in enumerate(b):
+            result[i + j] += x * y
+    return result
+
+
+def analog_weighting(curve, f):
+    """Magnitude of the analog A or C weighting at f, before normalising"""
+    f2 = f * f
+    gain = POLE_F4 ** 2 * f2 / ((f2 + POLE_F1 ** 2) * (f2 + POLE_F4 ** 2))
+    if curve == "a":
+        gain *= f2 / math.sqrt((f2 + POLE_F2 ** 2) * (f2 + POLE_F3 ** 2))
+    return gain
+
+
+def section_gain(section, f, fs):
+    b, a = section
+    z = complex(math.cos(2 * math.pi * f / fs), -math.sin(2 * math.pi * f / fs))
+    return abs((b[0] + b[1] * z + b[2] * z * z) / (a[0] + a[1] * z + a[2] * z * z))
+
+
+def nelder_mead(cost, start, step, iterations):
+    """Minimum of cost near start, by the downhill simplex"""
+    n = len(start)
+    simplex = [list(start)] + [[x + (step if i == j else 0.0) for j, x in enumerate(start)] for i in range(n)]
+    values = [cost(p) for p in simplex]
+    for _ in range(iterations):
+        order = sorted(range(n + 1), key=lambda i: values[i])
+        simplex = [simplex[i] for i in order]
+        values = [values[i] for i in order]
+        centre = [sum(p[i] for p in simplex[:-1]) / n for i in range(n)]
+
+        def towards_worst(t):
+            return [c + t * (w - c) for c, w in zip(centre, simplex[-1])]
+
+        reflected = towards_worst(-1.0)
+        value = cost(reflected)
+        if value < values[0]:
+            expanded = towards_worst(-2.0)
+            expanded_value = cost(expanded)
+            simplex[-1], values[-1] = (expanded, expanded_value) if expanded_value < value else (reflected, value)
+        elif value < values[-2]:
+            simplex[-1], values[-1] = reflected, value
+        else:
+            contracted = towards_worst(0.5)
+            contracted_value = cost(contracted)
+            if contracted_value < values[-1]:
+                simplex[-1], values[-1] = contracted, contracted_value
+            else:
+                simplex = [simplex[0]] + [[b + 0.5 * (x - b) for b, x in zip(simplex[0], p)] for p in simplex[1:]]
+                values = [values[0]] + [cost(p) for p in simplex[1:]]
+    return simplex[min(range(n + 1), key=lambda i: values[i])]
+
+
+def fitted_lowpass(curve, fs, highpass_sections, start):
+    """The last section, b1, b2, a1 and a2 chosen so the whole cascade
+    follows the analog curve in dB (gain aside), starting from the
+    bilinear one. Poles are kept well inside the unit circle."""
+    grid = [1000.0 * 2 ** (k / 6) for k in range(-30, 60) if 1000.0 * 2 ** (k / 6) <= WEIGHTING_FIT_TOP * fs / 2]
+    target = []
+    for f in grid:
+        rest = 1.0
+        for section in highpass_sections:
+            rest *= section_gain(section, f, fs)
+        target.append(20 * math.log10(analog_weighting(curve, f) / rest))
+
+    def section(p):
+        return ([1.0, p[0], p[1]], [1.0, p[2], p[3]])
+
+    def cost(p):
+        if abs(p[3]) > 0.95 or abs(p[2]) > 1.0 + p[3] - 0.01:
+            return float("inf")
+        errors = [20 * math.log10(max(section_gain(section(p), f, fs), 1e-9)) - t for f, t in zip(grid, target)]
+        mean = sum(errors) / len(errors)
+        return sum((e - mean) ** 2 for e in errors)
+
+    b, a = start
+    p = [b[1] / b[0], b[2] / b[0], a[1], a[2]]
+    for step in (0.1, 0.05):
+        p = nelder_mead(cost, p, step, 400)
+    return section(p)
+
+
+def weighting_sections(curve, fs):
+    """Biquads (b, a) of the A or C weighting, unity gain at 1 kHz: the
+    high-pass sections through the bilinear transform, the low-pass one
+    fitted. High-pass sections come first so the DC offset never reaches
+    the rest."""
+    k = 2.0 * fs
+    highpass = [k, -k]
+    lowpass = [1.0, 1.0]
+    p1 = bilinear_pole(POLE_F1, fs)
+    p4 = bilinear_pole(POLE_F4, fs)
+
+    sections = [(poly_mul(highpass, highpass), poly_mul(p1, p1))]
+    if curve == "a":
+        sections.append((poly_mul(highpass, highpass),
+                         poly_mul(bilinear_pole(POLE_F2, fs), bilinear_pole(POLE_F3, fs))))
+    sections.append((poly_mul(lowpass, lowpass), poly_mul(p4, p4)))
+
+    normalised = []
+    for b, a in sections:
+        normalised.append(([x / a[0] for x in b], [x / a[0] for x in a]))
+    normalised[-1] = fitted_lowpass(curve, fs, normalised[:-1], normalised[-1])
+
+    # The low-pass section takes the gain, scaling the whole chain to unity
+    # at 1 kHz
+    gain = 1.0
+    for section in normalised:
+        gain *= section_gain(section, 1000.0, fs)
+    b, a = normalised[-1]
+    normalised[-1] = ([x / gain for x in b], a)
+
+    return normalised
+
+
+def biquad_array(name, curve):
+    lines = [f"const dsp_biquad_q30_t {name}[DSP_WEIGHTING_RATES][DSP_{curve.upper()}_WEIGHTING_SECTIONS] = {{"]
+    for fs in WEIGHTING_RATES:
+        lines.append("    {")
+        for b, a in weighting_sections(curve, fs):
+            values = ", ".join(str(q30(v)) for v in (b[0], b[1], b[2], a[1], a[2]))
+            lines.append(f"        {{{values}}},")
+        lines.append(f"    }}, // {fs} Hz")
+    lines.append("};")
+    return lines
+
+
+def solve(matrix, vector):
+    """Gauss-Jordan elimination with partial pivoting"""
+    n = len(vector)
+    rows = [row[:] + [vector[i]] for i, row in enumerate(matrix)]
+    for col in range(n):
+        pivot = max(range(col, n), key=lambda r: abs(rows[r][col]))
+        rows[col], rows[pivot] = rows[pivot], rows[col]
+        for r in range(n):
+            if r != col:
+                factor = rows[r][col] / rows[col][col]
+                for k in range(col, n + 1):
+                    rows[r][k] -= factor * rows[col][k]
+    return [rows[i][n] / rows[i][i] for i in range(n)]
+
+
+def cic_response(f, ratio):
+    """CIC magnitude at f, as a fraction of its own output rate"""
+    if f == 0.0:
+        return 1.0
+    return abs(math.sin(math.pi * f) / (ratio * math.sin(math.pi * f / ratio))) ** CIC_ORDER
+
+
+def compensation_fir(ratio):
+    """Least squares even-length linear phase FIR at the CIC output rate:
+    1 / CIC in the passband, 0 in the stopband, unity gain at DC in Q14"""
+    half = FIR_TAPS // 2
+    passband = FIR_PASSBAND / 2.0
+    stopband = FIR_STOPBAND / 2.0
+
+    normal = [[0.0] * half for _ in range(half)]
+    target = [0.0] * half
+    for i in range(4000):
+        f = 0.5 * i / 3999
+        if f <= passband:
+            desired, weight = 1.0 / cic_response(f, ratio), 1.0
+        elif f >= stopband:
+            desired, weight = 0.0, FIR_STOPBAND_WEIGHT
+        else:
+            continue
+        basis = [2.0 * math.cos(2.0 * math.pi * f * (k + 0.5)) for k in range(half)]
+        for r in range(half):
+            target[r] += weight * basis[r] * desired
+            for c in range(half):
+                normal[r][c] += weight * basis[r] * basis[c]
+
+    coefficients = solve(normal, target)
+    taps = [coefficients[half - 1 - k] for k in range(half)] + coefficients
+    scale = 1.0 / sum(taps)
+    quantised = [int(round(t * scale * (1 << 14))) for t in taps]
+
+    # Exact unity DC gain, keeping the taps symmetric
+    error = (1 << 14) - sum(quantised)
+    quantised[half - 1] += error // 2
+    quantised[half] += error // 2
+    quantised[half - 1] += error % 2
+    return quantised
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: gen_dsp_tables.py dsp_tables.h dsp_tables.c")
+
+    header = [
+        "// Generated by tools/gen_dsp_tables.py, do not edit",
+        "#ifndef DSP_TABLES_H",
+        "#define DSP_TABLES_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        f"#define DSP_FFT_MAX_LOG2 {FFT_MAX_LOG2}",
+        f"#define DSP_FFT_MAX_SIZE {FFT_MAX_SIZE}",
+        "",
+        "// cos and -sin of 2*pi*k/N for k < N/2, Q15; smaller FFTs use every",
+        "// (DSP_FFT_MAX_SIZE / N)-th entry",
+        "extern const int16_t dsp_fft_cos_q15[DSP_FFT_MAX_SIZE / 2];",
+        "extern const int16_t dsp_fft_sin_q15[DSP_FFT_MAX_SIZE / 2];",
+        "",
+        "// Periodic Hann window, Q15, strided the same way as the twiddles",
+        "extern const int16_t dsp_hann_q15[DSP_FFT_MAX_SIZE];",
+        "",
+        "// Bit reversal over DSP_FFT_MAX_LOG2 bits, shifted right for smaller FFTs",
+        "extern const uint16_t dsp_bit_reverse[DSP_FFT_MAX_SIZE];",
+        "",
+        f"#define DSP_OCTAVE_BANDS {len(OCTAVES)}",
+        f"#define DSP_THIRD_OCTAVE_BANDS {len(THIRD_OCTAVES)}",
+        "",
+        "// Band centres and edges in Hz",
+        "extern const uint16_t dsp_octave_centre_hz[DSP_OCTAVE_BANDS];",
+        "extern const uint16_t dsp_octave_lower_hz[DSP_OCTAVE_BANDS];",
+        "extern const uint16_t dsp_octave_upper_hz[DSP_OCTAVE_BANDS];",
+        "extern const uint16_t dsp_third_octave_centre_hz[DSP_THIRD_OCTAVE_BANDS];",
+        "extern const uint16_t dsp_third_octave_lower_hz[DSP_THIRD_OCTAVE_BANDS];",
+        "extern const uint16_t dsp_third_octave_upper_hz[DSP_THIRD_OCTAVE_BANDS];",
+        "",
+        "// One biquad, a0 = 1: y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2, all Q30",
+        "typedef struct",
+        "{",
+        "    int32_t b0, b1, b2, a1, a2;",
+        "} dsp_biquad_q30_t;",
+        "",
+        f"#define DSP_WEIGHTING_RATES {len(WEIGHTING_RATES)}",
+        "#define DSP_A_WEIGHTING_SECTIONS 3",
+        "#define DSP_C_WEIGHTING_SECTIONS 2",
+        "",
+        "// A and C weighting cascades for each rate, unity gain at 1 kHz",
+        "extern const uint32_t dsp_weighting_rate_hz[DSP_WEIGHTING_RATES];",
+        "extern const dsp_biquad_q30_t dsp_a_weighting_q30[DSP_WEIGHTING_RATES][DSP_A_WEIGHTING_SECTIONS];",
+        "extern const dsp_biquad_q30_t dsp_c_weighting_q30[DSP_WEIGHTING_RATES][DSP_C_WEIGHTING_SECTIONS];",
+        "",
+        f"#define DSP_CIC_ORDER {CIC_ORDER}",
+        f"#define DSP_DECIMATOR_TAPS {FIR_TAPS}",
+        f"#define DSP_DECIMATOR_CONFIGS {len(DECIMATOR_CONFIGS)}",
+        "",
+        "// CIC by cic_ratio, then a droop compensating FIR by 2 with Q14 taps",
+        "// summing to 1; the raw rate is audio_rate * cic_ratio * 2",
+        "typedef struct",
+        "{",
+        "    uint32_t audio_rate;",
+        "    uint16_t cic_ratio;",
+        "    int16_t fir_q14[DSP_DECIMATOR_TAPS];",
+        "} dsp_decimator_config_t;",
+        "",
+        "extern const dsp_decimator_config_t dsp_decimator_configs[DSP_DECIMATOR_CONFIGS];",
+        "",
+        f"#define DSP_LOG2_TABLE_BITS {LOG2_TABLE_BITS}",
+        "",
+        "// log2(1 + i / 2^DSP_LOG2_TABLE_BITS), Q16, one extra entry for interpolation",
+        "extern const uint32_t dsp_log2_q16[(1 << DSP_LOG2_TABLE_BITS) + 1];",
+    ]
+
+    source = [
+        "// Generated by tools/gen_dsp_tables.py, do not edit",
+        '#include "dsp_tables.h"',
+        "",
+    ]
+
+    half = FFT_MAX_SIZE // 2
+    source += c_array("int16_t", "dsp_fft_cos_q15",
+                      [q15(math.cos(2 * math.pi * k / FFT_MAX_SIZE)) for k in range(half)])
+    source.append("")
+    source += c_array("int16_t", "dsp_fft_sin_q15",
+                      [q15(-math.sin(2 * math.pi * k / FFT_MAX_SIZE)) for k in range(half)])
+    source.append("")
+    source += c_array("int16_t", "dsp_hann_q15",
+                      [q15(0.5 - 0.5 * math.cos(2 * math.pi * n / FFT_MAX_SIZE)) for n in range(FFT_MAX_SIZE)])
+    source.append("")
+    source += c_array("uint16_t", "dsp_bit_reverse",
+                      [bit_reverse(n, FFT_MAX_LOG2) for n in range(FFT_MAX_SIZE)])
+
+    for name, exponents, fraction in (("octave", OCTAVES, 1), ("third_octave", THIRD_OCTAVES, 3)):
+        centres, lower, upper = band_edges(exponents, fraction)
+        for suffix, values in (("centre", centres), ("lower", lower), ("upper", upper)):
+            source.append("")
+            source += c_array("uint16_t", f"dsp_{name}_{suffix}_hz", values, 10)
+
+    source.append("")
+    source += c_array("uint32_t", "dsp_weighting_rate_hz", list(WEIGHTING_RATES))
+    source.append("")
+    source += biquad_array("dsp_a_weighting_q30", "a")
+    source.append("")
+    source += biquad_array("dsp_c_weighting_q30", "c")
+
+    source.append("")
+    source.append("const dsp_decimator_config_t dsp_decimator_configs[DSP_DECIMATOR_CONFIGS] = {")
+    for rate, ratio in DECIMATOR_CONFIGS:
+        taps = compensation_fir(ratio)
+        source.append(f"    {{{rate}, {ratio}, {{")
+        for i in range(0, len(taps), 12):
+            source.append("        " + ", ".join(str(t) for t in taps[i:i + 12]) + ",")
+        source.append("    }},")
+    source.append("};")
+
+    source.append("")
+    entries = 1 << LOG2_TABLE_BITS
+    source += c_array("uint32_t", "dsp_log2_q16",
+                      [int(round(math.log2(1.0 + i / entries) * 65536.0)) for i in range(entries + 1)])
+
+    header += ["", "#endif // DSP_TABLES_H", ""]
+    source.append("")
+
+    with open(sys.argv[1], "w", encoding="utf-8") as out:
+        out.write("\n".join(header))
+    with open(sys.argv[2], "w", encoding="utf-8") as out:
+        out.write("\n".join(source))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""Converts lib/ssd1306/ssd1306_font.txt into the ssd1306_font.h atlas.
+
+Each glyph becomes 8 column bytes, least significant bit on top, which is
+the SSD1306 page layout, so the blitter copies columns straight into the
+framebuffer.
+"""
+
+import sys
+
+FIRST = 0x20
+LAST = 0x7E
+
+
+def parse(path):
+    glyphs = {}
+    with open(path, encoding="utf-8") as source:
+        lines = [line.rstrip("\n") for line in source]
+
+    i = 0
+    while i < len(lines):
+        line = lines[i]
+        if not line.strip() or line.startswith("#"):
+            i += 1
+            continue
+
+        code = int(line.split()[0], 16)
+        rows = lines[i + 1:i + 9]
+        if len(rows) != 8 or any(len(row) != 8 or set(row) - set("#.") for row in rows):
+            sys.exit(f"{path}:{i + 1}: glyph 0x{code:02X} must be 8 rows of 8 '#'/'.'")
+        glyphs[code] = rows
+        i += 9
+
+    missing = [code for code in range(FIRST, LAST + 1) if code not in glyphs]
+    if missing:
+        sys.exit(f"{path}: missing glyphs {', '.join(f'0x{c:02X}' for c in missing)}")
+    return glyphs
+
+
+def columns(rows):
+    return [sum(1 << r for r in range(8) if rows[r][c] == "#") for c in range(8)]
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: gen_font.py ssd1306_font.txt ssd1306_font.h")
+
+    glyphs = parse(sys.argv[1])
+    out = [
+        "// Gerado por tools/gen_font.py a partir de ssd1306_font.txt, não editar",
+        "#include <stdint.h>",
+        "",
+        "#ifndef ssd1306_font_inc_h",
+        "#define ssd1306_font_inc_h",
+        "",
+        f"#define ssd1306_font_first 0x{FIRST:02X}",
+        f"#define ssd1306_font_count {LAST - FIRST + 1}",
+        "#define ssd1306_font_width 8",
+        "",
+        "static const uint8_t font[] = {",
+    ]
+    for code in range(FIRST, LAST + 1):
+        data = ", ".join(f"0x{b:02x}" for b in columns(glyphs[code]))
+        label = chr(code) if chr(code) not in "\\" else "backslash"
+        out.append(f"    {data}, // {label}")
+    out += ["};", "", "#endif", ""]
+
+    with open(sys.argv[2], "w", encoding="utf-8") as header:
+        header.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,630 @@
+// Decodes a capture of the USB telemetry stream, as saved by
+// `cat /dev/ttyACM0 > capture.bin` or noiseguard_sim --telemetry
+#include "capture_file.h"
+#include "clip_ring.h"
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DECODE_READ_SIZE 4096
+#define DECODE_AUDIO_BIAS 2048
+#define DECODE_CLIP_BYTES 8192
+#define DECODE_RECORD_SAMPLES 4096
+
+typedef struct
+{
+    bool quiet;
+    FILE *raw;
+    uint32_t first_ms;
+    uint32_t last_ms;
+    bool timed;
+    bool have_stats;
+    telemetry_stats_t stats;
+    uint64_t raw_samples;
+    uint32_t raw_gaps;
+    uint32_t raw_block;
+    uint32_t raw_next;
+    uint64_t trace_entries;
+    uint64_t trace_lost;
+    FILE *clip;
+    uint32_t clips;
+    uint32_t clip_blocks;
+    uint32_t clip_gaps;
+    uint64_t clip_samples;
+    bool clip_started;
+    bool clip_partial;
+    uint16_t clip_number;
+    uint16_t clip_block;
+    uint16_t clip_fill;
+    uint8_t clip_bytes[DECODE_CLIP_BYTES];
+    FILE *record;
+    bool record_started;
+    bool record_partial;
+    bool record_pending;
+    bool have_thresholds;
+    monitor_thresholds_t thresholds;
+    uint32_t record_samples;
+    uint32_t record_block;
+    uint32_t record_fill;
+    uint32_t record_lost;
+    uint32_t record_blocks;
+    uint32_t record_changes;
+    uint32_t record_gaps;
+    uint32_t record_incomplete;
+    uint16_t record_buffer[DECODE_RECORD_SAMPLES];
+} decode_t;
+
+static const char *const decode_alarm_names[] = {"ok", "warning", "danger"};
+static const char *const decode_metric_names[] = {"level", "fast", "slow", "leq"};
+
+// As in trace_point_t and latency_path_t
+static const char *const decode_trace_names[] = {"capture", "dsp", "led", "frame"};
+static const char *const decode_latency_names[] = {"dsp", "led", "frame"};
+
+static void decode_time(decode_t *decode, uint32_t time_ms)
+{
+    if (!decode->timed)
+    {
+        decode->first_ms = time_ms;
+        decode->timed = true;
+    }
+    decode->last_ms = time_ms;
+}
+
+static void decode_levels(decode_t *decode, const telemetry_levels_t *levels)
+{
+    decode_time(decode, levels->time_ms);
+    for (unsigned i = 0; i < levels->count && !decode->quiet; i++)
+    {
+        const telemetry_level_t *l = &levels->levels[i];
+        printf("%10.3f levels  level %5.1f  fast %5.1f  slow %5.1f  leq %5.1f\n",
+               levels->time_ms / 1000.0 + i * levels->block_us / 1e6, l->level / 10.0, l->fast / 10.0,
+               l->slow / 10.0, l->leq / 10.0);
+    }
+}
+
+static void decode_bands(decode_t *decode, const telemetry_bands_t *bands)
+{
+    decode_time(decode, bands->time_ms);
+    if (decode->quiet)
+    {
+        return;
+    }
+    printf("%10.3f bands   1/%u octave %2u..%2u:", bands->time_ms / 1000.0, bands->resolution, bands->first,
+           bands->first + bands->count - 1);
+    for (unsigned i = 0; i < bands->count; i++)
+    {
+        printf(" %.1f", bands->bands[i] / 10.0);
+    }
+    printf("\n");
+}
+
+// The thresholds of a state packet held the block whose raw packets
+// follow it, so a change is recorded ahead of that block
+static void decode_record_thresholds(decode_t *decode, const telemetry_state_t *state)
+{
+    const monitor_thresholds_t thresholds = {state->warning, state->danger, state->gap,
+                                             (monitor_metric_t)state->metric};
+
+    if (!decode->have_thresholds || memcmp(&thresholds, &decode->thresholds, sizeof(thresholds)) != 0)
+    {
+        decode->thresholds = thresholds;
+        decode->have_thresholds = true;
+        decode->record_pending = true;
+    }
+}
+
+static void decode_state(decode_t *decode, const telemetry_state_t *state)
+{
+    decode_time(decode, state->time_ms);
+    decode_record_thresholds(decode, state);
+    if (decode->quiet)
+    {
+        return;
+    }
+    printf("%10.3f state   %s %.1f dB  warning %.1f  danger %.1f  gap %.1f  %s%s\n", state->time_ms / 1000.0,
+           state->metric < 4 ? decode_metric_names[state->metric] : "?", state->metric_level / 10.0,
+           state->warning / 10.0, state->danger / 10.0, state->gap / 10.0,
+           state->alarm < 3 ? decode_alarm_names[state->alarm] : "?", state->raw ? "  raw" : "");
+}
+
+static void decode_stats(decode_t *decode, const telemetry_stats_t *stats)
+{
+    decode_time(decode, stats->time_ms);
+    decode->stats = *stats;
+    decode->have_stats = true;
+    if (decode->quiet)
+    {
+        return;
+    }
+    printf("%10.3f stats   capture %u blocks %u dropped %u overruns  display %u frames  usb %u sent %u dropped"
+           "  events %u waiting %u dropped  stack free",
+           stats->time_ms / 1000.0, stats->capture_blocks, stats->capture_dropped, stats->capture_overruns,
+           stats->display_frames, stats->packets_sent, stats->packets_dropped, stats->events_pending,
+           stats->events_dropped);
+    for (unsigned t = 0; t < TELEMETRY_STATS_TASKS; t++)
+    {
+        printf(" %u", stats->stack_free[t]);
+    }
+    printf("  deadline misses %u monitor %u display %u input\n", stats->deadline_misses[0],
+           stats->deadline_misses[1], stats->deadline_misses[2]);
+}
+
+// Stages are numbered as in profile_stage_id_t (include/diagnostics.h)
+static void decode_profile(decode_t *decode, const telemetry_profile_t *profile)
+{
+    decode_time(decode, profile->time_ms);
+    if (decode->quiet)
+    {
+        return;
+    }
+    printf("%10.3f profile stage %u  %u runs  min %u  mean %u  max %u us  bins", profile->time_ms / 1000.0,
+           profile->stage, profile->count, profile->min_us, profile->mean_us, profile->max_us);
+    for (unsigned bin = 0; bin < TELEMETRY_PROFILE_BINS; bin++)
+    {
+        printf(" %u", profile->bins[bin]);
+    }
+    printf("\n");
+}
+
+// Words of stack used out of those planned, per task in the stats order
+static void decode_memory(decode_t *decode, const telemetry_memory_t *memory)
+{
+    decode_time(decode, memory->time_ms);
+    if (decode->quiet)
+    {
+        return;
+    }
+    printf("%10.3f memory  heap %u bytes  stack used", memory->time_ms / 1000.0, memory->heap_used);
+    for (unsigned t = 0; t < TELEMETRY_STATS_TASKS; t++)
+    {
+        printf(" %u/%u", memory->stack_words[t] - memory->stack_free[t], memory->stack_words[t]);
+    }
+    printf("\n");
+}
+
+// Capture to LED and screen, in us
+static void decode_latency(decode_t *decode, const telemetry_profile_t *latency)
+{
+    decode_time(decode, latency->time_ms);
+    if (decode->quiet)
+    {
+        return;
+    }
+    printf("%10.3f latency %-5s %u blocks  min %u  mean %u  max %u us  bins", latency->time_ms / 1000.0,
+           latency->stage < 3 ? decode_latency_names[latency->stage] : "?", latency->count, latency->min_us,
+           latency->mean_us, latency->max_us);
+    for (unsigned bin = 0; bin < TELEMETRY_PROFILE_BINS; bin++)
+    {
+        printf(" %u", latency->bins[bin]);
+    }
+    printf("\n");
+}
+
+static void decode_trace(decode_t *decode, const telemetry_trace_t *trace)
+{
+    decode->trace_lost += trace->lost;
+    for (unsigned i = 0; i < trace->count && i < TELEMETRY_TRACE_ENTRIES; i++)
+    {
+        const telemetry_trace_entry_t *entry = &trace->entries[i];
+        decode->trace_entries++;
+        if (!decode->quiet)
+        {
+            printf("%10.6f trace   %-7s block %u\n", entry->time_us / 1e6,
+                   entry->point < 4 ? decode_trace_names[entry->point] : "?", entry->block);
+        }
+    }
+}
+
+static void decode_load(decode_t *decode, const telemetry_load_t *load)
+{
+    decode_time(decode, load->time_ms);
+    for (unsigned i = 0; i < load->count && i < TELEMETRY_LOAD_TASKS && !decode->quiet; i++)
+    {
+        printf("%10.3f load    %2u/%u %-10.*s %5.1f%%\n", load->time_ms / 1000.0, load->first + i, load->total,
+               TELEMETRY_LOAD_NAME, load->tasks[i].name, load->tasks[i].permille / 10.0);
+    }
+}
+
+static void decode_info(decode_t *decode, const telemetry_info_t *info)
+{
+    if (!decode->quiet)
+    {
+        printf("info    firmware %.*s  %u Hz  %u samples a block  vref %u mV  sensitivity %.1f dBV  offset %.1f dB"
+               "  weighting %u  spectrum 2^%u\n",
+               TELEMETRY_FIRMWARE, info->firmware, info->sample_rate, info->block_samples, info->adc_vref_mv,
+               info->sensitivity_decidbv / 10.0, info->offset_decidb / 10.0, info->weighting, info->spectrum_log2);
+    }
+    if (!decode->record || decode->record_started || info->block_samples > DECODE_RECORD_SAMPLES)
+    {
+        return;
+    }
+
+    calibration_profile_t profile = {
+        .magic = CALIBRATION_PROFILE_MAGIC,
+        .version = CALIBRATION_PROFILE_VERSION,
+        .sensitivity_decidbv = info->sensitivity_decidbv,
+        .offset_decidb = info->offset_decidb};
+    profile.checksum = calibration_profile_checksum(&profile);
+
+    char firmware[TELEMETRY_FIRMWARE + 1] = {0};
+    memcpy(firmware, info->firmware, TELEMETRY_FIRMWARE);
+
+    capture_file_header_t header;
+    capture_file_header_init(&header, info->sample_rate, info->block_samples, info->adc_vref_mv, &profile,
+                             (weighting_curve_t)info->weighting, info->spectrum_log2, firmware);
+    fwrite(&header, sizeof(header), 1, decode->record);
+    decode->record_samples = info->block_samples;
+    decode->record_started = true;
+}
+
+// Minute n covers [n, n + 1) minutes since boot, hour n the same in hours
+static void decode_history(decode_t *decode, const telemetry_history_t *history)
+{
+    for (unsigned i = 0; i < history->count && i < TELEMETRY_HISTORY_RECORDS && !decode->quiet; i++)
+    {
+        const telemetry_history_record_t *record = &history->records[i];
+        printf("history %-6s %5u  min %5.1f  max %5.1f  leq %5.1f  L10 %5.1f  L90 %5.1f dB",
+               history->resolution == 2 ? "hour" : "minute", history->first + i, record->min / 10.0,
+               record->max / 10.0, record->leq / 10.0, record->l10 / 10.0, record->l90 / 10.0);
+        if (record->gaps)
+        {
+            printf("  %u gaps", record->gaps);
+        }
+        printf("\n");
+    }
+}
+
+// Raw blocks go into the capture file whole, after a gap chunk when the
+// device lost samples before them; one missing a packet is left out, which
+// the replay sees as a gap in the block numbers
+static void decode_record_raw(decode_t *decode, const telemetry_raw_t *raw)
+{
+    static uint8_t chunk[CAPTURE_CHUNK_BYTES(CAPTURE_PACKED_BYTES(DECODE_RECORD_SAMPLES))];
+
+    if (!decode->record_started)
+    {
+        return;
+    }
+    if (raw->offset == 0)
+    {
+        decode->record_incomplete += decode->record_partial ? 1 : 0;
+        decode->record_block = raw->block;
+        decode->record_fill = 0;
+        decode->record_lost = raw->lost;
+        decode->record_partial = true;
+        if (decode->record_pending)
+        {
+            fwrite(chunk, capture_file_write_thresholds(chunk, raw->block, &decode->thresholds), 1,
+                   decode->record);
+            decode->record_pending = false;
+            decode->record_changes++;
+        }
+    }
+    if (!decode->record_partial || raw->block != decode->record_block || raw->offset != decode->record_fill ||
+        raw->offset + raw->count > decode->record_samples)
+    {
+        decode->record_incomplete += decode->record_partial ? 1 : 0;
+        decode->record_partial = false;
+        return;
+    }
+
+    memcpy(decode->record_buffer + raw->offset, raw->samples, raw->count * sizeof(raw->samples[0]));
+    decode->record_fill += raw->count;
+    if (decode->record_fill == decode->record_samples)
+    {
+        if (decode->record_lost)
+        {
+            fwrite(chunk, capture_file_write_gap(chunk, raw->block, decode->record_lost), 1, decode->record);
+            decode->record_gaps++;
+        }
+        fwrite(chunk, capture_file_write_block(chunk, raw->block, decode->record_buffer, decode->record_samples), 1,
+               decode->record);
+        decode->record_partial = false;
+        decode->record_blocks++;
+    }
+}
+
+// Samples as signed 16-bit PCM, the way noiseguard_sim --raw reads them back
+static void decode_raw(decode_t *decode, const telemetry_raw_t *raw)
+{
+    if (decode->record)
+    {
+        decode_record_raw(decode, raw);
+    }
+
+    if (decode->raw_samples > 0 && (raw->block != decode->raw_block || raw->offset != decode->raw_next) &&
+        !(raw->offset == 0 && raw->block == decode->raw_block + 1))
+    {
+        decode->raw_gaps++;
+    }
+    decode->raw_block = raw->block;
+    decode->raw_next = raw->offset + raw->count;
+    decode->raw_samples += raw->count;
+
+    if (decode->raw)
+    {
+        for (unsigned i = 0; i < raw->count; i++)
+        {
+            int16_t pcm = (int16_t)((raw->samples[i] - DECODE_AUDIO_BIAS) * 16);
+            fwrite(&pcm, sizeof(pcm), 1, decode->raw);
+        }
+    }
+}
+
+// A block is decoded once all of its bytes are in. A block missing a
+// packet, or missing altogether, is a gap.
+static void decode_clip(decode_t *decode, const telemetry_clip_t *clip)
+{
+    static int16_t pcm[DECODE_CLIP_BYTES * 2];
+
+    bool same_clip = decode->clip_started && clip->clip == decode->clip_number;
+    if (!same_clip)
+    {
+        decode->clips++;
+        decode->clip_started = true;
+        decode->clip_number = clip->clip;
+        decode->clip_block = UINT16_MAX;
+        if (!decode->quiet)
+        {
+            printf("clip    %u: %u blocks, crossing in block %u, %s\n", clip->clip, clip->count, clip->trigger,
+                   clip->codec == CLIP_CODEC_ULAW ? "mu-law" : "adpcm");
+        }
+    }
+
+    if (clip->offset == 0)
+    {
+        uint16_t expected = same_clip ? (uint16_t)(decode->clip_block + 1) : 0;
+        decode->clip_gaps += (decode->clip_partial ? 1 : 0) + (clip->block != expected ? 1 : 0);
+        decode->clip_block = clip->block;
+        decode->clip_fill = 0;
+        decode->clip_partial = true;
+    }
+    if (!decode->clip_partial || clip->block != decode->clip_block || clip->offset != decode->clip_fill ||
+        clip->bytes > DECODE_CLIP_BYTES || clip->offset + clip->length > clip->bytes)
+    {
+        decode->clip_gaps += decode->clip_partial ? 1 : 0;
+        decode->clip_partial = false;
+        return;
+    }
+
+    memcpy(decode->clip_bytes + clip->offset, clip->data, clip->length);
+    decode->clip_fill = (uint16_t)(clip->offset + clip->length);
+    if (decode->clip_fill < clip->bytes)
+    {
+        return;
+    }
+    decode->clip_partial = false;
+
+    uint32_t samples = clip->codec == CLIP_CODEC_ULAW ? clip->bytes : (clip->bytes - CLIP_ADPCM_HEADER) * 2u;
+    clip_decode((clip_codec_t)clip->codec, decode->clip_bytes, samples, pcm);
+    decode->clip_blocks++;
+    decode->clip_samples += samples;
+    if (decode->clip)
+    {
+        fwrite(pcm, sizeof(pcm[0]), samples, decode->clip);
+    }
+}
+
+static void decode_packet(const telemetry_packet_t *packet, void *ctx)
+{
+    decode_t *decode = ctx;
+    union
+    {
+        telemetry_levels_t levels;
+        telemetry_bands_t bands;
+        telemetry_state_t state;
+        telemetry_stats_t stats;
+        telemetry_raw_t raw;
+        telemetry_profile_t profile;
+        telemetry_load_t load;
+        telemetry_trace_t trace;
+        telemetry_memory_t memory;
+        telemetry_clip_t clip;
+        telemetry_info_t info;
+        telemetry_history_t history;
+    } payload;
+
+    if (telemetry_unpack(packet, TELEMETRY_LEVELS, &payload, sizeof(payload.levels)))
+    {
+        decode_levels(decode, &payload.levels);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_BANDS, &payload, sizeof(payload.bands)))
+    {
+        decode_bands(decode, &payload.bands);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_STATE, &payload, sizeof(payload.state)))
+    {
+        decode_state(decode, &payload.state);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_STATS, &payload, sizeof(payload.stats)))
+    {
+        decode_stats(decode, &payload.stats);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_RAW, &payload, sizeof(payload.raw)))
+    {
+        decode_raw(decode, &payload.raw);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_PROFILE, &payload, sizeof(payload.profile)))
+    {
+        decode_profile(decode, &payload.profile);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_LOAD, &payload, sizeof(payload.load)))
+    {
+        decode_load(decode, &payload.load);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_LATENCY, &payload, sizeof(payload.profile)))
+    {
+        decode_latency(decode, &payload.profile);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_TRACE, &payload, sizeof(payload.trace)))
+    {
+        decode_trace(decode, &payload.trace);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_MEMORY, &payload, sizeof(payload.memory)))
+    {
+        decode_memory(decode, &payload.memory);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_CLIP, &payload, sizeof(payload.clip)))
+    {
+        decode_clip(decode, &payload.clip);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_INFO, &payload, sizeof(payload.info)))
+    {
+        decode_info(decode, &payload.info);
+    }
+    else if (telemetry_unpack(packet, TELEMETRY_HISTORY, &payload, sizeof(payload.history)))
+    {
+        decode_history(decode, &payload.history);
+    }
+}
+
+static void decode_summary(const decode_t *decode, const telemetry_decoder_t *decoder)
+{
+    double seconds = decode->timed ? (decode->last_ms - decode->first_ms) / 1000.0 : 0.0;
+
+    printf("\n== %llu bytes, %u packets ==\n", (unsigned long long)decoder->bytes, decoder->packets);
+    printf("packets  %u levels, %u bands, %u state, %u stats, %u memory, %u raw, %u profile, %u load, %u latency, "
+           "%u trace, %u clip, %u info, %u history\n",
+           decoder->by_type[TELEMETRY_LEVELS], decoder->by_type[TELEMETRY_BANDS], decoder->by_type[TELEMETRY_STATE],
+           decoder->by_type[TELEMETRY_STATS], decoder->by_type[TELEMETRY_MEMORY], decoder->by_type[TELEMETRY_RAW],
+           decoder->by_type[TELEMETRY_PROFILE], decoder->by_type[TELEMETRY_LOAD], decoder->by_type[TELEMETRY_LATENCY],
+           decoder->by_type[TELEMETRY_TRACE], decoder->by_type[TELEMETRY_CLIP], decoder->by_type[TELEMETRY_INFO],
+           decoder->by_type[TELEMETRY_HISTORY]);
+    printf("link     %u lost, %u CRC errors, %llu bytes skipped\n", decoder->lost, decoder->crc_errors,
+           (unsigned long long)decoder->skipped);
+    if (decode->have_stats)
+    {
+        printf("device   %u packets sent, %u dropped before sending\n", decode->stats.packets_sent,
+               decode->stats.packets_dropped);
+    }
+    if (seconds > 0.0)
+    {
+        printf("rate     %.1f s of device time, %.1f packets/s, %.0f bytes/s\n", seconds,
+               decoder->packets / seconds, decoder->packets * (double)TELEMETRY_PACKET_SIZE / seconds);
+    }
+    if (decoder->by_type[TELEMETRY_TRACE])
+    {
+        printf("trace    %llu entries, %llu overwritten on the device\n", (unsigned long long)decode->trace_entries,
+               (unsigned long long)decode->trace_lost);
+    }
+    if (decoder->by_type[TELEMETRY_RAW])
+    {
+        printf("raw      %llu samples, %u gaps\n", (unsigned long long)decode->raw_samples, decode->raw_gaps);
+    }
+    if (decoder->by_type[TELEMETRY_CLIP])
+    {
+        printf("clips    %u clips, %u blocks, %llu samples, %u gaps\n", decode->clips, decode->clip_blocks,
+               (unsigned long long)decode->clip_samples, decode->clip_gaps);
+    }
+    if (decode->record && !decode->record_started)
+    {
+        printf("record   nothing recorded, no info packet before the raw packets\n");
+    }
+    else if (decode->record)
+    {
+        printf("record   %u blocks, %u threshold changes, %u gaps, %u incomplete blocks left out\n",
+               decode->record_blocks, decode->record_changes, decode->record_gaps,
+               decode->record_incomplete + (decode->record_partial ? 1 : 0));
+    }
+}
+
+static void decode_usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--quiet] [--raw file] [--clip file] [--record file] capture\n"
+            "  --quiet prints the summary alone\n"
+            "  --raw writes raw mode samples to file as signed 16-bit PCM\n"
+            "  --clip writes the clips, one after the other, to file the same way\n"
+            "  --record writes raw mode blocks and threshold changes to file for noiseguard_replay\n",
+            argv0);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    decode_t decode = {0};
+    const char *capture_path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quiet") == 0)
+        {
+            decode.quiet = true;
+        }
+        else if (strcmp(argv[i], "--raw") == 0 && i + 1 < argc)
+        {
+            decode.raw = fopen(argv[++i], "wb");
+            if (!decode.raw)
+            {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--clip") == 0 && i + 1 < argc)
+        {
+            decode.clip = fopen(argv[++i], "wb");
+            if (!decode.clip)
+            {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            decode.record = fopen(argv[++i], "wb");
+            if (!decode.record)
+            {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (!capture_path && argv[i][0] != '-')
+        {
+            capture_path = argv[i];
+        }
+        else
+        {
+            decode_usage(argv[0]);
+        }
+    }
+    if (!capture_path)
+    {
+        decode_usage(argv[0]);
+    }
+
+    FILE *f = fopen(capture_path, "rb");
+    if (!f)
+    {
+        perror(capture_path);
+        return EXIT_FAILURE;
+    }
+
+    telemetry_decoder_t decoder;
+    telemetry_decoder_init(&decoder);
+
+    static uint8_t bytes[DECODE_READ_SIZE];
+    size_t read;
+    while ((read = fread(bytes, 1, sizeof(bytes), f)) > 0)
+    {
+        telemetry_decode(&decoder, bytes, read, decode_packet, &decode);
+    }
+    fclose(f);
+
+    decode_summary(&decode, &decoder);
+    if (decode.raw && fclose(decode.raw) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    if (decode.clip && fclose(decode.clip) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    if (decode.record && fclose(decode.record) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}